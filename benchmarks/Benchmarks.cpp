@@ -1,6 +1,69 @@
 #include "catch2/benchmark/catch_benchmark_all.hpp"
 #include "catch2/catch_test_macros.hpp"
 
+#include "TaskScheduler.h"
+#include "TrackAnalyser.h"
+
+#include <cmath>
+
+namespace
+{
+    /** A minute of four-to-the-floor at 124 BPM, with hats on the off-beats. */
+    juce::File writeAnalysisTrack (const juce::File& dir)
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr double beatSeconds = 60.0 / 124.0;
+        const int numSamples = (int) (60.0 * sampleRate);
+
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        juce::Random random (124);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            const double sinceBeat = std::fmod (t, beatSeconds);
+            const double sinceOffBeat = std::fmod (t + beatSeconds * 0.5, beatSeconds);
+
+            const double kick = std::sin (juce::MathConstants<double>::twoPi * (50.0 + 80.0 * std::exp (-30.0 * sinceBeat)) * sinceBeat)
+                                  * std::exp (-9.0 * sinceBeat);
+            const double hat = (random.nextDouble() * 2.0 - 1.0) * std::exp (-60.0 * sinceOffBeat);
+            const auto sample = (float) (0.6 * kick + 0.15 * hat);
+
+            buffer.setSample (0, i, sample);
+            buffer.setSample (1, i, sample);
+        }
+
+        auto file = dir.getChildFile ("Analysis.wav");
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (file),
+                                                                              sampleRate, 2, 24, {}, 0));
+        REQUIRE (writer != nullptr);
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+
+        return file;
+    }
+
+    /** The quickest of a few runs, in ms, so a busy moment on the machine doesn't count. */
+    double timeAnalysis (const juce::File& file, bool trackBeats)
+    {
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < 5; ++run)
+        {
+            const auto started = juce::Time::getMillisecondCounterHiRes();
+            const auto analysis = TrackAnalyser::analyseFile (file, {}, TaskPriority::interactive, trackBeats);
+            best = juce::jmin (best, juce::Time::getMillisecondCounterHiRes() - started);
+
+            REQUIRE (analysis);
+            CHECK (analysis->beats.empty() != trackBeats);
+        }
+
+        return best;
+    }
+}
+
 TEST_CASE ("Boot performance")
 {
     BENCHMARK_ADVANCED ("Mock test")
@@ -11,3 +74,36 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+TEST_CASE ("Analysis performance")
+{
+    // The analysis decodes on the scheduler's workers, which have to be joined before exiting
+    const juce::ErasedScopeGuard shutdown ([] { TaskScheduler::getInstance()->shutdown(); });
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("ChopShopAnalysisBenchmark");
+    dir.deleteRecursively();
+    REQUIRE (dir.createDirectory());
+
+    const auto file = writeAnalysisTrack (dir);
+
+    // Once first, so the file is in the OS cache for both
+    REQUIRE (TrackAnalyser::analyseFile (file, {}, TaskPriority::interactive));
+
+    const double withoutBeats = timeAnalysis (file, false);
+    const double withBeats = timeAnalysis (file, true);
+
+    dir.deleteRecursively();
+
+    // Budget: tracking every beat adds less than 20% to analysing a track
+    const double added = withBeats / juce::jmax (1.0e-6, withoutBeats) - 1.0;
+    INFO ("Analysis took " << withoutBeats << " ms without beat tracking and " << withBeats
+          << " ms with it, " << added * 100.0 << "% more");
+
+   #if JUCE_DEBUG
+    // Unoptimised builds can't be held to it
+    if (added >= 0.2)
+        WARN ("Beat tracking is over its analysis budget, but this is a debug build");
+   #else
+    CHECK (added < 0.2);
+   #endif
+}
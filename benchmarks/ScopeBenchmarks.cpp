@@ -0,0 +1,134 @@
+#include "catch2/benchmark/catch_benchmark_all.hpp"
+#include "catch2/catch_test_macros.hpp"
+
+#include "ScopeSource.h"
+#include "SoftwareScope.h"
+
+namespace
+{
+    // A couple of beats' worth of kick and hats at 44.1k, summed to mono like the scope does
+    std::vector<float> makeTestSignal (int numSamples)
+    {
+        std::vector<float> samples ((size_t) numSamples);
+        juce::Random random (1234);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / 44100.0;
+            const double kick = std::sin (juce::MathConstants<double>::twoPi * 55.0 * t) * std::exp (-8.0 * std::fmod (t, 0.5));
+            samples[(size_t) i] = (float) (1.4 * kick + 0.2 * (random.nextFloat() - 0.5f));
+        }
+
+        return samples;
+    }
+
+    /** What llvmpipe does for Oscilloscope2D: the fragment shader, once per
+        pixel. llvmpipe JIT-compiles and vectorises the shader, so this scalar
+        version is an upper bound, but it scales with the area the same way.
+    */
+    void runScopeShader (juce::Image& image, const float* audioSampleData)
+    {
+        juce::Image::BitmapData pixels (image, juce::Image::BitmapData::writeOnly);
+        const float width = (float) image.getWidth();
+        const float height = (float) image.getHeight();
+
+        for (int py = 0; py < image.getHeight(); ++py)
+        {
+            for (int px = 0; px < image.getWidth(); ++px)
+            {
+                const float y = ((float) py + 0.5f) / height;
+                const float position = 255.0f * ((float) px + 0.5f) / width;
+                const int left = (int) std::floor (position);
+                const int right = (int) std::ceil (position);
+                const float fraction = position - (float) left;
+
+                float amplitude = audioSampleData[left] + (audioSampleData[right] - audioSampleData[left]) * fraction;
+                amplitude = 0.5f - amplitude / 2.5f;
+
+                const float r = std::abs (0.02f / (amplitude - y));
+                const auto level = (juce::uint8) juce::jlimit (0.0f, 255.0f, (r - std::abs (r * 0.2f)) * 255.0f);
+
+                pixels.setPixelColour (px, py, juce::Colour (level, level, level));
+            }
+        }
+    }
+}
+
+TEST_CASE ("Scope rendering")
+{
+    constexpr int numSamples = 256;     // what Oscilloscope2D shows
+    constexpr int numFrames = 64;
+    const auto signal = makeTestSignal (numSamples * numFrames);
+
+    for (auto size : { juce::Point<int> (600, 200), juce::Point<int> (1200, 400) })
+    {
+        const auto sizeName = juce::String (size.x) + "x" + juce::String (size.y);
+
+        BENCHMARK_ADVANCED (("Software rasteriser " + sizeName).toStdString())
+        (Catch::Benchmark::Chronometer meter)
+        {
+            ScopeRasteriser rasteriser;
+            rasteriser.setSize (size.x, size.y, juce::Colours::black, juce::Colours::white);
+            rasteriser.render (signal.data(), numSamples);
+
+            meter.measure ([&] (int i) {
+                return rasteriser.render (signal.data() + (size_t) (i % numFrames) * numSamples, numSamples);
+            });
+        };
+
+        BENCHMARK_ADVANCED (("GL fragment shader on the CPU " + sizeName).toStdString())
+        (Catch::Benchmark::Chronometer meter)
+        {
+            juce::Image image (juce::Image::RGB, size.x, size.y, false);
+
+            meter.measure ([&] (int i) {
+                runScopeShader (image, signal.data() + (size_t) (i % numFrames) * numSamples);
+                return image.getWidth();
+            });
+        };
+    }
+
+    std::vector<float> mins (1200), maxs (1200);
+
+    BENCHMARK ("Column envelope, 4096 samples into 1200 columns")
+    {
+        ScopeRasteriser::computeEnvelope (signal.data(), 4096, mins.data(), maxs.data(), 1200);
+        return mins[0] + maxs[0];
+    };
+}
+
+TEST_CASE ("Scope windows")
+{
+    // Half a minute through the tap, so even eight bars are all there
+    AudioTap::Ptr tap = new AudioTap ("Benchmark", AudioTapService::defaultCapacity);
+    tap->prepare (44100.0);
+
+    AudioTap::Subscription subscription (tap);
+    ScopeSource source (std::move (subscription));
+
+    const auto signal = makeTestSignal (44100 * 30);
+    juce::AudioBuffer<float> block (2, 512);
+
+    for (size_t i = 0; i + 512 <= signal.size(); i += 512)
+    {
+        block.copyFrom (0, 0, signal.data() + i, 512);
+        block.copyFrom (1, 0, signal.data() + i, 512);
+        tap->write (block, 0, 512);
+    }
+
+    std::vector<float> mins (1200), maxs (1200);
+
+    for (auto window : { ScopeSettings::Window::ms20, ScopeSettings::Window::beat, ScopeSettings::Window::eightBars })
+    {
+        ScopeSettings settings;
+        settings.trigger = window == ScopeSettings::Window::ms20 ? ScopeSettings::Trigger::zeroCrossing
+                                                                 : ScopeSettings::Trigger::free;
+        settings.window = window;
+        source.setSettings (settings);
+
+        BENCHMARK ((ScopeSettings::getWindowNames()[(int) window] + " window, 1200 columns").toStdString())
+        {
+            return source.getColumns (mins.data(), maxs.data(), 1200);
+        };
+    }
+}
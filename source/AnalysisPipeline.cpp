@@ -0,0 +1,150 @@
+#include "AnalysisPipeline.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+AnalysisBlock::AnalysisBlock (int numChannels, int maxSamples)
+    : audio (numChannels, maxSamples), mono (1, maxSamples)
+{
+}
+
+//==============================================================================
+AnalysisPipeline::AnalysisPipeline (TaskPriority priority)
+    : extractorTasks (priority)
+{
+}
+
+AnalysisPipeline::~AnalysisPipeline()
+{
+    // Nothing may still be using the extractors when they're deleted
+    extractorTasks.wait();
+}
+
+void AnalysisPipeline::addExtractor (std::unique_ptr<FeatureExtractor> extractor)
+{
+    extractors.push_back (std::move (extractor));
+}
+
+bool AnalysisPipeline::run (const juce::File& file, TrackAnalysis& result, const std::function<bool()>& shouldAbort)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+
+    if (reader == nullptr)
+    {
+        DBG ("AnalysisPipeline: failed to create audio reader for " + file.getFileName());
+        return false;
+    }
+
+    DBG ("AnalysisPipeline: analysing " + file.getFileName()
+         + " (Sample rate: " + juce::String (reader->sampleRate)
+         + ", Channels: " + juce::String (reader->numChannels)
+         + ", Length: " + juce::String (reader->lengthInSamples) + " samples"
+         + ", Extractors: " + juce::String ((int) extractors.size()) + ")");
+
+    AnalysisFormat format;
+    format.file = file;
+    format.sampleRate = reader->sampleRate;
+    format.numChannels = juce::jlimit (1, 2, (int) reader->numChannels);
+    format.lengthInSamples = reader->lengthInSamples;
+    format.maxBlockSize = blockSize;
+
+    for (auto& e : extractors)
+        e->prepare (format);
+
+    juce::int64 position = 0;
+    Batch current, next;
+    bool ok = decodeBatch (*reader, position, current);
+
+    while (ok && ! current.empty())
+    {
+        if (shouldAbort && shouldAbort())
+        {
+            ok = false;
+            break;
+        }
+
+        // Extractors work on this batch while we decode the next one
+        startProcessing (current);
+        ok = decodeBatch (*reader, position, next);
+        waitForProcessing();
+
+        std::swap (current, next);
+        next.clear();
+    }
+
+    if (! ok)
+        return false;
+
+    for (auto& e : extractors)
+        e->finish (result);
+
+    return true;
+}
+
+AnalysisBlock* AnalysisPipeline::getFreeBlock (int numChannels)
+{
+    // Only the pool holds a reference to a block once its batch has been processed
+    for (auto& block : blockPool)
+        if (block->getReferenceCount() == 1 && block->audio.getNumChannels() == numChannels)
+            return block.get();
+
+    blockPool.push_back (new AnalysisBlock (numChannels, blockSize));
+    return blockPool.back().get();
+}
+
+bool AnalysisPipeline::decodeBatch (juce::AudioFormatReader& reader, juce::int64& position, Batch& batch)
+{
+    const int numChannels = juce::jlimit (1, 2, (int) reader.numChannels);
+
+    while ((int) batch.size() < blocksPerBatch && position < reader.lengthInSamples)
+    {
+        auto* block = getFreeBlock (numChannels);
+        const int numSamples = (int) juce::jmin ((juce::int64) blockSize, reader.lengthInSamples - position);
+
+        if (! reader.read (&block->audio, 0, numSamples, position, true, numChannels > 1))
+        {
+            DBG ("AnalysisPipeline: read failed at sample " + juce::String (position));
+            return false;
+        }
+
+        block->startSample = position;
+        block->numSamples = numSamples;
+
+        auto* mono = block->mono.getWritePointer (0);
+
+        if (numChannels > 1)
+        {
+            juce::FloatVectorOperations::add (mono, block->audio.getReadPointer (0), block->audio.getReadPointer (1), numSamples);
+            juce::FloatVectorOperations::multiply (mono, 0.5f, numSamples);
+        }
+        else
+        {
+            juce::FloatVectorOperations::copy (mono, block->audio.getReadPointer (0), numSamples);
+        }
+
+        batch.push_back (block);
+        position += numSamples;
+    }
+
+    return true;
+}
+
+void AnalysisPipeline::startProcessing (const Batch& batch)
+{
+    // One task per extractor, so each one still sees its blocks in order
+    for (auto& e : extractors)
+    {
+        extractorTasks.run ([extractor = e.get(), &batch]
+        {
+            for (auto& block : batch)
+                extractor->process (*block);
+        });
+    }
+}
+
+void AnalysisPipeline::waitForProcessing()
+{
+    extractorTasks.wait();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include "TaskScheduler.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct TrackAnalysis;
+
+//==============================================================================
+/** Describes the stream every extractor in a pipeline is about to see. */
+struct AnalysisFormat
+{
+    juce::File file;
+    double sampleRate = 44100.0;
+    int numChannels = 1;
+    juce::int64 lengthInSamples = 0;
+    int maxBlockSize = 0;
+};
+
+//==============================================================================
+/** One decoded block of the file, shared read-only between all extractors.
+
+    Blocks are reference counted and never modified after decoding, so every
+    extractor reads the same memory and nothing gets copied per consumer.
+    The mono mix-down is made once here too, since most extractors want it.
+*/
+class AnalysisBlock  : public juce::ReferenceCountedObject
+{
+public:
+    // Reference counting needs a non-const object; extractors only ever get a const AnalysisBlock&
+    using Ptr = juce::ReferenceCountedObjectPtr<AnalysisBlock>;
+
+    AnalysisBlock (int numChannels, int maxSamples);
+
+    juce::int64 startSample = 0;
+    int numSamples = 0;
+
+    const juce::AudioBuffer<float>& getAudio() const noexcept  { return audio; }
+    const float* getMono() const noexcept                       { return mono.getReadPointer (0); }
+
+private:
+    friend class AnalysisPipeline;
+
+    juce::AudioBuffer<float> audio, mono;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisBlock)
+};
+
+//==============================================================================
+/** A single feature computed from the decoded stream.
+
+    process() is always called with consecutive blocks in file order and never
+    concurrently with itself, but different extractors run in parallel with
+    each other, so an extractor mustn't touch anything outside its own state.
+*/
+class FeatureExtractor
+{
+public:
+    virtual ~FeatureExtractor() = default;
+
+    virtual void prepare (const AnalysisFormat&) = 0;
+    virtual void process (const AnalysisBlock&) = 0;
+
+    /** Called once the whole file has been seen, to write the results.
+        Extractors finish in the order they were added, so one can build on
+        the results of another that was added before it.
+    */
+    virtual void finish (TrackAnalysis&) = 0;
+};
+
+//==============================================================================
+/** Decodes a file exactly once and fans every block out to a set of
+    FeatureExtractors.
+
+    Decoding happens on the calling thread. Blocks are gathered into batches,
+    and while the extractors chew through one batch in parallel on the
+    TaskScheduler, the next batch is being decoded, so a file costs roughly
+    one decode plus its slowest extractor rather than the sum of all of them.
+*/
+class AnalysisPipeline
+{
+public:
+    explicit AnalysisPipeline (TaskPriority priority = TaskPriority::bulk);
+    ~AnalysisPipeline();
+
+    void addExtractor (std::unique_ptr<FeatureExtractor>);
+
+    /** Runs the pipeline over the file. Returns false if the file couldn't be
+        read or shouldAbort() returned true along the way.
+    */
+    bool run (const juce::File& file, TrackAnalysis& result,
+              const std::function<bool()>& shouldAbort = {});
+
+    static constexpr int blockSize = 4096;
+    static constexpr int blocksPerBatch = 32;
+
+private:
+    using Batch = std::vector<AnalysisBlock::Ptr>;
+
+    AnalysisBlock* getFreeBlock (int numChannels);
+    bool decodeBatch (juce::AudioFormatReader&, juce::int64& position, Batch&);
+    void startProcessing (const Batch&);
+    void waitForProcessing();
+
+    std::vector<std::unique_ptr<FeatureExtractor>> extractors;
+
+    // Blocks are recycled once no batch refers to them any more, so memory
+    // stays at two batches' worth however long the file is
+    std::vector<AnalysisBlock::Ptr> blockPool;
+
+    TaskScheduler::TaskGroup extractorTasks;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisPipeline)
+};
@@ -0,0 +1,297 @@
+#include "AudioTap.h"
+#include "RealtimeMode.h"
+
+#include <cstring>
+
+//==============================================================================
+AudioTap::AudioTap (const juce::String& tapName, int capacityInSamples)
+    : name (tapName), capacity (juce::jmax (1, capacityInSamples)), ring (numChannels, capacity)
+{
+    ring.clear();
+
+    for (auto& level : envelopes)
+    {
+        level.mins.assign ((size_t) envelopeCapacity, 0.0f);
+        level.maxs.assign ((size_t) envelopeCapacity, 0.0f);
+    }
+}
+
+void AudioTap::prepare (double newSampleRate) noexcept
+{
+    setSampleRate (newSampleRate);
+    meter.prepare (newSampleRate);
+}
+
+void AudioTap::prefault() noexcept
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+        RealtimeMode::prefault (ring.getWritePointer (ch), sizeof (float) * (size_t) capacity);
+
+    for (auto& level : envelopes)
+    {
+        RealtimeMode::prefault (level.mins.data(), sizeof (float) * level.mins.size());
+        RealtimeMode::prefault (level.maxs.data(), sizeof (float) * level.maxs.size());
+    }
+}
+
+void AudioTap::write (const juce::AudioBuffer<float>& source, int startSample, int numSamples) noexcept
+{
+    const int numSourceChannels = source.getNumChannels();
+
+    if (numSourceChannels == 0 || numSamples <= 0)
+        return;
+
+    // The envelope sees the whole block, so its points stay lined up with the samples
+    writeEnvelope (source, startSample, numSamples);
+    meter.process (source, startSample, numSamples);
+
+    // Only the newest capacity samples of an oversized block can be kept
+    if (numSamples > capacity)
+    {
+        startSample += numSamples - capacity;
+        numSamples = capacity;
+    }
+
+    const auto position = writePosition.load (std::memory_order_relaxed);
+    const int ringStart = (int) (position % capacity);
+    const int size1 = juce::jmin (numSamples, capacity - ringStart);
+    const int size2 = numSamples - size1;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* src = source.getReadPointer (juce::jmin (ch, numSourceChannels - 1), startSample);
+
+        juce::FloatVectorOperations::copy (ring.getWritePointer (ch, ringStart), src, size1);
+
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy (ring.getWritePointer (ch), src + size1, size2);
+    }
+
+    writePosition.store (position + numSamples, std::memory_order_release);
+}
+
+void AudioTap::writeEnvelope (const juce::AudioBuffer<float>& source, int startSample, int numSamples) noexcept
+{
+    const int numSourceChannels = source.getNumChannels();
+    const auto* left = source.getReadPointer (0, startSample);
+    const auto* right = source.getReadPointer (juce::jmin (1, numSourceChannels - 1), startSample);
+    auto& level0 = envelopes[0];
+
+    for (int done = 0; done < numSamples;)
+    {
+        // Up to the end of the point being built
+        const int count = juce::jmin (numSamples - done, envelopeDecimation - level0.pendingCount);
+
+        juce::FloatVectorOperations::add (envelopeScratch.data(), left + done, right + done, count);
+        const auto range = juce::FloatVectorOperations::findMinAndMax (envelopeScratch.data(), count);
+
+        addToEnvelope (0, range.getStart(), range.getEnd(), count);
+        done += count;
+    }
+}
+
+void AudioTap::addToEnvelope (int levelIndex, float minValue, float maxValue, int count) noexcept
+{
+    auto& level = envelopes[(size_t) levelIndex];
+
+    if (level.pendingCount == 0)
+    {
+        level.pendingMin = minValue;
+        level.pendingMax = maxValue;
+    }
+    else
+    {
+        level.pendingMin = juce::jmin (level.pendingMin, minValue);
+        level.pendingMax = juce::jmax (level.pendingMax, maxValue);
+    }
+
+    level.pendingCount += count;
+
+    if (level.pendingCount < envelopeDecimation)
+        return;
+
+    const auto point = level.numPoints.load (std::memory_order_relaxed);
+    const auto index = (size_t) (point % envelopeCapacity);
+    level.mins[index] = level.pendingMin;
+    level.maxs[index] = level.pendingMax;
+    level.pendingCount = 0;
+    level.numPoints.store (point + 1, std::memory_order_release);
+
+    // Every envelopeDecimation points here make one at the next level up
+    if (levelIndex + 1 < numEnvelopeLevels)
+        addToEnvelope (levelIndex + 1, level.pendingMin, level.pendingMax, 1);
+}
+
+juce::int64 AudioTap::getNumEnvelopePoints (int level) const noexcept
+{
+    return envelopes[(size_t) juce::jlimit (0, numEnvelopeLevels - 1, level)].numPoints.load (std::memory_order_acquire);
+}
+
+void AudioTap::readEnvelope (int levelIndex, juce::int64 firstPoint, float* mins, float* maxs, int numPoints) const
+{
+    const auto& level = envelopes[(size_t) juce::jlimit (0, numEnvelopeLevels - 1, levelIndex)];
+    const auto end = level.numPoints.load (std::memory_order_acquire);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const auto point = firstPoint + i;
+
+        if (point < 0 || point >= end || point < end - envelopeCapacity)
+        {
+            mins[i] = maxs[i] = 0.0f;
+        }
+        else
+        {
+            const auto index = (size_t) (point % envelopeCapacity);
+            mins[i] = level.mins[index];
+            maxs[i] = level.maxs[index];
+        }
+    }
+
+    // Anything the writer lapped while we were copying is torn
+    const auto lappedTo = level.numPoints.load (std::memory_order_acquire) - envelopeCapacity;
+
+    for (int i = 0; i < numPoints && firstPoint + i < lappedTo; ++i)
+        mins[i] = maxs[i] = 0.0f;
+}
+
+void AudioTap::copyOut (juce::int64 position, juce::AudioBuffer<float>& dest, int destStart, int numSamples) const
+{
+    const int ringStart = (int) (position % capacity);
+    const int size1 = juce::jmin (numSamples, capacity - ringStart);
+    const int size2 = numSamples - size1;
+
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+    {
+        const int srcChannel = juce::jmin (ch, numChannels - 1);
+        dest.copyFrom (ch, destStart, ring, srcChannel, ringStart, size1);
+
+        if (size2 > 0)
+            dest.copyFrom (ch, destStart + size1, ring, srcChannel, 0, size2);
+    }
+}
+
+bool AudioTap::readLatest (juce::AudioBuffer<float>& dest, int numSamples) const
+{
+    numSamples = juce::jmin (numSamples, dest.getNumSamples(), capacity);
+    const auto end = getWritePosition();
+
+    if (end == 0 || numSamples <= 0)
+        return false;
+
+    const int available = (int) juce::jmin ((juce::int64) numSamples, end);
+    const int padding = numSamples - available;
+
+    if (padding > 0)
+        dest.clear (0, padding);
+
+    copyOut (end - available, dest, padding, available);
+    return true;
+}
+
+int AudioTap::read (juce::int64& position, juce::AudioBuffer<float>& dest, int numSamples) const
+{
+    const auto end = getWritePosition();
+
+    // Leave some slack so we don't start on what's about to be overwritten
+    const auto oldest = juce::jmax ((juce::int64) 0, end - capacity + capacity / 4);
+    position = juce::jlimit (oldest, end, position);
+
+    const int count = (int) juce::jmin ((juce::int64) juce::jmin (numSamples, dest.getNumSamples()), end - position);
+
+    if (count <= 0)
+        return 0;
+
+    copyOut (position, dest, 0, count);
+    position += count;
+
+    // If the writer lapped us while we were copying, the start of what we have is torn
+    const auto lappedTo = getWritePosition() - capacity;
+    const auto copiedFrom = position - count;
+
+    if (lappedTo <= copiedFrom)
+        return count;
+
+    const int torn = (int) juce::jmin ((juce::int64) count, lappedTo - copiedFrom);
+
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+        std::memmove (dest.getWritePointer (ch), dest.getReadPointer (ch, torn), sizeof (float) * (size_t) (count - torn));
+
+    return count - torn;
+}
+
+//==============================================================================
+AudioTap::Subscription::Subscription (Ptr t)  : tap (std::move (t))
+{
+    if (tap != nullptr)
+        tap->numSubscribers.fetch_add (1, std::memory_order_relaxed);
+}
+
+AudioTap::Subscription::~Subscription()
+{
+    if (tap != nullptr)
+        tap->numSubscribers.fetch_sub (1, std::memory_order_relaxed);
+}
+
+AudioTap::Subscription::Subscription (Subscription&& other) noexcept
+    : tap (std::move (other.tap))
+{
+    other.tap = nullptr;
+}
+
+AudioTap::Subscription& AudioTap::Subscription::operator= (Subscription&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (tap != nullptr)
+            tap->numSubscribers.fetch_sub (1, std::memory_order_relaxed);
+
+        tap = std::move (other.tap);
+        other.tap = nullptr;
+    }
+
+    return *this;
+}
+
+//==============================================================================
+AudioTap::Ptr AudioTapService::getOrCreateTap (const juce::String& name)
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto* tap : taps)
+        if (tap->getName() == name)
+            return tap;
+
+    return taps.add (new AudioTap (name, defaultCapacity));
+}
+
+AudioTap::Subscription AudioTapService::subscribe (const juce::String& name)
+{
+    return AudioTap::Subscription (getOrCreateTap (name));
+}
+
+void AudioTapService::prefault() const
+{
+    const juce::ScopedLock sl (lock);
+
+    for (auto* tap : taps)
+        tap->prefault();
+}
+
+void AudioTapService::shutdown()
+{
+    const juce::ScopedLock sl (lock);
+    taps.clear();
+}
+
+juce::StringArray AudioTapService::getTapNames() const
+{
+    const juce::ScopedLock sl (lock);
+
+    juce::StringArray names;
+
+    for (auto* tap : taps)
+        names.add (tap->getName());
+
+    return names;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "LevelMeter.h"
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/** A named point in the audio graph that other threads can watch.
+
+    The audio thread writes every block into a fixed-size stereo ring, counting
+    samples from when the tap was created. Readers never lock or block the
+    writer: visualisers grab the most recent samples, while analysers and
+    recorders keep their own position and read on from it, finding out if the
+    writer has lapped them. Writing only happens while someone is subscribed,
+    so a tap nobody reads costs a single atomic load per block.
+
+    Alongside the samples, the writer keeps a min/max envelope of the two
+    channels summed, decimated in two levels. Scopes showing seconds of audio
+    read a few thousand envelope points instead of every sample, so a long
+    window costs them no more per frame than a short one. A LevelMeter runs
+    on the same blocks for the meters.
+
+    Taps are reference-counted and shared between the plugin writing them and
+    every subscriber, so no one owns one another's buffers.
+*/
+class AudioTap  : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<AudioTap>;
+
+    static constexpr int numChannels = 2;
+
+    AudioTap (const juce::String& name, int capacityInSamples);
+
+    const juce::String& getName() const noexcept        { return name; }
+    int getCapacity() const noexcept                    { return capacity; }
+    double getSampleRate() const noexcept               { return sampleRate.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Audio thread: false when no one is subscribed, so the block can be skipped. */
+    bool isWanted() const noexcept                      { return numSubscribers.load (std::memory_order_relaxed) > 0; }
+
+    void setSampleRate (double newRate) noexcept        { sampleRate = newRate; }
+
+    /** Sets the rate for the tap and its meter. Safe while blocks are being written. */
+    void prepare (double newSampleRate) noexcept;
+
+    /** Writes to the ring and envelope pages so the writer never faults on
+        them. Clears what the tap holds, so call it before playback starts.
+    */
+    void prefault() noexcept;
+
+    /** Audio thread: appends a block. A mono source is written to both channels. */
+    void write (const juce::AudioBuffer<float>& source, int startSample, int numSamples) noexcept;
+
+    //==============================================================================
+    /** Total number of samples written so far. */
+    juce::int64 getWritePosition() const noexcept       { return writePosition.load (std::memory_order_acquire); }
+
+    /** Copies the most recent numSamples into dest, zero-padding if fewer have
+        been written. Returns false if nothing has been written yet.
+    */
+    bool readLatest (juce::AudioBuffer<float>& dest, int numSamples) const;
+
+    /** Copies up to numSamples from position onwards, for readers that need
+        every sample, and moves position on past them. The samples copied are
+        always the ones just before the new position. If the writer has
+        already overwritten part of what was asked for, the read skips forward
+        past it, so a jump of more than the returned count means samples were
+        missed.
+        Returns the number of samples copied.
+    */
+    int read (juce::int64& position, juce::AudioBuffer<float>& dest, int numSamples) const;
+
+    //==============================================================================
+    /** Levels at this point, kept up to date while anyone is subscribed. */
+    const LevelMeter& getMeter() const noexcept         { return meter; }
+
+    //==============================================================================
+    static constexpr int numEnvelopeLevels = 2;
+    static constexpr int envelopeDecimation = 16;
+    static constexpr int envelopeCapacity = 1 << 13;
+
+    /** Samples covered by one point: 16 at level 0, 256 at level 1.
+        Point n of a level covers samples n * samplesPerPoint onwards.
+    */
+    static constexpr int getSamplesPerPoint (int level) noexcept
+    {
+        return level <= 0 ? envelopeDecimation : envelopeDecimation * getSamplesPerPoint (level - 1);
+    }
+
+    /** Number of finished points at a level so far. */
+    juce::int64 getNumEnvelopePoints (int level) const noexcept;
+
+    /** Copies numPoints envelope points from firstPoint onwards. Points that
+        haven't been written yet, or have already been overwritten, come back
+        as zero.
+    */
+    void readEnvelope (int level, juce::int64 firstPoint, float* mins, float* maxs, int numPoints) const;
+
+    //==============================================================================
+    /** Keeps a tap alive and being written while a reader holds it. */
+    class Subscription
+    {
+    public:
+        Subscription() = default;
+        explicit Subscription (Ptr);
+        ~Subscription();
+
+        Subscription (Subscription&&) noexcept;
+        Subscription& operator= (Subscription&&) noexcept;
+
+        AudioTap* get() const noexcept                  { return tap.get(); }
+        AudioTap* operator->() const noexcept           { return tap.get(); }
+        explicit operator bool() const noexcept         { return tap != nullptr; }
+
+    private:
+        Ptr tap;
+
+        JUCE_DECLARE_NON_COPYABLE (Subscription)
+    };
+
+private:
+    struct EnvelopeLevel
+    {
+        std::vector<float> mins, maxs;
+        std::atomic<juce::int64> numPoints { 0 };
+
+        // Audio thread only: the point being built
+        float pendingMin = 0.0f, pendingMax = 0.0f;
+        int pendingCount = 0;
+    };
+
+    void copyOut (juce::int64 position, juce::AudioBuffer<float>& dest, int destStart, int numSamples) const;
+    void writeEnvelope (const juce::AudioBuffer<float>& source, int startSample, int numSamples) noexcept;
+    void addToEnvelope (int level, float minValue, float maxValue, int count) noexcept;
+
+    const juce::String name;
+    const int capacity;
+    juce::AudioBuffer<float> ring;
+
+    std::atomic<juce::int64> writePosition { 0 };
+    std::atomic<int> numSubscribers { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    std::array<EnvelopeLevel, numEnvelopeLevels> envelopes;
+    std::array<float, envelopeDecimation> envelopeScratch {};
+
+    LevelMeter meter;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioTap)
+};
+
+//==============================================================================
+/** The taps ChopShop puts in the graph. */
+namespace TapNames
+{
+    static const char* const master = "Master";         // end of the master track, before the recorder
+    static const char* const effectsIn = "FX In";       // everything sent to the effects
+    static const char* const effectsOut = "FX Out";     // the effect returns summed, i.e. what the effects add
+
+    /** A deck's output after its chop voices, before the send and fader. */
+    inline juce::String deck (int index)                { return "Deck " + juce::String::charToString ((juce::juce_wchar) ('A' + index)); }
+}
+
+//==============================================================================
+/** Looks taps up by name.
+
+    A tap is created the first time anything asks for its name, whether that's
+    the plugin that writes it or a reader, so the two can be set up in either
+    order. Lookups take a lock and are meant for setup, not the audio thread.
+*/
+class AudioTapService
+{
+public:
+    static AudioTapService* getInstance()
+    {
+        static AudioTapService instance;
+        return &instance;
+    }
+
+    /** About three seconds at 44.1kHz, enough for a few FFT frames or a couple of bars of scope. */
+    static constexpr int defaultCapacity = 1 << 17;
+
+    AudioTap::Ptr getOrCreateTap (const juce::String& name);
+    AudioTap::Subscription subscribe (const juce::String& name);
+
+    /** Prefaults every tap, before playback starts. */
+    void prefault() const;
+
+    juce::StringArray getTapNames() const;
+
+    /** Lets go of every tap, so they're freed while JUCE's leak detectors are
+        still around rather than with this static. Call at app shutdown, once
+        the edit and everything reading the taps has gone.
+    */
+    void shutdown();
+
+private:
+    AudioTapService() = default;
+
+    juce::CriticalSection lock;
+    juce::ReferenceCountedArray<AudioTap> taps;
+
+    JUCE_DECLARE_NON_COPYABLE (AudioTapService)
+};
@@ -126,6 +126,53 @@ void BaseEffectComponent::bindSliderToParameter(juce::Slider& slider, tracktion:
     
     slider.onDragStart = [&param] { param.parameterChangeGestureBegin(); };
     slider.onDragEnd = [&param] { param.parameterChangeGestureEnd(); };
+    
+    bindings.push_back({ &slider, &param });
+}
+
+std::vector<std::pair<juce::String, float>> BaseEffectComponent::getParameterValues() const
+{
+    std::vector<std::pair<juce::String, float>> values;
+    
+    for (const auto& binding : bindings)
+        values.emplace_back(binding.parameter->paramID, binding.parameter->getCurrentValue());
+    
+    return values;
+}
+
+void BaseEffectComponent::setParameterValue(const juce::String& id, float value)
+{
+    for (const auto& binding : bindings)
+    {
+        if (binding.parameter->paramID == id)
+        {
+            binding.parameter->setParameter(value, juce::sendNotification);
+            binding.slider->setValue(binding.parameter->getCurrentValue(), juce::dontSendNotification);
+            return;
+        }
+    }
+}
+
+std::vector<tracktion::engine::AutomatableParameter::Ptr> BaseEffectComponent::getBoundParameters() const
+{
+    std::vector<tracktion::engine::AutomatableParameter::Ptr> parameters;
+    
+    for (const auto& binding : bindings)
+        parameters.push_back(binding.parameter);
+    
+    return parameters;
+}
+
+void BaseEffectComponent::updateSlidersFromParameters()
+{
+    for (const auto& binding : bindings)
+        binding.slider->setValue(binding.parameter->getCurrentValue(), juce::dontSendNotification);
+}
+
+void BaseEffectComponent::showValues(const std::function<float(const tracktion::engine::AutomatableParameter&)>& valueOf)
+{
+    for (const auto& binding : bindings)
+        binding.slider->setValue(valueOf(*binding.parameter), juce::dontSendNotification);
 }
 
 tracktion::engine::Plugin::Ptr BaseEffectComponent::createPlugin(const juce::String& xmlType)
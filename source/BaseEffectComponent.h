@@ -52,6 +52,21 @@ public:
     void setMixParameterId(const juce::String& id) { mixParameterId = id; }
     tracktion::engine::Plugin::Ptr getPlugin() const { return plugin; }
     
+    /** The value of every control on the panel by ID, for saving with a session. */
+    virtual std::vector<std::pair<juce::String, float>> getParameterValues() const;
+    
+    /** Moves a control and whatever it's bound to. IDs the panel doesn't have are ignored. */
+    virtual void setParameterValue(const juce::String& id, float value);
+    
+    /** The parameters bound to the panel's sliders, in the order they were bound. */
+    std::vector<tracktion::engine::AutomatableParameter::Ptr> getBoundParameters() const;
+    
+    /** Moves the sliders to match parameters that were set from elsewhere. */
+    void updateSlidersFromParameters();
+    
+    /** Moves the sliders to show values the parameters don't hold yet, e.g. a scene on its way in. */
+    void showValues(const std::function<float(const tracktion::engine::AutomatableParameter&)>& valueOf);
+    
 protected:
     void bindSliderToParameter(juce::Slider& slider, tracktion::engine::AutomatableParameter& param);
     tracktion::engine::Plugin::Ptr createPlugin(const juce::String& xmlType);
@@ -67,6 +82,14 @@ protected:
 private:
     void drawScrew(juce::Graphics& g, float x, float y);
     juce::Random random;
+    
+    struct Binding
+    {
+        juce::Slider* slider;
+        tracktion::engine::AutomatableParameter* parameter;
+    };
+    
+    std::vector<Binding> bindings;
 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BaseEffectComponent)
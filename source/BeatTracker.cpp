@@ -0,0 +1,254 @@
+#include "BeatTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::vector<int> BeatTracker::trackBeats (const std::vector<double>& onsets, double framesPerBeat, double tightness)
+{
+    const int numFrames = (int) onsets.size();
+
+    if (framesPerBeat < 2.0 || numFrames < framesPerBeat * 4.0)
+        return {};
+
+    // Scale to unit deviation so the tightness means the same for quiet and loud tracks
+    double sum = 0.0, sumOfSquares = 0.0;
+
+    for (auto v : onsets)
+    {
+        sum += v;
+        sumOfSquares += v * v;
+    }
+
+    const double mean = sum / numFrames;
+    const double deviation = std::sqrt (juce::jmax (0.0, sumOfSquares / numFrames - mean * mean));
+
+    if (deviation <= 0.0)
+        return {};
+
+    // Smooth over about a 32nd of a beat, so an onset a frame or two off still counts
+    const double sigma = framesPerBeat / 32.0;
+    const int radius = juce::jmax (1, (int) std::ceil (sigma * 2.0));
+
+    std::vector<double> kernel ((size_t) (radius * 2 + 1));
+
+    for (int i = -radius; i <= radius; ++i)
+        kernel[(size_t) (i + radius)] = std::exp (-0.5 * (i * i) / (sigma * sigma)) / deviation;
+
+    std::vector<double> local ((size_t) numFrames, 0.0);
+
+    for (int t = 0; t < numFrames; ++t)
+        for (int i = juce::jmax (0, t - radius); i <= juce::jmin (numFrames - 1, t + radius); ++i)
+            local[(size_t) t] += onsets[(size_t) i] * kernel[(size_t) (i - t + radius)];
+
+    // The previous beat is looked for between half a beat and two beats back,
+    // penalised by how far the gap is from a beat, in log time
+    const int minGap = juce::jmax (1, juce::roundToInt (framesPerBeat * 0.5));
+    const int maxGap = juce::roundToInt (framesPerBeat * 2.0);
+
+    std::vector<double> penalty ((size_t) maxGap + 1, 0.0);
+
+    for (int gap = minGap; gap <= maxGap; ++gap)
+    {
+        const double stretch = std::log (gap / framesPerBeat);
+        penalty[(size_t) gap] = -tightness * stretch * stretch;
+    }
+
+    // Best score of any beat sequence ending on each frame, and the beat before it
+    std::vector<double> score ((size_t) numFrames);
+    std::vector<int> previous ((size_t) numFrames, -1);
+
+    for (int t = 0; t < numFrames; ++t)
+    {
+        double best = -std::numeric_limits<double>::infinity();
+        int bestFrame = -1;
+
+        for (int gap = minGap; gap <= juce::jmin (maxGap, t); ++gap)
+        {
+            const double candidate = score[(size_t) (t - gap)] + penalty[(size_t) gap];
+
+            if (candidate > best)
+            {
+                best = candidate;
+                bestFrame = t - gap;
+            }
+        }
+
+        // A sequence can also start here, if nothing before is worth joining
+        if (bestFrame >= 0 && best > 0.0)
+        {
+            score[(size_t) t] = local[(size_t) t] + best;
+            previous[(size_t) t] = bestFrame;
+        }
+        else
+        {
+            score[(size_t) t] = local[(size_t) t];
+        }
+    }
+
+    // End on the best frame within the last beat, and follow the chain back
+    int last = numFrames - 1;
+
+    for (int t = juce::jmax (0, numFrames - (int) std::ceil (framesPerBeat)); t < numFrames; ++t)
+        if (score[(size_t) t] > score[(size_t) last])
+            last = t;
+
+    std::vector<int> beats;
+
+    for (int t = last; t >= 0; t = previous[(size_t) t])
+        beats.push_back (t);
+
+    std::reverse (beats.begin(), beats.end());
+    return beats;
+}
+
+//==============================================================================
+static double median (std::vector<double> values)
+{
+    const auto mid = values.begin() + (std::ptrdiff_t) (values.size() / 2);
+    std::nth_element (values.begin(), mid, values.end());
+    return *mid;
+}
+
+BeatTracker::GridFit BeatTracker::fitGrid (const std::vector<double>& beats, double bpm)
+{
+    if (beats.size() < 2 || bpm <= 0.0)
+        return {};
+
+    const double period = 60.0 / bpm;
+
+    // Start from the phase the first few beats agree on most, measured round
+    // the beat, so one stray beat at the top can't throw off the numbering
+    const size_t numOpening = juce::jmin ((size_t) 16, beats.size());
+    double phase = 0.0, bestSpread = std::numeric_limits<double>::max();
+
+    for (size_t i = 0; i < numOpening; ++i)
+    {
+        const double candidate = std::fmod (beats[i], period);
+        double spread = 0.0;
+
+        for (size_t j = 0; j < numOpening; ++j)
+        {
+            const double distance = std::abs (std::fmod (beats[j], period) - candidate);
+            spread += juce::jmin (distance, period - distance);
+        }
+
+        if (spread < bestSpread)
+        {
+            bestSpread = spread;
+            phase = candidate;
+        }
+    }
+
+    // Number each beat by the slot it's closest to. The slots are measured
+    // from where the recent beats sit rather than from a fixed start, so a
+    // track that drifts by more than half a beat over its length keeps
+    // counting one slot per beat
+    constexpr size_t numRecent = 8;
+    std::vector<double> recent { phase };
+    std::vector<juce::int64> slots;
+    GridFit fit;
+
+    for (auto beat : beats)
+    {
+        const double localOffset = median (recent);
+        const auto slot = (juce::int64) std::llround ((beat - localOffset) / period);
+        const double error = std::abs (beat - localOffset - (double) slot * period);
+
+        if (! slots.empty() && slot <= slots.back())
+        {
+            // A doubled beat: keep whichever of the two is nearer its slot
+            const double keptError = std::abs (fit.beats.back() - localOffset - (double) slots.back() * period);
+
+            if (slot < slots.back() || error >= keptError)
+                continue;
+
+            fit.beats.pop_back();
+            slots.pop_back();
+            recent.pop_back();
+        }
+
+        fit.beats.push_back (beat);
+        slots.push_back (slot);
+        recent.push_back (beat - (double) slot * period);
+
+        if (recent.size() > numRecent)
+            recent.erase (recent.begin());
+    }
+
+    if (fit.beats.size() < 2)
+        return {};
+
+    // The offset that leaves the typical beat where it was, so the cues worked
+    // out in source time move as little as possible; a median, so the odd
+    // misplaced beat doesn't pull the whole grid towards it
+    std::vector<double> residuals (fit.beats.size());
+
+    for (size_t i = 0; i < fit.beats.size(); ++i)
+        residuals[i] = fit.beats[i] - (double) slots[i] * period;
+
+    double offset = median (residuals);
+
+    // A grid can't start before the file does
+    offset = juce::jmax (offset, -(double) slots.front() * period);
+
+    fit.grid.resize (fit.beats.size());
+
+    for (size_t i = 0; i < fit.beats.size(); ++i)
+        fit.grid[i] = offset + (double) slots[i] * period;
+
+    return fit;
+}
+
+double BeatTracker::toGridTime (const std::vector<double>& beats, const std::vector<double>& grid, double sourceSeconds)
+{
+    if (beats.empty() || beats.size() != grid.size())
+        return sourceSeconds;
+
+    // Outside the beats, keep the shift of the nearest one
+    if (sourceSeconds <= beats.front())
+        return juce::jmax (0.0, sourceSeconds + grid.front() - beats.front());
+
+    if (sourceSeconds >= beats.back())
+        return sourceSeconds + grid.back() - beats.back();
+
+    const auto next = (size_t) (std::upper_bound (beats.begin(), beats.end(), sourceSeconds) - beats.begin());
+    const auto prev = next - 1;
+    const double proportion = (sourceSeconds - beats[prev]) / (beats[next] - beats[prev]);
+
+    return grid[prev] + proportion * (grid[next] - grid[prev]);
+}
+
+juce::String BeatTracker::beatsToString (const std::vector<double>& beats)
+{
+    juce::StringArray gaps;
+    juce::int64 previousMs = 0;
+
+    // Gaps between rounded times, so rounding never adds up along the track
+    for (auto beat : beats)
+    {
+        const auto ms = (juce::int64) std::llround (beat * 1000.0);
+        gaps.add (juce::String (ms - previousMs));
+        previousMs = ms;
+    }
+
+    return gaps.joinIntoString (" ");
+}
+
+std::vector<double> BeatTracker::beatsFromString (const juce::String& text)
+{
+    auto gaps = juce::StringArray::fromTokens (text, " ", {});
+
+    std::vector<double> beats;
+    beats.reserve ((size_t) gaps.size());
+
+    juce::int64 ms = 0;
+
+    for (auto& gap : gaps)
+    {
+        ms += gap.getLargeIntValue();
+        beats.push_back ((double) ms / 1000.0);
+    }
+
+    return beats;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <vector>
+
+//==============================================================================
+/** Places every beat of a track, for music whose tempo drifts.
+
+    MiniBPM gives one tempo for the whole file. This takes that tempo and the
+    onset detection function it was estimated from, and finds the sequence of
+    beats that best balances landing on strong onsets against keeping the gap
+    between neighbouring beats close to the estimated beat period, by dynamic
+    programming over every frame (after Ellis, "Beat Tracking by Dynamic
+    Programming", 2007). The cost is a pass over the frames with a window of
+    about a beat and a half each, which is small next to decoding the file.
+*/
+namespace BeatTracker
+{
+    /** Returns the frames of the onset function that beats fall on, in order.
+        framesPerBeat is the estimated beat period in frames; tightness sets
+        how strongly the gaps are held to it. Returns nothing if the function
+        is too short or silent.
+    */
+    std::vector<int> trackBeats (const std::vector<double>& onsets, double framesPerBeat,
+                                 double tightness = 100.0);
+
+    /** Tracked beats paired with the times on an evenly spaced grid they
+        should be moved to. Both are in seconds and the same length.
+    */
+    struct GridFit
+    {
+        std::vector<double> beats, grid;
+    };
+
+    /** Matches each beat to a slot of the evenly spaced grid at the given
+        tempo that lies closest to them. A beat the tracker missed leaves its
+        slot empty, and of two beats landing in one slot only the closer is
+        kept, so neither shifts the beats after it. The grid never starts
+        before zero.
+    */
+    GridFit fitGrid (const std::vector<double>& beats, double bpm);
+
+    /** Where a time in the source ends up once the beats are moved to the
+        grid, going linearly between the beats either side of it.
+    */
+    double toGridTime (const std::vector<double>& beats, const std::vector<double>& grid, double sourceSeconds);
+
+    /** Beat times in seconds, to and from the compact form kept in the library:
+        the gaps between them in whole milliseconds.
+    */
+    juce::String beatsToString (const std::vector<double>& beats);
+    std::vector<double> beatsFromString (const juce::String& text);
+}
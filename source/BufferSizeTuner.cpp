@@ -0,0 +1,233 @@
+#include "BufferSizeTuner.h"
+
+//==============================================================================
+BufferSizeTuner::BufferSizeTuner (juce::AudioDeviceManager& dm)
+    : deviceManager (dm)
+{
+}
+
+BufferSizeTuner::~BufferSizeTuner()
+{
+    stopTimer();
+}
+
+juce::Array<int> BufferSizeTuner::getCandidateSizes() const
+{
+    juce::Array<int> sizes;
+
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        for (auto size : device->getAvailableBufferSizes())
+            if (size >= minBufferSize && size <= maxBufferSize)
+                sizes.addUsingDefaultSort (size);
+
+    return sizes;
+}
+
+int BufferSizeTuner::getCurrentBufferSize() const
+{
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        return device->getCurrentBufferSizeSamples();
+
+    return 0;
+}
+
+bool BufferSizeTuner::setBufferSize (int size)
+{
+    auto setup = deviceManager.getAudioDeviceSetup();
+
+    if (setup.bufferSize == size)
+        return true;
+
+    setup.bufferSize = size;
+    const auto error = deviceManager.setAudioDeviceSetup (setup, true);
+
+    if (error.isNotEmpty())
+    {
+        DBG ("Buffer size " + juce::String (size) + " rejected: " + error);
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+void BufferSizeTuner::startAutoTune (std::function<void (const Result&)> onFinished)
+{
+    candidates = getCandidateSizes();
+    tuneFinished = std::move (onFinished);
+
+    if (candidates.isEmpty())
+    {
+        Result result;
+        result.bufferSize = getCurrentBufferSize();
+
+        if (tuneFinished != nullptr)
+            tuneFinished (result);
+
+        return;
+    }
+
+    tryCandidate (0);
+    startTimer (timerIntervalMs);
+}
+
+void BufferSizeTuner::cancelAutoTune()
+{
+    if (! isTuning())
+        return;
+
+    tuneFinished = nullptr;
+    state = watching ? State::watching : State::idle;
+
+    if (state == State::idle)
+        stopTimer();
+}
+
+void BufferSizeTuner::tryCandidate (int index)
+{
+    candidateIndex = index;
+    const int size = candidates[index];
+
+    if (! setBufferSize (size))
+    {
+        if (index + 1 < candidates.size())
+            tryCandidate (index + 1);
+        else
+            finishAutoTune();
+
+        return;
+    }
+
+    if (onBufferSizeChanged != nullptr)
+        onBufferSizeChanged (size, "trying");
+
+    state = State::settling;
+    ticks = 0;
+}
+
+void BufferSizeTuner::finishAutoTune()
+{
+    Result result;
+    result.bufferSize = getCurrentBufferSize();
+    result.peakLoad = peakLoad;
+    result.xruns = deviceManager.getXRunCount() - startXruns;
+    result.metTarget = result.xruns == 0 && peakLoad < targetPeakLoad;
+
+    // Nothing met the target: settle for the largest size
+    if (! result.metTarget && ! candidates.isEmpty())
+    {
+        setBufferSize (candidates.getLast());
+        result.bufferSize = getCurrentBufferSize();
+    }
+
+    DBG ("Buffer size tuned to " + juce::String (result.bufferSize) + " samples, peak load "
+         + juce::String (result.peakLoad * 100.0, 1) + "%, " + juce::String (result.xruns) + " xruns");
+
+    state = State::idle;
+    setWatching (watching);
+
+    if (auto callback = std::exchange (tuneFinished, nullptr))
+        callback (result);
+}
+
+//==============================================================================
+void BufferSizeTuner::setWatching (bool shouldWatch)
+{
+    watching = shouldWatch;
+
+    if (isTuning())
+        return;
+
+    if (watching)
+    {
+        state = State::watching;
+        ticksOverloaded = ticksInWindow = 0;
+        windowStartXruns = deviceManager.getXRunCount();
+        startTimer (timerIntervalMs);
+    }
+    else
+    {
+        state = State::idle;
+        stopTimer();
+    }
+}
+
+void BufferSizeTuner::watch()
+{
+    const bool overloaded = deviceManager.getCpuUsage() > overloadLoad;
+    ticksOverloaded = overloaded ? ticksOverloaded + 1 : 0;
+
+    const int xruns = deviceManager.getXRunCount() - windowStartXruns;
+    juce::String reason;
+
+    if (ticksOverloaded >= overloadTicks)
+        reason = "sustained overload";
+    else if (xruns >= maxXrunsWhileWatching)
+        reason = juce::String (xruns) + " xruns";
+
+    if (++ticksInWindow >= watchWindowTicks)
+    {
+        ticksInWindow = 0;
+        windowStartXruns = deviceManager.getXRunCount();
+    }
+
+    if (reason.isEmpty())
+        return;
+
+    // Step up to the next size the device offers, if there is one
+    const int current = getCurrentBufferSize();
+
+    for (auto size : getCandidateSizes())
+    {
+        if (size > current)
+        {
+            if (setBufferSize (size) && onBufferSizeChanged != nullptr)
+                onBufferSizeChanged (size, reason);
+
+            break;
+        }
+    }
+
+    ticksOverloaded = ticksInWindow = 0;
+    windowStartXruns = deviceManager.getXRunCount();
+}
+
+//==============================================================================
+void BufferSizeTuner::timerCallback()
+{
+    switch (state)
+    {
+        case State::settling:
+            if (++ticks >= settleTicks)
+            {
+                state = State::measuring;
+                ticks = 0;
+                peakLoad = 0.0;
+                startXruns = deviceManager.getXRunCount();
+            }
+            break;
+
+        case State::measuring:
+        {
+            peakLoad = juce::jmax (peakLoad, deviceManager.getCpuUsage());
+
+            const bool failed = deviceManager.getXRunCount() > startXruns || peakLoad >= targetPeakLoad;
+
+            if (failed && candidateIndex + 1 < candidates.size())
+                tryCandidate (candidateIndex + 1);
+            else if (failed || ++ticks >= measureTicks)
+                finishAutoTune();
+
+            break;
+        }
+
+        case State::watching:
+            watch();
+            break;
+
+        case State::idle:
+        default:
+            stopTimer();
+            break;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+
+#include <functional>
+
+//==============================================================================
+/** Picks the audio buffer size from measurements, and backs it off if the
+    machine can't keep up later on.
+
+    Auto-tuning steps through the device's buffer sizes from the smallest up.
+    At each size it lets the device settle, then watches the callback load and
+    the xrun count for a few seconds. It keeps the first size that has no xruns
+    and whose peak load leaves a safety margin. The caller puts a
+    representative load on the engine before it starts and takes it off again
+    when it's done.
+
+    Once tuned, the tuner keeps watching. If the load stays high, or xruns keep
+    coming, it steps up to the next size.
+
+    Everything runs from a timer on the message thread, which is where the
+    device has to be reconfigured anyway.
+*/
+class BufferSizeTuner  : private juce::Timer
+{
+public:
+    explicit BufferSizeTuner (juce::AudioDeviceManager&);
+    ~BufferSizeTuner() override;
+
+    static constexpr double targetPeakLoad = 0.7;       // the safety margin while tuning
+    static constexpr double overloadLoad = 0.9;         // sustained above this at runtime steps up
+    static constexpr int minBufferSize = 64, maxBufferSize = 2048;
+
+    struct Result
+    {
+        int bufferSize = 0;
+        double peakLoad = 0.0;
+        int xruns = 0;
+        bool metTarget = false;
+    };
+
+    /** Starts tuning. The load should already be running; onFinished is
+        called on the message thread with the size that was kept.
+    */
+    void startAutoTune (std::function<void (const Result&)> onFinished);
+    void cancelAutoTune();
+    bool isTuning() const noexcept                      { return state == State::settling || state == State::measuring; }
+
+    /** Watches for sustained overload and steps the buffer size up. */
+    void setWatching (bool shouldWatch);
+
+    /** Called on the message thread whenever the tuner changes the buffer
+        size: while tuning, for each size tried, and when the watchdog steps up.
+    */
+    std::function<void (int bufferSize, const juce::String& reason)> onBufferSizeChanged;
+
+private:
+    enum class State
+    {
+        idle,
+        settling,
+        measuring,
+        watching
+    };
+
+    void timerCallback() override;
+    void tryCandidate (int index);
+    void finishAutoTune();
+    void watch();
+
+    bool setBufferSize (int size);
+    int getCurrentBufferSize() const;
+    juce::Array<int> getCandidateSizes() const;
+
+    static constexpr int timerIntervalMs = 50;
+    static constexpr int settleTicks = 10;              // 0.5 s
+    static constexpr int measureTicks = 60;             // 3 s
+    static constexpr int overloadTicks = 40;            // 2 s
+    static constexpr int maxXrunsWhileWatching = 3;     // within watchWindowTicks
+    static constexpr int watchWindowTicks = 200;        // 10 s
+
+    juce::AudioDeviceManager& deviceManager;
+    State state = State::idle;
+    bool watching = false;
+
+    // Tuning
+    juce::Array<int> candidates;
+    int candidateIndex = 0;
+    int ticks = 0;
+    int startXruns = 0;
+    double peakLoad = 0.0;
+    std::function<void (const Result&)> tuneFinished;
+
+    // Watching
+    int ticksOverloaded = 0, ticksInWindow = 0, windowStartXruns = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferSizeTuner)
+};
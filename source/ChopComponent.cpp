@@ -37,6 +37,36 @@ ChopComponent::ChopComponent(tracktion::engine::Edit& edit)
             onCrossfaderValueChanged(crossfaderSlider.getValue());
     };
     
+    // Layer voices, off by default
+    layersLabel.setText("Layers", juce::dontSendNotification);
+    layersLabel.setJustificationType(juce::Justification::left);
+    
+    for (auto& comboBox : layerOffsetComboBoxes)
+    {
+        comboBox.addItem("Off", 1);
+        comboBox.addItem("1/2 Beat", 2);
+        comboBox.addItem("2 Beats", 3);
+        comboBox.addItem("3 Beats", 4);
+        comboBox.addItem("4 Beats", 5);
+        comboBox.setSelectedId(1, juce::dontSendNotification);
+        comboBox.onChange = [this] {
+            if (onLayersChanged)
+                onLayersChanged();
+        };
+        addAndMakeVisible(comboBox);
+    }
+    
+    layerLevelSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    layerLevelSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    layerLevelSlider.setRange(0.0, 1.0, 0.01);
+    layerLevelSlider.setValue(0.5, juce::dontSendNotification);
+    layerLevelSlider.onValueChange = [this] {
+        if (onLayersChanged)
+            onLayersChanged();
+    };
+    
+    addAndMakeVisible(layersLabel);
+    addAndMakeVisible(layerLevelSlider);
     addAndMakeVisible(durationLabel);
     addAndMakeVisible(chopDurationComboBox);
     addAndMakeVisible(chopButton);
@@ -87,15 +117,21 @@ void ChopComponent::resized()
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
     
-    grid.templateRows = { Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)) };
-    grid.templateColumns = { Track(Fr(1)) };
+    grid.templateRows = { Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)) };
+    grid.templateColumns = { Track(Fr(1)), Track(Fr(1)) };
+    
+    const auto fullWidth = juce::GridItem::Span(2);
     
     grid.items = {
-        juce::GridItem(durationLabel),
-        juce::GridItem(chopDurationComboBox).withHeight(30),
-        juce::GridItem(chopButton).withHeight(30),
-        juce::GridItem(crossfaderLabel),
-        juce::GridItem(crossfaderSlider)
+        juce::GridItem(durationLabel).withColumn({ 1, fullWidth }),
+        juce::GridItem(chopDurationComboBox).withHeight(30).withColumn({ 1, fullWidth }),
+        juce::GridItem(chopButton).withHeight(30).withColumn({ 1, fullWidth }),
+        juce::GridItem(crossfaderLabel).withColumn({ 1, fullWidth }),
+        juce::GridItem(crossfaderSlider).withColumn({ 1, fullWidth }),
+        juce::GridItem(layersLabel),
+        juce::GridItem(layerLevelSlider),
+        juce::GridItem(layerOffsetComboBoxes[0]).withHeight(30),
+        juce::GridItem(layerOffsetComboBoxes[1]).withHeight(30)
     };
     
     grid.performLayout(bounds.toNearestInt());
@@ -120,6 +156,49 @@ double ChopComponent::getChopDurationInMs(double currentTempo) const
     return beatDuration; // Default to 1 beat
 }
 
+double ChopComponent::getLayerOffsetInBeats(int layer) const
+{
+    if (!juce::isPositiveAndBelow(layer, numLayers))
+        return 0.0;
+    
+    switch (layerOffsetComboBoxes[layer].getSelectedId())
+    {
+        case 2: return 0.5;
+        case 3: return 2.0;
+        case 4: return 3.0;
+        case 5: return 4.0;
+        default: return 0.0;
+    }
+}
+
+std::vector<std::pair<juce::String, float>> ChopComponent::getParameterValues() const
+{
+    std::vector<std::pair<juce::String, float>> values {
+        { "duration", static_cast<float>(chopDurationComboBox.getSelectedId()) },
+        { "crossfader", getCrossfaderValue() },
+        { "layer level", getLayerLevel() }
+    };
+
+    for (int layer = 0; layer < numLayers; ++layer)
+        values.emplace_back("layer " + juce::String(layer + 1), static_cast<float>(layerOffsetComboBoxes[layer].getSelectedId()));
+
+    return values;
+}
+
+void ChopComponent::setParameterValue(const juce::String& id, float value)
+{
+    if (id == "duration")
+        chopDurationComboBox.setSelectedId(juce::roundToInt(value), juce::dontSendNotification);
+    else if (id == "crossfader")
+        crossfaderSlider.setValue(value, juce::sendNotificationSync);
+    else if (id == "layer level")
+        layerLevelSlider.setValue(value, juce::sendNotificationSync);
+
+    for (int layer = 0; layer < numLayers; ++layer)
+        if (id == "layer " + juce::String(layer + 1))
+            layerOffsetComboBoxes[layer].setSelectedId(juce::roundToInt(value), juce::sendNotificationSync);
+}
+
 void ChopComponent::mouseDown(const juce::MouseEvent& event)
 {
     if (event.eventComponent == &chopButton && onChopButtonPressed)
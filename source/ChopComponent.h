@@ -19,11 +19,21 @@ public:
     std::function<void()> onChopButtonPressed;
     std::function<void()> onChopButtonReleased;
     std::function<void(float)> onCrossfaderValueChanged;
+    std::function<void()> onLayersChanged;
 
     double getChopDurationInMs(double currentTempo) const;
     float getCrossfaderValue() const { return static_cast<float>(crossfaderSlider.getValue()); }
+
+    // Extra chop voices layered over the crossfader pair
+    static constexpr int numLayers = 2;
+    double getLayerOffsetInBeats(int layer) const;    // 0 when the layer is off
+    float getLayerLevel() const { return static_cast<float>(layerLevelSlider.getValue()); }
     void setCrossfaderValue(float value) { crossfaderSlider.setValue(value, juce::sendNotification); }
 
+    // The chop controls, saved with a session like an effect's parameters
+    std::vector<std::pair<juce::String, float>> getParameterValues() const override;
+    void setParameterValue(const juce::String& id, float value) override;
+
     ~ChopComponent() override;
     
     // ApplicationCommandTarget implementation
@@ -47,6 +57,9 @@ private:
     juce::Label durationLabel;
     juce::Slider crossfaderSlider;
     juce::Label crossfaderLabel;
+    juce::Label layersLabel;
+    juce::ComboBox layerOffsetComboBoxes[numLayers];
+    juce::Slider layerLevelSlider;
 
     // Change from std::unique_ptr to a raw pointer
     juce::ApplicationCommandManager* commandManager = nullptr;
@@ -0,0 +1,228 @@
+#include "ChopVoicesPlugin.h"
+#include "HotCuePlugin.h"
+#include "TaskScheduler.h"
+
+namespace tracktion { inline namespace engine
+{
+
+//==============================================================================
+const char* ChopVoicesPlugin::xmlTypeName ("chopVoices");
+
+ChopVoicesPlugin::ChopVoicesPlugin (PluginCreationInfo info)  : Plugin (info)
+{
+    // The classic chop: the live signal, and a copy one beat behind to cut to
+    voices[0].gain = 1.0f;
+    voices[1].offsetBeats = 1.0;
+}
+
+ChopVoicesPlugin::~ChopVoicesPlugin()
+{
+    notifyListenersOfDeletion();
+}
+
+juce::ValueTree ChopVoicesPlugin::create()
+{
+    return createValueTree (IDs::PLUGIN,
+                            IDs::type, xmlTypeName);
+}
+
+void ChopVoicesPlugin::initialise (const PluginInitialisationInfo& info)
+{
+    sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+    maxChunkSize = info.blockSizeSamples > 0 ? info.blockSizeSamples : 1024;
+    maxDelaySamples = (int) std::ceil (maxOffsetBeats * 60.0 / minTempoBpm * sampleRate);
+
+    // The graph gets rebuilt whenever clips change; only reallocate when the
+    // size actually changes so the voices don't drop out
+    const int historySize = maxDelaySamples + maxChunkSize;
+
+    if (history.getNumSamples() != historySize)
+    {
+        history.setSize (numChannels, historySize);
+        flushHistory();
+    }
+
+    // Swapped, never cleared, since the old graph may still be rendering
+    auto* found = findHotCues();
+    hotCues.store (found, std::memory_order_release);
+    hotCuesRef = found;
+
+    syncToTempoSequence();
+}
+
+void ChopVoicesPlugin::deinitialise()
+{
+}
+
+HotCuePlugin* ChopVoicesPlugin::findHotCues() const
+{
+    if (auto* master = edit.getMasterTrack())
+        for (auto* p : master->pluginList)
+            if (auto* h = dynamic_cast<HotCuePlugin*> (p))
+                return h;
+
+    return nullptr;
+}
+
+void ChopVoicesPlugin::syncToTempoSequence()
+{
+    const double bpm = edit.tempoSequence.getTempoAt (tracktion::TimePosition()).getBpm();
+
+    if (bpm > 0.0)
+        beatsPerSecond = bpm / 60.0;
+}
+
+//==============================================================================
+void ChopVoicesPlugin::setVoiceOffset (int voice, double beats)
+{
+    if (juce::isPositiveAndBelow (voice, maxVoices))
+        voices[(size_t) voice].offsetBeats = juce::jlimit (0.0, maxOffsetBeats, beats);
+}
+
+double ChopVoicesPlugin::getVoiceOffset (int voice) const
+{
+    return juce::isPositiveAndBelow (voice, maxVoices) ? voices[(size_t) voice].offsetBeats.load() : 0.0;
+}
+
+void ChopVoicesPlugin::setVoiceGain (int voice, float gain)
+{
+    if (juce::isPositiveAndBelow (voice, maxVoices))
+        voices[(size_t) voice].gain = juce::jmax (0.0f, gain);
+}
+
+float ChopVoicesPlugin::getVoiceGain (int voice) const
+{
+    return juce::isPositiveAndBelow (voice, maxVoices) ? voices[(size_t) voice].gain.load() : 0.0f;
+}
+
+void ChopVoicesPlugin::flushHistory() noexcept
+{
+    history.clear();
+    writePosition = 0;
+
+    for (auto& voice : voices)
+        voice.lastDelay = -1;
+}
+
+//==============================================================================
+void ChopVoicesPlugin::mixVoice (juce::AudioBuffer<float>& dest, int destStart, int numSamples,
+                                 int delaySamples, float startGain, float endGain) const
+{
+    const int historySize = history.getNumSamples();
+    const int readStart = (writePosition - numSamples - delaySamples + 2 * historySize) % historySize;
+    const int size1 = juce::jmin (numSamples, historySize - readStart);
+    const int size2 = numSamples - size1;
+
+    // Split the ramp where the read wraps round the history
+    const float midGain = startGain + (endGain - startGain) * (float) size1 / (float) numSamples;
+
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+    {
+        auto* out = dest.getWritePointer (ch, destStart);
+        const auto* src = history.getReadPointer (juce::jmin (ch, numChannels - 1));
+
+        if (startGain == endGain)
+        {
+            juce::FloatVectorOperations::addWithMultiply (out, src + readStart, startGain, size1);
+
+            if (size2 > 0)
+                juce::FloatVectorOperations::addWithMultiply (out + size1, src, startGain, size2);
+        }
+        else
+        {
+            dest.addFromWithRamp (ch, destStart, src + readStart, size1, startGain, midGain);
+
+            if (size2 > 0)
+                dest.addFromWithRamp (ch, destStart + size1, src, size2, midGain, endGain);
+        }
+    }
+}
+
+void ChopVoicesPlugin::applyToBuffer (const PluginRenderContext& rc)
+{
+    // Each deck is rendered on one of Tracktion's audio workers
+    TaskScheduler::pinToAudioCores();
+
+    if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0 || history.getNumSamples() == 0)
+        return;
+
+    auto& dest = *rc.destBuffer;
+    const int numDestChannels = dest.getNumChannels();
+
+    if (numDestChannels == 0)
+        return;
+
+    // After a seek, a loop wrap or a restart, the history holds audio from
+    // somewhere else in the track, which the delayed voices would play back over
+    // the new position; start them again from silence instead. Hot cue jumps and
+    // loop roll repeats are what was just played, so those keep the history.
+    const auto blockStart = rc.editTime.getStart();
+    const bool moved = std::abs ((blockStart - nextEditTime).inSeconds()) * sampleRate > 1.0;
+    const auto* cues = hotCues.load (std::memory_order_acquire);
+
+    if (rc.isPlaying
+         && (! wasPlaying || (moved && (cues == nullptr || ! cues->isOwnJumpTo (blockStart, sampleRate)))))
+        flushHistory();
+
+    wasPlaying = rc.isPlaying;
+    nextEditTime = rc.editTime.getEnd();
+
+    const int historySize = history.getNumSamples();
+    const double delayPerBeat = sampleRate / beatsPerSecond.load (std::memory_order_relaxed);
+    const float level = outputLevel.load (std::memory_order_relaxed);
+
+    for (int done = 0; done < rc.bufferNumSamples;)
+    {
+        const int start = rc.bufferStartSample + done;
+        const int numSamples = juce::jmin (maxChunkSize, rc.bufferNumSamples - done);
+
+        // Keep the stretched signal, then rebuild the output from the voices
+        const int size1 = juce::jmin (numSamples, historySize - writePosition);
+        const int size2 = numSamples - size1;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* in = dest.getReadPointer (juce::jmin (ch, numDestChannels - 1), start);
+
+            juce::FloatVectorOperations::copy (history.getWritePointer (ch, writePosition), in, size1);
+
+            if (size2 > 0)
+                juce::FloatVectorOperations::copy (history.getWritePointer (ch), in + size1, size2);
+        }
+
+        writePosition = (writePosition + numSamples) % historySize;
+        dest.clear (start, numSamples);
+
+        for (auto& voice : voices)
+        {
+            const float gain = voice.gain.load (std::memory_order_relaxed) * level;
+
+            if (gain == 0.0f && voice.lastGain == 0.0f)
+            {
+                voice.lastDelay = -1;
+                continue;
+            }
+
+            const int delay = juce::jlimit (0, maxDelaySamples,
+                                            juce::roundToInt (voice.offsetBeats.load (std::memory_order_relaxed) * delayPerBeat));
+
+            if (voice.lastDelay >= 0 && voice.lastDelay != delay)
+            {
+                // The offset or tempo moved: crossfade to the new read position
+                mixVoice (dest, start, numSamples, voice.lastDelay, voice.lastGain, 0.0f);
+                mixVoice (dest, start, numSamples, delay, 0.0f, gain);
+            }
+            else
+            {
+                mixVoice (dest, start, numSamples, delay, voice.lastGain, gain);
+            }
+
+            voice.lastGain = gain;
+            voice.lastDelay = delay;
+        }
+
+        done += numSamples;
+    }
+}
+
+}} // namespace tracktion { inline namespace engine
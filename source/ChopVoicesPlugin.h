@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include <array>
+
+namespace tracktion { inline namespace engine
+{
+
+class HotCuePlugin;
+
+/** The chop engine: several read heads over one stretched track.
+
+    The track's clip is decoded and time-stretched once. This plugin keeps the
+    last few beats of that stretched audio in a history buffer, and each voice
+    reads it back a set number of beats behind the live signal. Adding a voice
+    costs one read and a multiply-add into the output rather than another
+    stretched track.
+
+    Voice 0 is normally the live signal and voice 1 sits a beat behind it; the
+    crossfader chops between those two. Voices 2 and 3 are layers that can be
+    brought in at other offsets.
+
+    When playback is seeked or restarted, the history is cleared, so the
+    delayed voices come back in from silence rather than replaying where the
+    track used to be. Hot cue jumps and loop roll repeats are part of the
+    performance, so the voices keep playing through those.
+*/
+class ChopVoicesPlugin   : public Plugin
+{
+public:
+    ChopVoicesPlugin (PluginCreationInfo);
+    ~ChopVoicesPlugin() override;
+
+    static const char* getPluginName()                  { return NEEDS_TRANS("Chop Voices"); }
+    static juce::ValueTree create();
+
+    //==============================================================================
+    static const char* xmlTypeName;
+
+    juce::String getName() const override               { return TRANS("Chop Voices"); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    void initialise (const PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const PluginRenderContext&) override;
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return numInputChannels; }
+    bool producesAudioWhenNoAudioInput() override       { return true; }     // the delayed voices run on after the input stops
+    juce::String getSelectableDescription() override    { return TRANS("Chop Voices Plugin"); }
+
+    //==============================================================================
+    static constexpr int maxVoices = 4;
+    static constexpr double maxOffsetBeats = 4.0;
+
+    /** How far behind the live signal a voice reads, in beats. */
+    void setVoiceOffset (int voice, double beats);
+    double getVoiceOffset (int voice) const;
+
+    /** Linear gain of a voice; a voice at zero gain costs nothing. */
+    void setVoiceGain (int voice, float gain);
+    float getVoiceGain (int voice) const;
+
+    /** Linear gain over all the voices, i.e. the deck fader. Ramped along
+        with the voice gains, so it's safe to move every block.
+    */
+    void setOutputLevel (float gain)                    { outputLevel = juce::jmax (0.0f, gain); }
+    float getOutputLevel() const noexcept               { return outputLevel.load (std::memory_order_relaxed); }
+
+    /** Picks up the current tempo from the edit's tempo sequence. Call on the
+        message thread whenever the tempo changes.
+    */
+    void syncToTempoSequence();
+
+private:
+    struct Voice
+    {
+        std::atomic<double> offsetBeats { 0.0 };
+        std::atomic<float> gain { 0.0f };
+
+        // Audio thread only: what the last block used, so changes can be ramped
+        float lastGain = 0.0f;
+        int lastDelay = -1;
+    };
+
+    static constexpr int numChannels = 2;
+    static constexpr double minTempoBpm = 40.0;
+
+    void mixVoice (juce::AudioBuffer<float>& dest, int destStart, int numSamples,
+                   int delaySamples, float startGain, float endGain) const;
+    void flushHistory() noexcept;
+    HotCuePlugin* findHotCues() const;
+
+    std::array<Voice, maxVoices> voices;
+    std::atomic<double> beatsPerSecond { 2.0 };
+    std::atomic<float> outputLevel { 1.0f };
+
+    // The master's hot cues, so their jumps can be told apart from seeks: held
+    // here on the message thread, read through the atomic on the audio thread
+    Plugin::Ptr hotCuesRef;
+    std::atomic<HotCuePlugin*> hotCues { nullptr };
+
+    // Audio thread only
+    double sampleRate = 44100.0;
+    juce::AudioBuffer<float> history;
+    int writePosition = 0;
+    int maxDelaySamples = 0;
+    int maxChunkSize = 1024;
+    TimePosition nextEditTime;
+    bool wasPlaying = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChopVoicesPlugin)
+};
+
+}} // namespace tracktion { inline namespace engine
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/** A fixed-capacity queue of small commands from any number of threads to one
+    consumer thread.
+
+    Nothing blocks or allocates. Each slot carries a sequence number: a
+    producer claims a slot with a single compare-and-swap on the write index
+    and publishes it by bumping the sequence, and the consumer only takes a
+    slot once its sequence says it has been fully written. When the queue is
+    full, push() fails straight away instead of waiting for the consumer.
+
+    Type should be trivially copyable.
+*/
+template <typename Type, int capacity>
+class CommandQueue
+{
+public:
+    static_assert (capacity > 1 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+
+    CommandQueue()
+    {
+        for (size_t i = 0; i < slots.size(); ++i)
+            slots[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    /** Adds a command. Safe from any thread; returns false if the queue is full. */
+    bool push (const Type& item) noexcept
+    {
+        auto position = writePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = slots[position & mask];
+            const auto sequence = slot.sequence.load (std::memory_order_acquire);
+            const auto diff = (std::ptrdiff_t) sequence - (std::ptrdiff_t) position;
+
+            if (diff == 0)
+            {
+                // Free slot: claim it, then fill it in
+                if (writePosition.compare_exchange_weak (position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.item = item;
+                    slot.sequence.store (position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // The consumer hasn't got round to this slot yet
+                return false;
+            }
+            else
+            {
+                // Another producer got here first
+                position = writePosition.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Takes the oldest command. Consumer thread only. */
+    bool pop (Type& item) noexcept
+    {
+        auto& slot = slots[readPosition & mask];
+
+        if (slot.sequence.load (std::memory_order_acquire) != readPosition + 1)
+            return false;
+
+        item = slot.item;
+        slot.sequence.store (readPosition + (size_t) capacity, std::memory_order_release);
+        ++readPosition;
+        return true;
+    }
+
+private:
+    static constexpr size_t mask = (size_t) capacity - 1;
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Type item {};
+    };
+
+    std::array<Slot, (size_t) capacity> slots;
+
+    // Kept apart so producers and the consumer don't fight over a cache line
+    alignas (64) std::atomic<size_t> writePosition { 0 };
+    alignas (64) size_t readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (CommandQueue)
+};
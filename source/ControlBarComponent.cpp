@@ -124,11 +124,8 @@ void ControlBarComponent::resized()
     controlBarBox.performLayout(bounds);
 }
 
-void ControlBarComponent::updatePositionLabel()
+void ControlBarComponent::updatePositionLabel(tracktion::TimePosition position)
 {
-    auto& transport = edit.getTransport();
-    auto position = transport.getPosition();
-
     // Get time position
     auto timeString = PlayHeadHelpers::timeToTimecodeString(position.inSeconds());
 
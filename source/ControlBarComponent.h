@@ -19,7 +19,7 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
     
-    void updatePositionLabel();
+    void updatePositionLabel(tracktion::TimePosition position);
     
     // Callback functions
     std::function<void()> onPlayButtonClicked;
@@ -39,6 +39,9 @@ ControllerMappingComponent::ControllerMappingComponent()
         {SDL_GAMEPAD_BUTTON_DPAD_DOWN, "Flanger", false},
         {SDL_GAMEPAD_BUTTON_LEFT_SHOULDER, "Vinyl Brake", false},
         {SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER, "Screw", false},
+        {SDL_GAMEPAD_BUTTON_DPAD_LEFT, "Loop Roll 1 Beat", false},
+        {SDL_GAMEPAD_BUTTON_LEFT_STICK, "Loop Roll 1/2 Beat", false},
+        {SDL_GAMEPAD_BUTTON_BACK, "Hold: Face/D-Pad = Hot Cues 1-8", false},
         {SDL_GAMEPAD_AXIS_LEFTX, "Flanger Rate", true},
         {SDL_GAMEPAD_AXIS_LEFTY, "Flanger Depth", true},
         {SDL_GAMEPAD_AXIS_RIGHTX, "Phaser Rate", true},
@@ -70,6 +73,15 @@ ControllerMappingComponent::~ControllerMappingComponent()
         mappingDialog->exitModalState(0);
 }
 
+void ControllerMappingComponent::setMappings(std::vector<ControllerMapping> newMappings)
+{
+    mappings = std::move(newMappings);
+    repaint();
+
+    if (mappingDialog != nullptr)
+        mappingDialog->repaint();
+}
+
 void ControllerMappingComponent::paint(juce::Graphics& g)
 {
     // Check controller connection before drawing
@@ -286,6 +298,8 @@ void ControllerMappingComponent::drawDpad(juce::Graphics& g, juce::Rectangle<flo
                SDL_GAMEPAD_BUTTON_DPAD_RIGHT, "Delay");
     drawButton(g, {centerX, centerY + buttonSize}, buttonSize/2, "v", 
                SDL_GAMEPAD_BUTTON_DPAD_DOWN, "Flanger");
+    drawButton(g, {centerX - buttonSize, centerY}, buttonSize/2, "<", 
+               SDL_GAMEPAD_BUTTON_DPAD_LEFT, "Roll");
 }
 
 void ControllerMappingComponent::drawTriggers(juce::Graphics& g, juce::Rectangle<float> bounds)
@@ -477,6 +491,9 @@ void ControllerMappingComponent::drawMappingsList(juce::Graphics& g, juce::Recta
                 case SDL_GAMEPAD_BUTTON_DPAD_UP: controlName = "D-Pad Up"; break;
                 case SDL_GAMEPAD_BUTTON_DPAD_RIGHT: controlName = "D-Pad Right"; break;
                 case SDL_GAMEPAD_BUTTON_DPAD_DOWN: controlName = "D-Pad Down"; break;
+                case SDL_GAMEPAD_BUTTON_DPAD_LEFT: controlName = "D-Pad Left"; break;
+                case SDL_GAMEPAD_BUTTON_LEFT_STICK: controlName = "L3"; break;
+                case SDL_GAMEPAD_BUTTON_BACK: controlName = "Select"; break;
                 case SDL_GAMEPAD_BUTTON_LEFT_SHOULDER: controlName = "L1"; break;
                 case SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER: controlName = "R1"; break;
                 default: controlName = "Unknown Button"; break;
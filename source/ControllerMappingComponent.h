@@ -30,6 +30,9 @@ public:
 
     void drawMappingsList(juce::Graphics& g, juce::Rectangle<float> bounds);
 
+    const std::vector<ControllerMapping>& getMappings() const { return mappings; }
+    void setMappings(std::vector<ControllerMapping> newMappings);
+
 private:
     friend class ComponentListener;
     
@@ -0,0 +1,220 @@
+#include "Deck.h"
+#include "Utilities.h"
+#include "RealtimeMode.h"
+#include "TaskScheduler.h"
+
+#include <cmath>
+#include <limits>
+
+//==============================================================================
+Deck::Deck (te::Edit& e, int index)
+    : edit (e), trackIndex (index)
+{
+    if (auto track = EngineHelpers::getOrInsertAudioTrackAt (edit, trackIndex))
+    {
+        EngineHelpers::removeAllClips (*track);
+
+        chopVoicesPlugin = track->pluginList.insertPlugin (te::ChopVoicesPlugin::create(), 0);
+        track->pluginList.insertPlugin (te::TapPlugin::create (TapNames::deck (trackIndex)), 1);
+
+        for (int i = 0; i < numEffectsBuses; ++i)
+        {
+            auto plugin = edit.getPluginCache().createNewPlugin (te::AuxSendPlugin::xmlTypeName, {});
+
+            if (auto sendPlugin = dynamic_cast<te::AuxSendPlugin*> (plugin.get()))
+            {
+                sendPlugin->busNumber = firstEffectsBus + i;
+                auxSendPlugins[(size_t) i] = track->pluginList.insertPlugin (plugin, 2 + i, nullptr);
+            }
+        }
+    }
+
+    updateSends();
+}
+
+Deck::~Deck()
+{
+}
+
+te::AudioTrack* Deck::getTrack() const
+{
+    return te::getAudioTracks (edit)[trackIndex];
+}
+
+te::WaveAudioClip* Deck::getClip() const
+{
+    if (auto track = getTrack())
+        return dynamic_cast<te::WaveAudioClip*> (track->getClips()[0]);
+
+    return nullptr;
+}
+
+te::ChopVoicesPlugin* Deck::getChopVoices() const
+{
+    return dynamic_cast<te::ChopVoicesPlugin*> (chopVoicesPlugin.get());
+}
+
+bool Deck::isLoaded() const
+{
+    return getClip() != nullptr;
+}
+
+//==============================================================================
+te::WaveAudioClip::Ptr Deck::load (const juce::File& newFile, double fileBpm,
+                                   te::BeatPosition startBeat, double sourceOffsetBeats, float gainDb)
+{
+    auto track = getTrack();
+
+    if (track == nullptr || fileBpm <= 0.0)
+        return {};
+
+    te::AudioFile audioFile (edit.engine, newFile);
+
+    if (! audioFile.isValid())
+        return {};
+
+    EngineHelpers::removeAllClips (*track);
+
+    // One beat of the file plays as one beat of the edit, whatever the two tempos are
+    auto& ts = edit.tempoSequence;
+    const double editBeatsPerSecond = ts.getTempoAt (te::TimePosition()).getBpm() / 60.0;
+    const double fileBeats = audioFile.getLength() * fileBpm / 60.0;
+    const double offsetBeats = juce::jlimit (0.0, fileBeats, sourceOffsetBeats);
+
+    const auto start = ts.toTime (startBeat);
+    const auto length = te::TimeDuration::fromSeconds ((fileBeats - offsetBeats) / editBeatsPerSecond);
+    const auto offset = te::TimeDuration::fromSeconds (offsetBeats / editBeatsPerSecond);
+
+    te::WaveAudioClip::Ptr clip = track->insertWaveClip (newFile.getFileNameWithoutExtension(), newFile,
+                                                         { { start, length }, offset }, true);
+
+    if (clip == nullptr)
+        return {};
+
+    clip->setSyncType (te::Clip::syncBarsBeats);
+    clip->setAutoPitch (false);
+    clip->setTimeStretchMode (te::TimeStretcher::elastiquePro);
+    clip->setUsesProxy (false);
+    clip->setAutoTempo (true);
+
+    // Loudness was measured when the track was added, so normalising is just clip gain
+    clip->setGainDB (gainDb);
+    clip->getLoopInfo().setBpm (fileBpm, clip->getAudioFile().getInfo());
+
+    file = newFile;
+    bpm = fileBpm;
+    barPhase = startBeat;
+
+    // Pull the file into the page cache before it plays, so the reader
+    // doesn't wait on the disk mid-set
+    TaskScheduler::getInstance()->schedule ([newFile] { RealtimeMode::prefaultFile (newFile); },
+                                            TaskPriority::interactive);
+
+    DBG ("Deck " + juce::String (trackIndex) + ": loaded " + newFile.getFileName()
+         + " at beat " + juce::String (startBeat.inBeats(), 2)
+         + ", " + juce::String (offsetBeats, 2) + " beats in");
+
+    return clip;
+}
+
+void Deck::unload()
+{
+    if (auto track = getTrack())
+        EngineHelpers::removeAllClips (*track);
+
+    file = {};
+}
+
+te::WaveAudioClip::Ptr Deck::loadAnalysed (const juce::File& newFile, double fileBpm, float gainDb,
+                                           std::optional<CuePoints>& cues,
+                                           const std::vector<double>& beats,
+                                           te::BeatPosition startBeat, bool fromDownbeat)
+{
+    // Drifting tracks get warped so every tracked beat lands on an even grid
+    // at the detected tempo; the cues move with the beats around them
+    const auto fit = BeatTracker::fitGrid (beats, fileBpm);
+
+    if (cues && ! fit.grid.empty())
+    {
+        cues->audioStart = BeatTracker::toGridTime (fit.beats, fit.grid, cues->audioStart);
+        cues->audioEnd = BeatTracker::toGridTime (fit.beats, fit.grid, cues->audioEnd);
+
+        if (cues->firstDownbeat >= 0.0)
+            cues->firstDownbeat = BeatTracker::toGridTime (fit.beats, fit.grid, cues->firstDownbeat);
+    }
+
+    const double cueStartBeats = (cues ? cues->getStart() : 0.0) * fileBpm / 60.0;
+    auto clip = load (newFile, fileBpm, startBeat, fromDownbeat ? cueStartBeats : 0.0, gainDb);
+
+    if (clip == nullptr)
+        return {};
+
+    warpToGrid (fit);
+
+    // Bars are counted from the cue start, so other decks can line up with them
+    setBarPhase (fromDownbeat ? startBeat : startBeat + te::BeatDuration::fromBeats (cueStartBeats));
+
+    return clip;
+}
+
+void Deck::warpToGrid (const BeatTracker::GridFit& fit)
+{
+    const auto& beats = fit.beats;
+    const auto& grid = fit.grid;
+    auto clip = getClip();
+
+    if (clip == nullptr || beats.size() < 2 || beats.size() != grid.size())
+        return;
+
+    auto& warp = clip->getWarpTimeManager();
+    warp.removeAllMarkers();
+
+    // Markers are interpolated between, so beats keeping the same distance
+    // from the grid as the last marker don't need one of their own
+    constexpr double tolerance = 0.002;
+    double lastDrift = std::numeric_limits<double>::max();
+    int numMarkers = 0;
+
+    for (size_t i = 0; i < beats.size(); ++i)
+    {
+        const double drift = beats[i] - grid[i];
+
+        if (std::abs (drift - lastDrift) < tolerance && i + 1 < beats.size())
+            continue;
+
+        warp.insertMarker (te::WarpMarker (te::TimePosition::fromSeconds (beats[i]),
+                                           te::TimePosition::fromSeconds (grid[i])));
+        lastDrift = drift;
+        ++numMarkers;
+    }
+
+    clip->setWarpTime (true);
+
+    DBG ("Deck " + juce::String (trackIndex) + ": warped " + juce::String ((int) beats.size())
+         + " beats to the grid with " + juce::String (numMarkers) + " markers");
+}
+
+//==============================================================================
+void Deck::setSend (float amount)
+{
+    send = juce::jlimit (0.0f, 1.0f, amount);
+    updateSends();
+}
+
+void Deck::updateSends()
+{
+    // Every effect hears the same send. The returns only add what their effect
+    // changed, so a full send through one effect sounds the same as that
+    // effect inline, and the dry path never needs turning down
+    const float gainDb = juce::Decibels::gainToDecibels (send, -100.0f);
+
+    for (auto& plugin : auxSendPlugins)
+        if (auto sendPlugin = dynamic_cast<te::AuxSendPlugin*> (plugin.get()))
+            sendPlugin->setGainDb (gainDb);
+}
+
+void Deck::syncToTempoSequence()
+{
+    if (auto voices = getChopVoices())
+        voices->syncToTempoSequence();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "BeatTracker.h"
+#include "ChopVoicesPlugin.h"
+#include "TapPlugin.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/** One deck: a track holding a stretched clip, its own chop voices, a fader
+    and a send to each effect.
+
+    Every deck follows the edit's tempo sequence, which is the master clock;
+    each clip is stretched from its own BPM to that tempo. Each deck is its own
+    track and only meets the others at the effect returns and the master, so
+    Tracktion can process the decks on separate audio worker threads.
+
+    Plugin order on the track is chop voices, the deck's tap, then one aux send
+    per effect bus, all at the same level. The returns only carry what their
+    effect changed, so the deck itself always carries on dry to the master. The
+    deck fader is the chop voices' output level, so it moves on the audio
+    thread without touching the track.
+*/
+class Deck
+{
+public:
+    Deck (tracktion::engine::Edit&, int trackIndex);
+    ~Deck();
+
+    /** The effects each have their own bus, numbered from firstEffectsBus. */
+    static constexpr int firstEffectsBus = 0;
+    static constexpr int numEffectsBuses = 4;
+    static constexpr double beatsPerBar = 4.0;
+
+    /** Puts a file on the deck.
+        The clip starts at startBeat on the edit timeline and plays from
+        sourceOffsetBeats into the file, counted in beats at the file's own
+        tempo. Whatever was on the deck before is removed.
+    */
+    tracktion::engine::WaveAudioClip::Ptr load (const juce::File&, double fileBpm,
+                                                tracktion::BeatPosition startBeat,
+                                                double sourceOffsetBeats, float gainDb);
+    void unload();
+
+    /** Puts an analysed track on the deck, as every load in the app does.
+        The clip is warped so its tracked beats land on an even grid at
+        fileBpm, and the cues are moved to grid time to match. It starts at
+        startBeat on the edit timeline, playing from the top of the file or,
+        with fromDownbeat, from the cue start; either way the bar phase is set
+        to where the cue start lands.
+    */
+    tracktion::engine::WaveAudioClip::Ptr loadAnalysed (const juce::File&, double fileBpm, float gainDb,
+                                                        std::optional<CuePoints>& cues,
+                                                        const std::vector<double>& beats,
+                                                        tracktion::BeatPosition startBeat, bool fromDownbeat);
+
+    /** Warps the loaded clip so each tracked beat plays at its place on the
+        grid, as worked out by BeatTracker::fitGrid() at the deck's tempo, and
+        a track that drifts stays locked to the edit's beats.
+    */
+    void warpToGrid (const BeatTracker::GridFit&);
+
+    bool isLoaded() const;
+    juce::File getFile() const                              { return file; }
+    double getBpm() const noexcept                          { return bpm; }
+
+    /** Edit beat where one of this deck's bars starts, for lining another deck up with it. */
+    tracktion::BeatPosition getBarPhase() const noexcept    { return barPhase; }
+    void setBarPhase (tracktion::BeatPosition b) noexcept   { barPhase = b; }
+
+    tracktion::engine::AudioTrack* getTrack() const;
+    tracktion::engine::WaveAudioClip* getClip() const;
+    tracktion::engine::ChopVoicesPlugin* getChopVoices() const;
+
+    /** How much of the deck is sent to the effects, 0 to 1. */
+    void setSend (float amount);
+    float getSend() const noexcept                          { return send; }
+
+    void syncToTempoSequence();
+
+private:
+    void updateSends();
+
+    tracktion::engine::Edit& edit;
+    const int trackIndex;
+
+    tracktion::engine::Plugin::Ptr chopVoicesPlugin;
+    std::array<tracktion::engine::Plugin::Ptr, numEffectsBuses> auxSendPlugins;
+
+    juce::File file;
+    double bpm = 120.0;
+    tracktion::BeatPosition barPhase;
+
+    float send = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Deck)
+};
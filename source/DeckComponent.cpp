@@ -0,0 +1,145 @@
+#include "DeckComponent.h"
+
+DeckComponent::DeckComponent(tracktion::engine::Edit& edit)
+    : BaseEffectComponent(edit)
+{
+    titleLabel.setText("Decks", juce::dontSendNotification);
+
+    for (int deck = 0; deck < numDecks; ++deck)
+    {
+        auto& button = loadButtons[deck];
+        button.setButtonText(deck == 0 ? "Load A" : "Load B");
+        button.setClickingTogglesState(true);
+        button.setRadioGroupId(1);
+        button.onClick = [this, deck] {
+            if (loadButtons[deck].getToggleState())
+                setLoadTarget(deck);
+        };
+        addAndMakeVisible(button);
+
+        trackLabels[deck].setJustificationType(juce::Justification::centredLeft);
+        trackLabels[deck].setMinimumHorizontalScale(0.7f);
+        addAndMakeVisible(trackLabels[deck]);
+        setDeckInfo(deck, {}, false);
+
+        // Everything goes through the effects by default, as if they were inline
+        auto& slider = sendSliders[deck];
+        slider.setSliderStyle(juce::Slider::LinearHorizontal);
+        slider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+        slider.setRange(0.0, 1.0, 0.01);
+        slider.setValue(1.0, juce::dontSendNotification);
+        slider.onValueChange = [this, deck] {
+            if (onSendChanged)
+                onSendChanged(deck, static_cast<float>(sendSliders[deck].getValue()));
+        };
+        addAndMakeVisible(slider);
+    }
+
+    loadButtons[0].setToggleState(true, juce::dontSendNotification);
+
+    deckFaderLabel.setText("A / B", juce::dontSendNotification);
+    deckFaderLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(deckFaderLabel);
+
+    deckFaderSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+    deckFaderSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
+    deckFaderSlider.setRange(0.0, 1.0, 0.01);
+    deckFaderSlider.setValue(0.5, juce::dontSendNotification);
+    deckFaderSlider.setDoubleClickReturnValue(true, 0.5);
+    deckFaderSlider.onValueChange = [this] {
+        if (onDeckFaderChanged)
+            onDeckFaderChanged();
+    };
+    addAndMakeVisible(deckFaderSlider);
+
+    sendLabel.setText("FX Send", juce::dontSendNotification);
+    sendLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(sendLabel);
+}
+
+void DeckComponent::resized()
+{
+    auto bounds = getEffectiveArea();
+    BaseEffectComponent::resized();
+
+    juce::Grid grid;
+    grid.rowGap = juce::Grid::Px(4);
+    grid.columnGap = juce::Grid::Px(4);
+
+    using Track = juce::Grid::TrackInfo;
+    using Fr = juce::Grid::Fr;
+
+    grid.templateRows = { Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1)) };
+    grid.templateColumns = { Track(Fr(1)), Track(Fr(1)) };
+
+    const auto fullWidth = juce::GridItem::Span(2);
+
+    grid.items = {
+        juce::GridItem(loadButtons[0]).withHeight(30),
+        juce::GridItem(loadButtons[1]).withHeight(30),
+        juce::GridItem(trackLabels[0]),
+        juce::GridItem(trackLabels[1]),
+        juce::GridItem(deckFaderLabel).withColumn({ 1, fullWidth }),
+        juce::GridItem(deckFaderSlider).withColumn({ 1, fullWidth }),
+        juce::GridItem(sendLabel).withColumn({ 1, fullWidth }),
+        juce::GridItem(sendSliders[0]),
+        juce::GridItem(sendSliders[1])
+    };
+
+    grid.performLayout(bounds.toNearestInt());
+}
+
+float DeckComponent::getDeckGain(int deck) const
+{
+    // Equal power across the fader, scaled so the middle leaves both decks untouched
+    const float position = static_cast<float>(deckFaderSlider.getValue());
+    const float angle = position * juce::MathConstants<float>::halfPi;
+    const float gain = juce::MathConstants<float>::sqrt2 * (deck == 0 ? std::cos(angle) : std::sin(angle));
+
+    return juce::jlimit(0.0f, 1.0f, gain);
+}
+
+void DeckComponent::setDeckInfo(int deck, const juce::String& trackName, bool isMaster)
+{
+    if (!juce::isPositiveAndBelow(deck, numDecks))
+        return;
+
+    juce::String text(trackName.isEmpty() ? juce::String("Empty") : trackName);
+
+    if (isMaster)
+        text << " (master)";
+
+    trackLabels[deck].setText(text, juce::dontSendNotification);
+}
+
+void DeckComponent::setLoadTarget(int deck)
+{
+    if (deck == loadTarget || !juce::isPositiveAndBelow(deck, numDecks))
+        return;
+
+    loadButtons[deck].setToggleState(true, juce::dontSendNotification);
+
+    loadTarget = deck;
+
+    if (onLoadTargetChanged)
+        onLoadTargetChanged(deck);
+}
+
+void DeckComponent::setDeckFaderPosition(float position)
+{
+    deckFaderSlider.setValue(position, juce::sendNotificationSync);
+}
+
+float DeckComponent::getSend(int deck) const
+{
+    if (!juce::isPositiveAndBelow(deck, numDecks))
+        return 0.0f;
+
+    return static_cast<float>(sendSliders[deck].getValue());
+}
+
+void DeckComponent::setSend(int deck, float amount)
+{
+    if (juce::isPositiveAndBelow(deck, numDecks))
+        sendSliders[deck].setValue(amount, juce::sendNotificationSync);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "BaseEffectComponent.h"
+
+class DeckComponent : public BaseEffectComponent
+{
+public:
+    explicit DeckComponent(tracktion::engine::Edit&);
+    void resized() override;
+
+    static constexpr int numDecks = 2;
+
+    std::function<void(int)> onLoadTargetChanged;
+    std::function<void()> onDeckFaderChanged;
+    std::function<void(int, float)> onSendChanged;
+
+    /** The deck that the next file from the library goes onto; it also gets the chop controls. */
+    int getLoadTarget() const { return loadTarget; }
+
+    /** Equal-power gains for each deck from the deck crossfader; both are at unity in the middle. */
+    float getDeckGain(int deck) const;
+
+    void setDeckInfo(int deck, const juce::String& trackName, bool isMaster);
+
+    /** Selects the deck the library loads to, as if its button were clicked. */
+    void setLoadTarget(int deck);
+
+    float getDeckFaderPosition() const { return static_cast<float>(deckFaderSlider.getValue()); }
+    void setDeckFaderPosition(float position);
+
+    float getSend(int deck) const;
+    void setSend(int deck, float amount);
+
+private:
+    juce::TextButton loadButtons[numDecks];
+    juce::Label trackLabels[numDecks];
+    juce::Label deckFaderLabel;
+    juce::Slider deckFaderSlider;
+    juce::Label sendLabel;
+    juce::Slider sendSliders[numDecks];
+
+    int loadTarget = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckComponent)
+};
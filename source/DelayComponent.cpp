@@ -122,6 +122,26 @@ void DelayComponent::setDelayTime(double milliseconds)
     }
 }
 
+std::vector<std::pair<juce::String, float>> DelayComponent::getParameterValues() const
+{
+    auto values = BaseEffectComponent::getParameterValues();
+    values.emplace_back(noteValueId, static_cast<float>(noteValueBox.getSelectedId()));
+    return values;
+}
+
+void DelayComponent::setParameterValue(const juce::String& id, float value)
+{
+    if (id == noteValueId)
+    {
+        noteValueBox.setSelectedId(juce::roundToInt(value), juce::dontSendNotification);
+        updateDelayTimeFromNote();
+    }
+    else
+    {
+        BaseEffectComponent::setParameterValue(id, value);
+    }
+}
+
 void DelayComponent::rampMixLevel(bool rampUp)
 {
     if (rampUp)
@@ -22,6 +22,10 @@ public:
     void setDelayTime(double milliseconds);
     void rampMixLevel(bool rampUp);
     void setTempo(double newTempo) { tempo = newTempo; updateDelayTimeFromNote(); }
+    
+    // The note value isn't a parameter, so it's saved alongside them
+    std::vector<std::pair<juce::String, float>> getParameterValues() const override;
+    void setParameterValue(const juce::String& id, float value) override;
 
 private:
     juce::Slider feedbackSlider;
@@ -35,6 +39,8 @@ private:
     RampedValue mixRamp;
     double storedMixValue = 0.0;
     double tempo = 120.0;
+    
+    static constexpr const char* noteValueId = "note value";
 
     void updateDelayTimeFromNote();
 
@@ -0,0 +1,79 @@
+#include "EditLayout.h"
+#include "ChopVoicesPlugin.h"
+#include "Deck.h"
+#include "EffectReturnPlugin.h"
+#include "HotCuePlugin.h"
+#include "MasterRecorderPlugin.h"
+#include "TapPlugin.h"
+#include "Utilities.h"
+#include "Plugins/FlangerPlugin.h"
+#include "Plugins/AutoDelayPlugin.h"
+#include "Plugins/AutoPhaserPlugin.h"
+
+void EditLayout::registerPlugins (te::Engine& engine)
+{
+    auto& plugins = engine.getPluginManager();
+    plugins.createBuiltInType<te::TapPlugin>();
+    plugins.createBuiltInType<te::EffectReturnPlugin>();
+    plugins.createBuiltInType<FlangerPlugin>();
+    plugins.createBuiltInType<AutoDelayPlugin>();
+    plugins.createBuiltInType<AutoPhaserPlugin>();
+    plugins.createBuiltInType<te::MasterRecorderPlugin>();
+    plugins.createBuiltInType<te::HotCuePlugin>();
+    plugins.createBuiltInType<te::ChopVoicesPlugin>();
+}
+
+void EditLayout::createEffectReturns (te::Edit& edit, int numDeckTracks, const std::vector<te::Plugin::Ptr>& effects)
+{
+    // One return per effect, each on its own track inside a submix folder, so
+    // Tracktion can run the effects side by side on its worker threads instead
+    // of one after another. Each return is its bus's aux return, the dry
+    // capture, the effect, then the mix-back stage that hands on only what the
+    // effect changed.
+    auto decksEnd = te::getAudioTracks (edit)[numDeckTracks - 1];
+    auto folder = edit.insertNewFolderTrack (te::TrackInsertPoint (nullptr, decksEnd), nullptr, true);
+
+    if (folder == nullptr)
+        return;
+
+    folder->setName ("FX Returns");
+
+    te::Track* previous = nullptr;
+
+    for (int i = 0; i < (int) effects.size(); ++i)
+    {
+        auto effect = effects[(size_t) i];
+
+        if (effect == nullptr)
+            continue;
+
+        auto returnTrack = edit.insertNewAudioTrack (te::TrackInsertPoint (folder.get(), previous), nullptr);
+
+        if (returnTrack == nullptr)
+            continue;
+
+        previous = returnTrack.get();
+        returnTrack->setName ("FX: " + effect->getName());
+
+        auto auxReturn = edit.getPluginCache().createNewPlugin (te::AuxReturnPlugin::xmlTypeName, {});
+
+        if (auto returnPlugin = dynamic_cast<te::AuxReturnPlugin*> (auxReturn.get()))
+        {
+            returnPlugin->busNumber = Deck::firstEffectsBus + i;
+            returnTrack->pluginList.insertPlugin (auxReturn, 0, nullptr);
+        }
+
+        // Every bus carries the same sends, so the first one shows what the effects are fed
+        int index = 1;
+
+        if (i == 0)
+            returnTrack->pluginList.insertPlugin (te::TapPlugin::create (TapNames::effectsIn), index++);
+
+        returnTrack->pluginList.insertPlugin (te::EffectReturnPlugin::create (te::EffectReturnPlugin::Stage::dryCapture), index++);
+        returnTrack->pluginList.insertPlugin (effect, index++, nullptr);
+        returnTrack->pluginList.insertPlugin (te::EffectReturnPlugin::create (te::EffectReturnPlugin::Stage::mixBack), index++);
+    }
+
+    // The folder sums the returns, so this is everything the effects add to the mix
+    folder->pluginList.insertPlugin (te::TapPlugin::create (TapNames::effectsOut), 0);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include <vector>
+
+//==============================================================================
+/** The parts of ChopShop's edit that don't depend on the UI, shared by the app
+    and the headless tests so both play through the same graph.
+*/
+namespace EditLayout
+{
+    /** Registers ChopShop's own plugin types. Call once, before any edit that
+        uses them is created or loaded.
+    */
+    void registerPlugins (tracktion::engine::Engine&);
+
+    /** One return per effect, each on its own track inside a submix folder
+        placed after the deck tracks, fed from the effect's aux bus.
+        Null entries are skipped but keep their bus number.
+    */
+    void createEffectReturns (tracktion::engine::Edit&, int numDeckTracks,
+                              const std::vector<tracktion::engine::Plugin::Ptr>& effects);
+}
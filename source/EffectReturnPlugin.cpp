@@ -0,0 +1,160 @@
+#include "EffectReturnPlugin.h"
+#include "TaskScheduler.h"
+
+namespace tracktion { inline namespace engine
+{
+
+namespace
+{
+    const juce::Identifier stageId ("stage");
+    const juce::Identifier returnLevelId ("returnLevel");
+}
+
+//==============================================================================
+const char* EffectReturnPlugin::xmlTypeName ("effectReturn");
+
+EffectReturnPlugin::EffectReturnPlugin (PluginCreationInfo info)  : Plugin (info)
+{
+    stage = (int) state[stageId] == (int) Stage::mixBack ? Stage::mixBack : Stage::dryCapture;
+
+    levelParam = addParam ("level", TRANS("Level"), { 0.0f, 1.0f },
+                           [] (float value) { return juce::String (juce::roundToInt (value * 100.0f)) + "%"; },
+                           [] (const juce::String& s) { return s.getFloatValue() / 100.0f; });
+
+    // Deliberately not attached to a CachedValue: see flushPluginStateToValueTree()
+    restorePluginStateFromValueTree (state);
+    lastLevel = getLevel();
+
+    // Never resized after this, since the audio thread may be using it whenever the graph is rebuilt
+    if (stage == Stage::dryCapture)
+    {
+        dry.setSize (2, maxBlockSize);
+        dry.clear();
+    }
+}
+
+EffectReturnPlugin::~EffectReturnPlugin()
+{
+    notifyListenersOfDeletion();
+}
+
+juce::ValueTree EffectReturnPlugin::create (Stage s)
+{
+    return createValueTree (IDs::PLUGIN,
+                            IDs::type, xmlTypeName,
+                            stageId, (int) s);
+}
+
+void EffectReturnPlugin::setLevel (float newLevel)
+{
+    levelParam->setParameter (juce::jlimit (0.0f, 1.0f, newLevel), juce::sendNotification);
+}
+
+void EffectReturnPlugin::flushPluginStateToValueTree()
+{
+    Plugin::flushPluginStateToValueTree();
+    state.setProperty (returnLevelId, getLevel(), nullptr);
+}
+
+void EffectReturnPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
+{
+    levelParam->setParameter ((float) v.getProperty (returnLevelId, 1.0f), juce::dontSendNotification);
+}
+
+EffectReturnPlugin* EffectReturnPlugin::findDryCapture() const
+{
+    auto* track = getOwnerTrack();
+
+    if (track == nullptr)
+        return nullptr;
+
+    // The nearest capture ahead of this one on the same track
+    EffectReturnPlugin* found = nullptr;
+
+    for (auto* p : track->pluginList)
+    {
+        if (p == this)
+            break;
+
+        if (auto* r = dynamic_cast<EffectReturnPlugin*> (p))
+            if (r->stage == Stage::dryCapture)
+                found = r;
+    }
+
+    return found;
+}
+
+void EffectReturnPlugin::initialise (const PluginInitialisationInfo& info)
+{
+    jassert (info.blockSizeSamples <= maxBlockSize);
+    juce::ignoreUnused (info);
+
+    if (stage == Stage::mixBack)
+    {
+        // The old graph may still be rendering with the old partner, which it
+        // keeps alive itself, so swap in the new one without a gap
+        auto* capture = findDryCapture();
+        jassert (capture != nullptr);
+
+        dryCapture.store (capture, std::memory_order_release);
+        dryCaptureRef = capture;
+    }
+}
+
+void EffectReturnPlugin::deinitialise()
+{
+    // The partner is kept: another graph may still be rendering through it
+}
+
+void EffectReturnPlugin::applyToBuffer (const PluginRenderContext& rc)
+{
+    // The returns run side by side on Tracktion's audio workers
+    TaskScheduler::pinToAudioCores();
+
+    if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0)
+        return;
+
+    auto& buffer = *rc.destBuffer;
+    const int start = rc.bufferStartSample;
+    const int numSamples = rc.bufferNumSamples;
+
+    if (stage == Stage::dryCapture)
+    {
+        if (numSamples > dry.getNumSamples())
+        {
+            jassertfalse;   // a bigger block than maxBlockSize
+            return;
+        }
+
+        for (int ch = 0; ch < dry.getNumChannels(); ++ch)
+        {
+            if (ch < buffer.getNumChannels())
+                dry.copyFrom (ch, 0, buffer, ch, start, numSamples);
+            else
+                dry.clear (ch, 0, numSamples);
+        }
+
+        return;
+    }
+
+    if (auto* capture = dryCapture.load (std::memory_order_acquire);
+        capture != nullptr && numSamples <= capture->dry.getNumSamples())
+    {
+        const int numChannels = juce::jmin (buffer.getNumChannels(), capture->dry.getNumChannels());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::subtract (buffer.getWritePointer (ch, start),
+                                                   capture->dry.getReadPointer (ch), numSamples);
+    }
+
+    const float newLevel = getLevel();
+
+    if (newLevel != lastLevel)
+        buffer.applyGainRamp (start, numSamples, lastLevel, newLevel);
+    else if (newLevel != 1.0f)
+        buffer.applyGain (start, numSamples, newLevel);
+
+    lastLevel = newLevel;
+}
+
+}} // namespace tracktion { inline namespace engine
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+namespace tracktion { inline namespace engine
+{
+
+/** The two ends of an effect return: one goes just before the effect and
+    remembers the dry signal, the other goes just after it and keeps only what
+    the effect changed, scaled by the return level.
+
+    The effects keep their own dry/wet mixes, so without this every return
+    would carry a copy of the dry signal and running them side by side would
+    stack it up. Returning just the difference means a single effect on a full
+    send sounds the same as it did in series, and any number of returns can be
+    summed without touching the dry path. The effects in between must not add
+    latency, which is true of all of ChopShop's effects.
+
+    Both ends live on the same track, so they're always processed in order on
+    one thread and can share the dry buffer without any locking. Tracktion
+    initialises the plugins for a new graph while the old one is still
+    rendering, so the dry buffer is sized once, up front, and the mix-back
+    end's partner is handed over atomically.
+*/
+class EffectReturnPlugin   : public Plugin
+{
+public:
+    enum class Stage
+    {
+        dryCapture,
+        mixBack
+    };
+
+    EffectReturnPlugin (PluginCreationInfo);
+    ~EffectReturnPlugin() override;
+
+    static const char* getPluginName()                  { return NEEDS_TRANS("Effect Return"); }
+    static juce::ValueTree create (Stage);
+
+    //==============================================================================
+    static const char* xmlTypeName;
+
+    juce::String getName() const override               { return stage == Stage::dryCapture ? TRANS("Return Dry") : TRANS("Return Mix"); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    void initialise (const PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const PluginRenderContext&) override;
+    void flushPluginStateToValueTree() override;
+    void restorePluginStateFromValueTree (const juce::ValueTree&) override;
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return numInputChannels; }
+    bool producesAudioWhenNoAudioInput() override       { return true; }
+    juce::String getSelectableDescription() override    { return TRANS("Effect Return Plugin"); }
+
+    Stage getStage() const noexcept                     { return stage; }
+
+    /** The largest block the dry capture holds; bigger ones aren't subtracted. */
+    static constexpr int maxBlockSize = 8192;
+
+    /** Gain applied to the returned difference, 0 to 1. Only used by the mix-back end.
+        It's played live, so it's kept in the parameter alone and only written to
+        the plugin's state when the edit is saved.
+    */
+    void setLevel (float newLevel);
+    float getLevel() const                              { return levelParam->getCurrentValue(); }
+
+    AutomatableParameter::Ptr levelParam;
+
+private:
+    EffectReturnPlugin* findDryCapture() const;
+
+    Stage stage = Stage::dryCapture;
+
+    juce::AudioBuffer<float> dry;
+
+    // The mix-back end's partner, found when the graph is built: held here on
+    // the message thread, read through the atomic on the audio thread
+    Plugin::Ptr dryCaptureRef;
+    std::atomic<EffectReturnPlugin*> dryCapture { nullptr };
+
+    float lastLevel = 1.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EffectReturnPlugin)
+};
+
+}} // namespace tracktion { inline namespace engine
@@ -0,0 +1,283 @@
+#include "FeatureExtractors.h"
+#include "BeatTracker.h"
+#include "TrackAnalyser.h"
+
+#include <cmath>
+
+//==============================================================================
+void TempoExtractor::prepare (const AnalysisFormat& format)
+{
+    sampleRate = format.sampleRate;
+    bpmDetector = std::make_unique<breakfastquay::MiniBPM> ((float) format.sampleRate);
+    bpmDetector->setBPMRange (60, 180);  // typical range for music
+
+    // Hours-long set recordings shouldn't keep three detection functions
+    // around; only the one the beat tracker needs is kept, sized up front
+    bpmDetector->setBoundedMemory (true, trackBeats);
+    bpmDetector->setExpectedInputLength (format.lengthInSamples);
+}
+
+void TempoExtractor::process (const AnalysisBlock& block)
+{
+    bpmDetector->process (block.getMono(), block.numSamples);
+}
+
+void TempoExtractor::finish (TrackAnalysis& result)
+{
+    const float detectedBPM = (float) bpmDetector->estimateTempo();
+
+    if (detectedBPM <= 0)
+    {
+        DBG ("TempoExtractor: BPM detection failed, using default BPM: " + juce::String (result.bpm, 1));
+        return;
+    }
+
+    result.bpm = detectedBPM;
+
+    if (! trackBeats)
+        return;
+
+    // Each onset value covers one hop of input; its beat is put in the middle of it
+    const double hopsPerSecond = sampleRate / bpmDetector->getOnsetHopSize();
+    const auto frames = BeatTracker::trackBeats (bpmDetector->getOnsetFunction(), 60.0 / detectedBPM * hopsPerSecond);
+
+    result.beats.clear();
+    result.beats.reserve (frames.size());
+
+    for (auto frame : frames)
+        result.beats.push_back ((frame + 0.5) / hopsPerSecond);
+}
+
+//==============================================================================
+void LoudnessExtractor::prepare (const AnalysisFormat& format)
+{
+    loudness.prepare (format.sampleRate, format.numChannels, format.maxBlockSize);
+}
+
+void LoudnessExtractor::process (const AnalysisBlock& block)
+{
+    loudness.process (block.getAudio(), block.numSamples);
+}
+
+void LoudnessExtractor::finish (TrackAnalysis& result)
+{
+    result.integratedLufs = loudness.getIntegratedLoudness();
+    result.truePeakDb = loudness.getTruePeakDecibels();
+    result.loudnessRange = loudness.getLoudnessRange();
+}
+
+//==============================================================================
+void KeyExtractor::prepare (const AnalysisFormat& format)
+{
+    keyDetector.prepare (format.sampleRate);
+}
+
+void KeyExtractor::process (const AnalysisBlock& block)
+{
+    keyDetector.process (block.getMono(), block.numSamples);
+}
+
+void KeyExtractor::finish (TrackAnalysis& result)
+{
+    result.chroma = keyDetector.getChroma();
+}
+
+//==============================================================================
+void PeakExtractor::prepare (const AnalysisFormat& format)
+{
+    file = format.file;
+    peaks.prepare (format.sampleRate, format.lengthInSamples);
+}
+
+void PeakExtractor::process (const AnalysisBlock& block)
+{
+    peaks.addSamples (block.getMono(), block.numSamples);
+}
+
+void PeakExtractor::finish (TrackAnalysis&)
+{
+    if (! peaks.saveFor (file))
+        DBG ("PeakExtractor: couldn't write peak cache for " + file.getFileName());
+}
+
+//==============================================================================
+void SilenceExtractor::prepare (const AnalysisFormat& format)
+{
+    sampleRate = format.sampleRate;
+    lengthInSamples = format.lengthInSamples;
+    threshold = juce::Decibels::decibelsToGain (thresholdDb);
+    firstSound = lastSound = -1;
+}
+
+void SilenceExtractor::process (const AnalysisBlock& block)
+{
+    const auto& audio = block.getAudio();
+
+    for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+    {
+        const auto* data = audio.getReadPointer (ch);
+
+        // Most blocks are either all silence or all sound, so check the range first
+        if (audio.getMagnitude (ch, 0, block.numSamples) < threshold)
+            continue;
+
+        if (firstSound < 0 || block.startSample < firstSound)
+        {
+            for (int i = 0; i < block.numSamples; ++i)
+            {
+                if (std::abs (data[i]) >= threshold)
+                {
+                    const auto pos = block.startSample + i;
+                    firstSound = firstSound < 0 ? pos : juce::jmin (firstSound, pos);
+                    break;
+                }
+            }
+        }
+
+        for (int i = block.numSamples; --i >= 0;)
+        {
+            if (std::abs (data[i]) >= threshold)
+            {
+                lastSound = juce::jmax (lastSound, block.startSample + i);
+                break;
+            }
+        }
+    }
+}
+
+void SilenceExtractor::finish (TrackAnalysis& result)
+{
+    if (firstSound < 0)
+        return; // silent all the way through
+
+    result.cues.audioStart = (double) firstSound / sampleRate;
+    result.cues.audioEnd = (double) juce::jmin (lastSound + 1, lengthInSamples) / sampleRate;
+    result.hasCues = true;
+}
+
+//==============================================================================
+void DownbeatExtractor::prepare (const AnalysisFormat& format)
+{
+    sampleRate = format.sampleRate;
+    hopSize = juce::jmax (1, juce::roundToInt (sampleRate * 0.01));  // 10 ms
+
+    // One-pole low-pass around 150 Hz, enough to leave mostly kick and bass
+    lowPassCoefficient = (float) std::exp (-juce::MathConstants<double>::twoPi * 150.0 / sampleRate);
+    lowPassState = 0.0f;
+
+    hopFill = 0;
+    hopEnergy = previousHopLevel = 0.0;
+
+    onsets.clear();
+    onsets.reserve ((size_t) (format.lengthInSamples / hopSize + 1));
+}
+
+void DownbeatExtractor::process (const AnalysisBlock& block)
+{
+    const auto* mono = block.getMono();
+    const float a = lowPassCoefficient;
+
+    for (int i = 0; i < block.numSamples; ++i)
+    {
+        lowPassState = mono[i] + a * (lowPassState - mono[i]);
+        hopEnergy += lowPassState * lowPassState;
+
+        if (++hopFill == hopSize)
+        {
+            const double level = std::sqrt (hopEnergy / hopSize);
+            onsets.push_back ((float) juce::jmax (0.0, level - previousHopLevel));
+
+            previousHopLevel = level;
+            hopEnergy = 0.0;
+            hopFill = 0;
+        }
+    }
+}
+
+float DownbeatExtractor::getOnsetNear (double hop) const
+{
+    // Allow a hop either side for rounding and a slightly loose grid
+    const int centre = juce::roundToInt (hop);
+    float best = 0.0f;
+
+    for (int i = juce::jmax (0, centre - 1); i <= juce::jmin ((int) onsets.size() - 1, centre + 1); ++i)
+        best = juce::jmax (best, onsets[(size_t) i]);
+
+    return best;
+}
+
+void DownbeatExtractor::finish (TrackAnalysis& result)
+{
+    if (! result.hasCues || result.bpm <= 0.0 || onsets.empty())
+        return;
+
+    const double hopsPerSecond = sampleRate / hopSize;
+    const double beatPeriod = 60.0 / result.bpm * hopsPerSecond;
+    const double firstHop = result.cues.audioStart * hopsPerSecond;
+    const double lastHop = juce::jmin ((double) onsets.size(), result.cues.audioEnd * hopsPerSecond);
+
+    if (lastHop - firstHop < beatPeriod * beatsPerBar * 2)
+        return; // too short to say where the bars are
+
+    // Beat phase: the offset whose grid lands on the most onset energy
+    double bestPhase = 0.0;
+    float bestScore = -1.0f;
+
+    for (int phase = 0; phase < (int) std::ceil (beatPeriod); ++phase)
+    {
+        float score = 0.0f;
+
+        for (double hop = firstHop + phase; hop < lastHop; hop += beatPeriod)
+            score += getOnsetNear (hop);
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestPhase = firstHop + phase;
+        }
+    }
+
+    // Bar phase: which beat of the bar carries the most low end
+    std::vector<double> beats;
+
+    for (double hop = bestPhase; hop < lastHop; hop += beatPeriod)
+        beats.push_back (hop);
+
+    int bestBarPhase = 0;
+    float bestBarScore = -1.0f;
+
+    for (int barPhase = 0; barPhase < beatsPerBar; ++barPhase)
+    {
+        float score = 0.0f;
+
+        for (size_t i = (size_t) barPhase; i < beats.size(); i += beatsPerBar)
+            score += getOnsetNear (beats[i]);
+
+        if (score > bestBarScore)
+        {
+            bestBarScore = score;
+            bestBarPhase = barPhase;
+        }
+    }
+
+    // First strong downbeat: skip quiet intro bars until one hits at least
+    // half as hard as the track's average downbeat
+    std::vector<double> downbeats;
+
+    for (size_t i = (size_t) bestBarPhase; i < beats.size(); i += beatsPerBar)
+        downbeats.push_back (beats[i]);
+
+    if (downbeats.empty())
+        return;
+
+    const float meanStrength = bestBarScore / (float) downbeats.size();
+
+    for (auto hop : downbeats)
+    {
+        if (getOnsetNear (hop) >= 0.5f * meanStrength)
+        {
+            result.cues.firstDownbeat = hop / hopsPerSecond;
+            break;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "AnalysisPipeline.h"
+#include "KeyDetector.h"
+#include "LoudnessAnalyser.h"
+#include "PeakCache.h"
+#include "minibpm.h"
+
+//==============================================================================
+/** Tempo, via MiniBPM on the mono mix, and every beat, tracked on the onset
+    function MiniBPM worked the tempo out from.
+*/
+class TempoExtractor  : public FeatureExtractor
+{
+public:
+    /** Without beat tracking, only the tempo is estimated and the onset function isn't kept. */
+    explicit TempoExtractor (bool shouldTrackBeats = true)  : trackBeats (shouldTrackBeats) {}
+
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+private:
+    const bool trackBeats;
+    double sampleRate = 44100.0;
+    std::unique_ptr<breakfastquay::MiniBPM> bpmDetector;
+};
+
+//==============================================================================
+/** EBU R128 integrated loudness, loudness range and true peak. */
+class LoudnessExtractor  : public FeatureExtractor
+{
+public:
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+private:
+    LoudnessAnalyser loudness;
+};
+
+//==============================================================================
+/** Chroma profile for key estimation. */
+class KeyExtractor  : public FeatureExtractor
+{
+public:
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+private:
+    KeyDetector keyDetector;
+};
+
+//==============================================================================
+/** Waveform overview, saved to the peak cache for the Thumbnail to draw. */
+class PeakExtractor  : public FeatureExtractor
+{
+public:
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+private:
+    juce::File file;
+    PeakCache peaks;
+};
+
+//==============================================================================
+/** Finds where the leading silence ends and the trailing silence starts. */
+class SilenceExtractor  : public FeatureExtractor
+{
+public:
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+    static constexpr float thresholdDb = -50.0f;
+
+private:
+    double sampleRate = 44100.0;
+    juce::int64 lengthInSamples = 0;
+    float threshold = 0.0f;
+
+    juce::int64 firstSound = -1, lastSound = -1;
+};
+
+//==============================================================================
+/** Locates the beat phase and the first strong downbeat.
+
+    Builds a low-band onset envelope as the blocks go past, then in finish()
+    lines a beat grid at the detected tempo up against it. The bar phase is
+    the one whose beats carry the most low-end energy, i.e. the kicks.
+
+    Needs the tempo and silence results, so it must be added to the pipeline
+    after the TempoExtractor and SilenceExtractor.
+*/
+class DownbeatExtractor  : public FeatureExtractor
+{
+public:
+    void prepare (const AnalysisFormat&) override;
+    void process (const AnalysisBlock&) override;
+    void finish (TrackAnalysis&) override;
+
+    static constexpr int beatsPerBar = 4;
+
+private:
+    double sampleRate = 44100.0;
+    int hopSize = 441;
+    int hopFill = 0;
+    float lowPassCoefficient = 0.0f, lowPassState = 0.0f;
+    double hopEnergy = 0.0, previousHopLevel = 0.0;
+
+    std::vector<float> onsets;  // half-wave rectified rise in low-band level, one per hop
+
+    float getOnsetNear (double hop) const;
+};
@@ -0,0 +1,336 @@
+#include "HotCuePlugin.h"
+
+namespace tracktion { inline namespace engine
+{
+
+//==============================================================================
+const char* HotCuePlugin::xmlTypeName ("hotCues");
+
+HotCuePlugin::HotCuePlugin (PluginCreationInfo info)  : Plugin (info)
+{
+    for (auto& cue : cueBeats)
+        cue = -1.0;
+}
+
+HotCuePlugin::~HotCuePlugin()
+{
+    notifyListenersOfDeletion();
+}
+
+juce::ValueTree HotCuePlugin::create()
+{
+    return createValueTree (IDs::PLUGIN,
+                            IDs::type, xmlTypeName);
+}
+
+void HotCuePlugin::initialise (const PluginInitialisationInfo& info)
+{
+    sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+    fadeSamples = juce::jmax (1, juce::roundToInt (sampleRate * fadeSeconds));
+
+    syncToTempoSequence();
+}
+
+void HotCuePlugin::deinitialise()
+{
+}
+
+void HotCuePlugin::syncToTempoSequence()
+{
+    // ChopShop keeps a single tempo at the start of the edit, so one rate
+    // covers the whole timeline
+    const double bpm = edit.tempoSequence.getTempoAt (tracktion::TimePosition()).getBpm();
+
+    if (bpm > 0.0)
+        beatsPerSecond = bpm / 60.0;
+}
+
+//==============================================================================
+void HotCuePlugin::triggerCue (int slot)
+{
+    if (! juce::isPositiveAndBelow (slot, numCues))
+        return;
+
+    postCommand ({ Command::Type::triggerCue, slot, 0.0 });
+}
+
+void HotCuePlugin::startLoopRoll (double lengthInBeats)
+{
+    if (lengthInBeats <= 0.0)
+        return;
+
+    rolling = true;
+    postCommand ({ Command::Type::startRoll, 0, lengthInBeats });
+}
+
+void HotCuePlugin::stopLoopRoll()
+{
+    rolling = false;
+    postCommand ({ Command::Type::stopRoll, 0, 0.0 });
+}
+
+void HotCuePlugin::setCue (int slot, tracktion::BeatPosition position)
+{
+    if (juce::isPositiveAndBelow (slot, numCues))
+        cueBeats[(size_t) slot] = juce::jmax (0.0, position.inBeats());
+}
+
+void HotCuePlugin::clearCue (int slot)
+{
+    if (juce::isPositiveAndBelow (slot, numCues))
+        cueBeats[(size_t) slot] = -1.0;
+}
+
+void HotCuePlugin::clearAllCues()
+{
+    for (int i = 0; i < numCues; ++i)
+        clearCue (i);
+}
+
+std::optional<tracktion::BeatPosition> HotCuePlugin::getCue (int slot) const
+{
+    if (! juce::isPositiveAndBelow (slot, numCues))
+        return {};
+
+    const double beat = cueBeats[(size_t) slot].load (std::memory_order_relaxed);
+
+    if (beat < 0.0)
+        return {};
+
+    return tracktion::BeatPosition::fromBeats (beat);
+}
+
+void HotCuePlugin::postCommand (const Command& command)
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        commands[(size_t) start1] = command;
+    else if (size2 > 0)
+        commands[(size_t) start2] = command;
+    else
+        return; // the audio thread isn't running, so there's nothing to act on it anyway
+
+    commandFifo.finishedWrite (1);
+}
+
+//==============================================================================
+double HotCuePlugin::getNextGridBeat (double beat, double grid) const noexcept
+{
+    if (grid <= 0.0)
+        return beat;
+
+    // A beat that's already on the grid counts as the next one
+    return std::ceil (beat / grid - 1.0e-9) * grid;
+}
+
+void HotCuePlugin::jumpTo (double targetBeat, double bps)
+{
+    const double targetSeconds = juce::jmax (0.0, targetBeat / bps);
+
+    // postPosition only hands the position to the player, which applies it at
+    // the start of the next block, so this is fine to call from here
+    if (auto* epc = edit.getCurrentPlaybackContext())
+    {
+        lastJumpSeconds.store (targetSeconds, std::memory_order_release);
+        epc->postPosition (tracktion::TimePosition::fromSeconds (targetSeconds), {});
+    }
+}
+
+bool HotCuePlugin::isOwnJumpTo (tracktion::TimePosition position, double rate) const noexcept
+{
+    const double target = lastJumpSeconds.load (std::memory_order_acquire);
+    return target >= 0.0 && std::abs (position.inSeconds() - target) * rate <= 1.0;
+}
+
+void HotCuePlugin::handleCommand (const Command& command, double blockStartBeat, double blockEndBeat, bool isPlaying)
+{
+    const double grid = quantisationBeats.load (std::memory_order_relaxed);
+
+    switch (command.type)
+    {
+        case Command::Type::triggerCue:
+        {
+            auto& cue = cueBeats[(size_t) command.slot];
+            const double cueBeat = cue.load (std::memory_order_relaxed);
+
+            if (cueBeat < 0.0)
+            {
+                // Empty slot: remember where we are, snapped to the grid
+                cue = grid > 0.0 ? std::round (blockStartBeat / grid) * grid : blockStartBeat;
+            }
+            else if (! isPlaying)
+            {
+                jumpTo (cueBeat, beatsPerSecond.load (std::memory_order_relaxed));
+            }
+            else
+            {
+                pendingJumpAtBeat = getNextGridBeat (blockEndBeat, grid);
+                pendingTargetBeat = cueBeat;
+            }
+
+            break;
+        }
+
+        case Command::Type::startRoll:
+        {
+            if (! isPlaying)
+                break;
+
+            // Loop the roll-length slice we're in, so the first repeat lands on the grid
+            rollLengthBeats = command.beats;
+            rollStartBeat = std::floor (blockEndBeat / rollLengthBeats) * rollLengthBeats;
+            slipBeats = 0.0;
+            rollExitPending = false;
+            break;
+        }
+
+        case Command::Type::stopRoll:
+        {
+            if (rollLengthBeats <= 0.0)
+                break;
+
+            if (! isPlaying)
+            {
+                rollLengthBeats = 0.0;
+                slipBeats = 0.0;
+                break;
+            }
+
+            rollExitPending = true;
+            break;
+        }
+    }
+}
+
+void HotCuePlugin::applyToBuffer (const PluginRenderContext& rc)
+{
+    const double bps = beatsPerSecond.load (std::memory_order_relaxed);
+    const double blockStartBeat = rc.editTime.getStart().inSeconds() * bps;
+    const double blockEndBeat = rc.editTime.getEnd().inSeconds() * bps;
+    const double blockLengthBeats = blockEndBeat - blockStartBeat;
+
+    // The decks have already rendered this block and seen where the last jump
+    // went, so it no longer needs marking
+    lastJumpSeconds.store (-1.0, std::memory_order_relaxed);
+
+    if (const int numReady = commandFifo.getNumReady(); numReady > 0)
+    {
+        int start1, size1, start2, size2;
+        commandFifo.prepareToRead (numReady, start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            handleCommand (commands[(size_t) (start1 + i)], blockStartBeat, blockEndBeat, rc.isPlaying);
+
+        for (int i = 0; i < size2; ++i)
+            handleCommand (commands[(size_t) (start2 + i)], blockStartBeat, blockEndBeat, rc.isPlaying);
+
+        commandFifo.finishedRead (size1 + size2);
+    }
+
+    if (! rc.isPlaying || rc.destBuffer == nullptr || rc.bufferNumSamples <= 0)
+    {
+        fadeInPending = false;
+        return;
+    }
+
+    auto& buffer = *rc.destBuffer;
+    const int numSamples = rc.bufferNumSamples;
+
+    if (fadeInPending)
+    {
+        // Mute the run-up to the beat and fade in just before it
+        const int fadeEnd = juce::jmin (numSamples, juce::jmax (fadeSamples, fadeInEndSample));
+        const int fadeStart = juce::jmax (0, fadeEnd - fadeSamples);
+
+        buffer.clear (rc.bufferStartSample, fadeStart);
+        buffer.applyGainRamp (rc.bufferStartSample + fadeStart, fadeEnd - fadeStart, 0.0f, 1.0f);
+        fadeInPending = false;
+    }
+
+    // Work out which event comes next. Ties go to the cue, then to leaving the roll.
+    enum class Event { none, cue, rollExit, rollRepeat };
+    Event event = Event::none;
+    double eventBeat = 0.0, targetBeat = 0.0;
+
+    if (pendingJumpAtBeat >= 0.0)
+    {
+        event = Event::cue;
+        eventBeat = pendingJumpAtBeat;
+        targetBeat = pendingTargetBeat;
+    }
+
+    if (rollLengthBeats > 0.0)
+    {
+        // Someone moved the playhead away from the roll, so pick it up from there
+        if (rollStartBeat + rollLengthBeats < blockStartBeat - blockLengthBeats)
+            rollStartBeat = std::floor (blockEndBeat / rollLengthBeats) * rollLengthBeats;
+
+        const double rollEndBeat = rollStartBeat + rollLengthBeats;
+
+        if (rollExitPending)
+        {
+            const double exitBeat = juce::jmin (getNextGridBeat (blockEndBeat, quantisationBeats.load (std::memory_order_relaxed)),
+                                                rollEndBeat);
+
+            if (event == Event::none || exitBeat < eventBeat)
+            {
+                event = Event::rollExit;
+                eventBeat = exitBeat;
+                targetBeat = exitBeat + slipBeats;
+            }
+        }
+        else if (event == Event::none || rollEndBeat < eventBeat)
+        {
+            event = Event::rollRepeat;
+            eventBeat = rollEndBeat;
+            targetBeat = rollStartBeat;
+        }
+    }
+
+    // Only act in the last block before the event
+    if (event == Event::none || eventBeat - blockEndBeat >= blockLengthBeats)
+        return;
+
+    switch (event)
+    {
+        case Event::cue:
+            pendingJumpAtBeat = -1.0;
+            rollLengthBeats = 0.0;
+            slipBeats = 0.0;
+            rollExitPending = false;
+            break;
+
+        case Event::rollExit:
+            rollLengthBeats = 0.0;
+            rollExitPending = false;
+
+            // Let go before the roll ever repeated: we're already in the right place
+            if (slipBeats == 0.0)
+                return;
+
+            slipBeats = 0.0;
+            break;
+
+        case Event::rollRepeat:
+            slipBeats += rollLengthBeats;
+            break;
+
+        case Event::none:
+            return;
+    }
+
+    // Start the next block early by however far it is to the beat, so the
+    // target lands on it; the next block mutes everything before that
+    const double prerollBeats = juce::jmax (0.0, eventBeat - blockEndBeat);
+
+    const int fadeLength = juce::jmin (fadeSamples, numSamples);
+    buffer.applyGainRamp (rc.bufferStartSample + numSamples - fadeLength, fadeLength, 1.0f, 0.0f);
+
+    jumpTo (targetBeat - prerollBeats, bps);
+    fadeInEndSample = juce::roundToInt (prerollBeats / bps * sampleRate);
+    fadeInPending = true;
+}
+
+}} // namespace tracktion { inline namespace engine
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include <array>
+
+namespace tracktion { inline namespace engine
+{
+
+/** Hot cues and loop rolls, executed on the audio thread.
+
+    Triggers arrive as small commands in a fixed-size lock-free queue, pushed
+    from the audio device thread by the PerformanceBridge. The audio thread
+    drains it every block, works
+    out the next quantised beat from the tempo, and moves the playhead itself,
+    so a jump never waits on the message thread.
+
+    The player can only move at a block boundary, so a jump is made at the
+    one just before the quantised beat, with the new position started early
+    by the distance to the beat. The old audio fades out at the boundary; the
+    new position's run-up is muted and fades in over a couple of milliseconds
+    ending on the beat, so the cue itself lands on the beat to the sample and
+    what's left of the block before it is silent rather than pre-roll.
+
+    Goes on the master track, so a jump moves every deck at once.
+*/
+class HotCuePlugin   : public Plugin
+{
+public:
+    HotCuePlugin (PluginCreationInfo);
+    ~HotCuePlugin() override;
+
+    static const char* getPluginName()                  { return NEEDS_TRANS("Hot Cues"); }
+    static juce::ValueTree create();
+
+    //==============================================================================
+    static const char* xmlTypeName;
+
+    juce::String getName() const override               { return TRANS("Hot Cues"); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    void initialise (const PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const PluginRenderContext&) override;
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return numInputChannels; }
+    bool producesAudioWhenNoAudioInput() override       { return false; }
+    juce::String getSelectableDescription() override    { return TRANS("Hot Cue Plugin"); }
+
+    //==============================================================================
+    static constexpr int numCues = 8;
+
+    /** Jumps to the cue at the next quantised beat. If the slot is empty, the
+        current position, rounded to the nearest quantised beat, is stored in it.
+        Call from one thread only.
+    */
+    void triggerCue (int slot);
+
+    /** Starts looping the last lengthInBeats beats until stopLoopRoll() is
+        called. The track keeps running underneath, so playback comes back in
+        where it would have been without the roll. Call from one thread only.
+    */
+    void startLoopRoll (double lengthInBeats);
+    void stopLoopRoll();
+
+    /** Sets a cue directly, e.g. from the analysis cue points on load. */
+    void setCue (int slot, tracktion::BeatPosition);
+    void clearCue (int slot);
+    void clearAllCues();
+
+    std::optional<tracktion::BeatPosition> getCue (int slot) const;
+    bool isRolling() const noexcept                     { return rolling.load (std::memory_order_relaxed); }
+
+    /** True if the playhead got to this position by one of this plugin's own
+        jumps in the block before, rather than by a seek. Safe to call from the
+        audio thread, from plugins that render ahead of this one.
+    */
+    bool isOwnJumpTo (tracktion::TimePosition, double sampleRate) const noexcept;
+
+    /** Grid that jumps wait for, in beats. Zero jumps at the next block. */
+    void setQuantisation (double beats)                 { quantisationBeats = juce::jmax (0.0, beats); }
+
+    /** Picks up the current tempo from the edit's tempo sequence. Call on the
+        message thread whenever the tempo changes.
+    */
+    void syncToTempoSequence();
+
+private:
+    struct Command
+    {
+        enum class Type { triggerCue, startRoll, stopRoll };
+
+        Type type = Type::triggerCue;
+        int slot = 0;
+        double beats = 0.0;
+    };
+
+    static constexpr int commandQueueSize = 64;
+    static constexpr double fadeSeconds = 0.002;
+
+    void postCommand (const Command&);
+    void handleCommand (const Command&, double blockStartBeat, double blockEndBeat, bool isPlaying);
+    double getNextGridBeat (double beat, double grid) const noexcept;
+    void jumpTo (double targetBeat, double beatsPerSecond);
+
+    // One writer (the thread the triggers come from) and one reader (the audio thread)
+    std::array<Command, commandQueueSize> commands;
+    juce::AbstractFifo commandFifo { commandQueueSize };
+
+    std::array<std::atomic<double>, numCues> cueBeats;
+    std::atomic<double> beatsPerSecond { 2.0 };
+    std::atomic<double> quantisationBeats { 1.0 };
+    std::atomic<bool> rolling { false };
+    std::atomic<double> lastJumpSeconds { -1.0 };     // where the last block's jump went, if it made one
+
+    // Audio thread only
+    double sampleRate = 44100.0;
+    int fadeSamples = 88;
+    bool fadeInPending = false;
+    int fadeInEndSample = 0;          // where the beat falls in the block after a jump
+
+    double pendingJumpAtBeat = -1.0, pendingTargetBeat = 0.0;
+
+    double rollStartBeat = 0.0, rollLengthBeats = 0.0;
+    double slipBeats = 0.0;           // how far the playhead has fallen behind the track's timeline
+    bool rollExitPending = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HotCuePlugin)
+};
+
+}} // namespace tracktion { inline namespace engine
@@ -0,0 +1,199 @@
+#include "KeyDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Krumhansl-Kessler key profiles, starting from the tonic
+    constexpr float majorProfile[12] = { 6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f };
+    constexpr float minorProfile[12] = { 6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f };
+
+    const char* const pitchClassNames[12] = { "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B" };
+
+    float correlate (const float* a, const float* profile, int rotation)
+    {
+        float meanA = 0.0f, meanB = 0.0f;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            meanA += a[i];
+            meanB += profile[i];
+        }
+
+        meanA /= 12.0f;
+        meanB /= 12.0f;
+
+        float num = 0.0f, denA = 0.0f, denB = 0.0f;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            const float da = a[(i + rotation) % 12] - meanA;
+            const float db = profile[i] - meanB;
+            num += da * db;
+            denA += da * da;
+            denB += db * db;
+        }
+
+        const float den = std::sqrt (denA * denB);
+        return den > 0.0f ? num / den : 0.0f;
+    }
+}
+
+//==============================================================================
+juce::String MusicalKey::getName() const
+{
+    return juce::String (pitchClassNames[((tonic % 12) + 12) % 12]) + (isMinor ? "m" : "");
+}
+
+//==============================================================================
+KeyDetector::KeyDetector()
+    : frame ((size_t) fftSize), fftData ((size_t) fftSize * 2)
+{
+}
+
+void KeyDetector::prepare (double sampleRate)
+{
+    decimation = juce::jmax (1, (int) std::floor (sampleRate / targetRate));
+    const double decimatedRate = sampleRate / decimation;
+
+    antiAlias.setCoefficients (juce::IIRCoefficients::makeLowPass (sampleRate, 0.4 * decimatedRate));
+
+    filtered.allocate ((size_t) fftSize, true);
+
+    // Map each FFT bin in the useful range to its nearest pitch class
+    binPitchClass.assign ((size_t) fftSize / 2, -1);
+
+    for (int bin = 1; bin < fftSize / 2; ++bin)
+    {
+        const double freq = bin * decimatedRate / fftSize;
+
+        if (freq < minFrequency || freq > maxFrequency)
+            continue;
+
+        const int midiNote = juce::roundToInt (69.0 + 12.0 * std::log2 (freq / 440.0));
+        binPitchClass[(size_t) bin] = midiNote % 12;
+    }
+
+    reset();
+}
+
+void KeyDetector::reset()
+{
+    antiAlias.reset();
+    decimationPhase = 0;
+    frameFill = 0;
+    chromaSum.fill (0.0);
+}
+
+void KeyDetector::process (const float* samples, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const int num = juce::jmin (numSamples, fftSize);
+
+        juce::FloatVectorOperations::copy (filtered.get(), samples, num);
+        antiAlias.processSamples (filtered.get(), num);
+
+        for (int i = decimationPhase; i < num; i += decimation)
+        {
+            frame[(size_t) frameFill++] = filtered[i];
+
+            if (frameFill == fftSize)
+            {
+                processFrame();
+                frameFill = 0;
+            }
+        }
+
+        // Carry the decimation phase over into the next chunk
+        decimationPhase = (decimationPhase + decimation - num % decimation) % decimation;
+
+        samples += num;
+        numSamples -= num;
+    }
+}
+
+void KeyDetector::processFrame()
+{
+    std::copy (frame.begin(), frame.end(), fftData.begin());
+    window.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    for (int bin = 1; bin < fftSize / 2; ++bin)
+        if (const int pc = binPitchClass[(size_t) bin]; pc >= 0)
+            chromaSum[(size_t) pc] += fftData[(size_t) bin];
+}
+
+ChromaProfile KeyDetector::getChroma() const
+{
+    ChromaProfile chroma {};
+    const double maxValue = *std::max_element (chromaSum.begin(), chromaSum.end());
+
+    if (maxValue > 0.0)
+        for (size_t i = 0; i < chroma.size(); ++i)
+            chroma[i] = (float) (chromaSum[i] / maxValue);
+
+    return chroma;
+}
+
+//==============================================================================
+MusicalKey KeyDetector::estimateKey (const ChromaProfile& chroma, double semitoneShift)
+{
+    // Transpose by interpolating between neighbouring pitch classes, so a
+    // fractional shift lands between the two nearest keys
+    float shifted[12];
+
+    for (int pc = 0; pc < 12; ++pc)
+    {
+        const double source = pc - semitoneShift;
+        const double lower = std::floor (source);
+        const float frac = (float) (source - lower);
+        const int i0 = (((int) lower % 12) + 12) % 12;
+        const int i1 = (i0 + 1) % 12;
+
+        shifted[pc] = (1.0f - frac) * chroma[(size_t) i0] + frac * chroma[(size_t) i1];
+    }
+
+    MusicalKey best;
+    best.confidence = -1.0f;
+
+    for (int tonic = 0; tonic < 12; ++tonic)
+    {
+        if (const float r = correlate (shifted, majorProfile, tonic); r > best.confidence)
+            best = { tonic, false, r };
+
+        if (const float r = correlate (shifted, minorProfile, tonic); r > best.confidence)
+            best = { tonic, true, r };
+    }
+
+    return best;
+}
+
+double KeyDetector::getSemitoneShiftForRatio (double speedRatio)
+{
+    return speedRatio > 0.0 ? 12.0 * std::log2 (speedRatio) : 0.0;
+}
+
+juce::String KeyDetector::chromaToString (const ChromaProfile& chroma)
+{
+    juce::StringArray values;
+
+    for (auto v : chroma)
+        values.add (juce::String (v, 4));
+
+    return values.joinIntoString (" ");
+}
+
+bool KeyDetector::chromaFromString (const juce::String& text, ChromaProfile& chroma)
+{
+    auto values = juce::StringArray::fromTokens (text, " ", {});
+
+    if (values.size() != 12)
+        return false;
+
+    for (int i = 0; i < 12; ++i)
+        chroma[(size_t) i] = values[i].getFloatValue();
+
+    return *std::max_element (chroma.begin(), chroma.end()) > 0.0f;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <array>
+
+//==============================================================================
+/** A musical key: tonic pitch class (0 = C) and mode. */
+struct MusicalKey
+{
+    int tonic = 0;
+    bool isMinor = false;
+    float confidence = 0.0f;    // correlation with the best matching key profile
+
+    /** e.g. "C", "F#m" */
+    juce::String getName() const;
+};
+
+using ChromaProfile = std::array<float, 12>;
+
+//==============================================================================
+/** Estimates the key of a track from an averaged chroma (pitch class) profile.
+
+    The mono signal is low-passed and decimated to around 11 kHz before the
+    FFT, since nothing above a few kHz helps with pitch and the smaller
+    frames make the analysis cheap. Each frame's magnitudes are folded into
+    twelve pitch classes and summed over the whole track.
+
+    The chroma profile is what gets stored, not just the key, so the key at
+    any playback speed can be worked out later without re-analysing.
+*/
+class KeyDetector
+{
+public:
+    KeyDetector();
+
+    void prepare (double sampleRate);
+    void reset();
+
+    /** Feeds mono samples. */
+    void process (const float* samples, int numSamples);
+
+    /** The summed chroma of everything processed so far, scaled so the largest
+        pitch class is 1. All zeros if nothing pitched was heard.
+    */
+    ChromaProfile getChroma() const;
+
+    //==============================================================================
+    /** Finds the best matching major/minor key for a chroma profile, after
+        transposing it by the given (possibly fractional) number of semitones.
+    */
+    static MusicalKey estimateKey (const ChromaProfile& chroma, double semitoneShift = 0.0);
+
+    /** Semitone shift produced by playing back at the given speed ratio without
+        pitch correction, which is what the screw effect does.
+    */
+    static double getSemitoneShiftForRatio (double speedRatio);
+
+    static juce::String chromaToString (const ChromaProfile&);
+    static bool chromaFromString (const juce::String&, ChromaProfile&);
+
+private:
+    void processFrame();
+
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr double targetRate = 11025.0;
+    static constexpr double minFrequency = 65.0;    // C2
+    static constexpr double maxFrequency = 2100.0;  // C7
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+
+    juce::IIRFilter antiAlias;
+    int decimation = 4;
+    int decimationPhase = 0;
+
+    juce::HeapBlock<float> filtered;
+    std::vector<float> frame;
+    std::vector<float> fftData;
+    int frameFill = 0;
+
+    std::vector<int> binPitchClass;     // -1 for bins outside the analysis range
+    std::array<double, 12> chromaSum {};
+
+    JUCE_DECLARE_NON_COPYABLE (KeyDetector)
+};
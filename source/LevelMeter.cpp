@@ -0,0 +1,172 @@
+#include "LevelMeter.h"
+
+#include <cmath>
+
+namespace
+{
+    constexpr float peakFallDbPerSecond = 20.0f;
+    constexpr double rmsTimeSeconds = 0.3;
+    constexpr double truePeakHoldSeconds = 1.0;
+
+    float toDecibels (float gain) noexcept
+    {
+        return juce::Decibels::gainToDecibels (gain, LevelMeter::minDb);
+    }
+
+    float toLufs (double meanSquare) noexcept
+    {
+        return juce::jmax (LevelMeter::minDb, (float) LoudnessAnalyser::energyToLoudness (meanSquare));
+    }
+}
+
+//==============================================================================
+LevelMeter::LevelMeter()
+    : filtered (numChannels, chunkSize)
+{
+    truePeakDetector.prepare (numChannels, chunkSize);
+}
+
+void LevelMeter::prepare (double newSampleRate) noexcept
+{
+    requestedSampleRate.store (newSampleRate > 0.0 ? newSampleRate : 44100.0, std::memory_order_relaxed);
+}
+
+void LevelMeter::reset (double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    samplesPerStep = juce::roundToInt (sampleRate / 10.0);
+
+    kWeighting.prepare (sampleRate);
+    truePeakDetector.reset();
+
+    peak = meanSquare = truePeak = 0.0f;
+    truePeakHoldSamples = 0;
+    stepFill = 0;
+    stepEnergy = 0.0;
+    steps.fill (0.0);
+    nextStep = numSteps = 0;
+}
+
+void LevelMeter::process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    const double rate = requestedSampleRate.load (std::memory_order_relaxed);
+
+    if (rate <= 0.0 || buffer.getNumChannels() == 0)
+        return;
+
+    if (rate != sampleRate)
+        reset (rate);
+
+    for (int done = 0; done < numSamples; done += chunkSize)
+        processChunk (buffer, startSample + done, juce::jmin (chunkSize, numSamples - done));
+
+    publish();
+}
+
+void LevelMeter::processChunk (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    const int numSourceChannels = buffer.getNumChannels();
+    const float* input[numChannels];
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        input[ch] = buffer.getReadPointer (juce::jmin (ch, numSourceChannels - 1), startSample);
+
+    const float seconds = (float) (numSamples / sampleRate);
+    float blockPeak = 0.0f, blockTruePeak = 0.0f, blockSquares = 0.0f;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax (input[ch], numSamples);
+        blockPeak = juce::jmax (blockPeak, -range.getStart(), range.getEnd());
+        blockTruePeak = juce::jmax (blockTruePeak, truePeakDetector.process (ch, input[ch], numSamples));
+
+        float sum = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            sum += input[ch][i] * input[ch][i];
+
+        blockSquares += sum;
+    }
+
+    // Peak: jumps up, falls at a fixed rate in dB
+    const float fall = juce::Decibels::decibelsToGain (-peakFallDbPerSecond * seconds);
+    peak = juce::jmax (blockPeak, peak * fall);
+
+    // RMS: one-pole average of the mean square, the time constant scaled to the block
+    const float coefficient = (float) (1.0 - std::exp (-seconds / rmsTimeSeconds));
+    meanSquare += (blockSquares / (float) (numSamples * numChannels) - meanSquare) * coefficient;
+
+    // True peak: holds, then falls like the peak
+    if (blockTruePeak >= truePeak)
+    {
+        truePeak = blockTruePeak;
+        truePeakHoldSamples = (int) (truePeakHoldSeconds * sampleRate);
+    }
+    else if ((truePeakHoldSamples -= numSamples) < 0)
+    {
+        truePeak = juce::jmax (blockTruePeak, truePeak * fall);
+    }
+
+    // Loudness: K-weighted energy summed over the channels into 100 ms steps
+    kWeighting.process (input, filtered.getArrayOfWritePointers(), numChannels, numSamples);
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int num = juce::jmin (samplesPerStep - stepFill, numSamples - pos);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* data = filtered.getReadPointer (ch, pos);
+            float sum = 0.0f;
+
+            for (int i = 0; i < num; ++i)
+                sum += data[i] * data[i];
+
+            stepEnergy += sum;
+        }
+
+        stepFill += num;
+        pos += num;
+
+        if (stepFill == samplesPerStep)
+        {
+            steps[(size_t) nextStep] = stepEnergy / samplesPerStep;
+            nextStep = (nextStep + 1) % stepsPerShortTerm;
+            numSteps = juce::jmin (numSteps + 1, stepsPerShortTerm);
+            stepEnergy = 0.0;
+            stepFill = 0;
+
+            double momentary = 0.0, shortTerm = 0.0;
+
+            for (int i = 0; i < numSteps; ++i)
+            {
+                const double energy = steps[(size_t) ((nextStep - 1 - i + stepsPerShortTerm) % stepsPerShortTerm)];
+                shortTerm += energy;
+
+                if (i < stepsPerMomentary)
+                    momentary += energy;
+            }
+
+            momentaryLufs.store (toLufs (momentary / stepsPerMomentary), std::memory_order_relaxed);
+            shortTermLufs.store (toLufs (shortTerm / stepsPerShortTerm), std::memory_order_relaxed);
+        }
+    }
+}
+
+void LevelMeter::publish() noexcept
+{
+    peakDb.store (toDecibels (peak), std::memory_order_relaxed);
+    rmsDb.store (toDecibels (std::sqrt (meanSquare)), std::memory_order_relaxed);
+    truePeakDb.store (toDecibels (truePeak), std::memory_order_relaxed);
+}
+
+LevelMeter::Levels LevelMeter::getLevels() const noexcept
+{
+    Levels levels;
+    levels.peakDb = peakDb.load (std::memory_order_relaxed);
+    levels.rmsDb = rmsDb.load (std::memory_order_relaxed);
+    levels.truePeakDb = truePeakDb.load (std::memory_order_relaxed);
+    levels.momentaryLufs = momentaryLufs.load (std::memory_order_relaxed);
+    levels.shortTermLufs = shortTermLufs.load (std::memory_order_relaxed);
+    return levels;
+}
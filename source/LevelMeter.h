@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "LoudnessAnalyser.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/** Live levels for one point in the graph: peak and RMS with meter
+    ballistics, true peak, and momentary and short-term loudness.
+
+    Everything is worked out on the audio thread once per block, so the cost
+    is fixed per block: a findMinAndMax and a sum of squares per channel, the
+    K-weighting filter with the channels in SIMD lanes, and the vectorised
+    4x true-peak interpolator. Loudness is kept as 100 ms steps of K-weighted
+    energy in a small ring, the same steps LoudnessAnalyser uses offline.
+
+    The results go out through atomics, so the UI polls getLevels() without
+    locking anything. Blocks are metered in fixed chunks with buffers
+    allocated up front, so nothing is ever resized under a running graph.
+*/
+class LevelMeter
+{
+public:
+    static constexpr int numChannels = 2;
+    static constexpr float minDb = -100.0f;
+
+    struct Levels
+    {
+        float peakDb = minDb;           // instant attack, 20 dB/s fall
+        float rmsDb = minDb;            // 300 ms integration
+        float truePeakDb = minDb;       // held for a second, then falls like the peak
+        float momentaryLufs = minDb;    // 400 ms
+        float shortTermLufs = minDb;    // 3 s
+    };
+
+    LevelMeter();
+
+    /** Any thread, including while blocks are being processed: the audio
+        thread picks up the new rate, and resets, at the start of its next block.
+    */
+    void prepare (double sampleRate) noexcept;
+
+    /** Audio thread. */
+    void process (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    /** Any thread. */
+    Levels getLevels() const noexcept;
+
+private:
+    void reset (double newSampleRate) noexcept;
+    void processChunk (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+    void publish() noexcept;
+
+    static constexpr int stepsPerMomentary = 4;
+    static constexpr int stepsPerShortTerm = 30;
+    static constexpr int chunkSize = 512;
+
+    std::atomic<double> requestedSampleRate { 0.0 };
+
+    // Audio thread only
+    double sampleRate = 0.0;
+    KWeightingFilter kWeighting;
+    TruePeakDetector truePeakDetector;
+    juce::AudioBuffer<float> filtered;
+
+    float peak = 0.0f, meanSquare = 0.0f, truePeak = 0.0f;
+    int truePeakHoldSamples = 0;
+
+    int samplesPerStep = 4410, stepFill = 0;
+    double stepEnergy = 0.0;
+    std::array<double, stepsPerShortTerm> steps {};
+    int nextStep = 0, numSteps = 0;
+
+    std::atomic<float> peakDb { minDb }, rmsDb { minDb }, truePeakDb { minDb };
+    std::atomic<float> momentaryLufs { minDb }, shortTermLufs { minDb };
+};
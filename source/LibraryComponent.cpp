@@ -9,66 +9,19 @@
 */
 
 #include "LibraryComponent.h"
-#include "minibpm.h"
+#include "BeatTracker.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace te = tracktion::engine;
 
 LibraryComponent::LibraryComponent(te::Engine& engineToUse)
     : engine(engineToUse)
 {
-    // Create or load the library project
-    auto projectFile = juce::File::getSpecialLocation(juce::File::userMusicDirectory)
-                        .getChildFile("ChopShop").getChildFile("Library.tracktion");
-    
-    // Create the directory if it doesn't exist
-    auto projectDir = juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("ChopShop");
-    bool dirCreated = projectDir.createDirectory();
-    DBG("Project directory creation result: " + juce::String(dirCreated ? "Success" : "Failed") + 
-        " Path: " + projectDir.getFullPathName());
-    
-    // Get or create the library project
-    libraryProject = engine.getProjectManager().getProject(projectFile);
-    if (libraryProject == nullptr || !libraryProject->isValid())
-    {
-        DBG("Attempting to create new project at: " + projectFile.getFullPathName());
-        libraryProject = engine.getProjectManager().createNewProject(projectFile);
-        if (libraryProject != nullptr)
-        {
-            libraryProject->createNewProjectId();
-            libraryProject->setName("ChopShop Library");
-            libraryProject->setDescription("Created: " + juce::Time::getCurrentTime().toString(true, false));
-            
-            if (libraryProject->save())
-            {
-                DBG("Created and saved new ChopShop Library project at: " + projectFile.getFullPathName());
-            }
-            else
-            {
-                DBG("Failed to save project!");
-            }
-        }
-        else
-        {
-            DBG("Failed to create new project!");
-        }
-    }
-    else
-    {
-        DBG("Loaded existing ChopShop Library project from: " + projectFile.getFullPathName());
-        DBG("Project contains " + juce::String(libraryProject->getNumProjectItems()) + " items");
-        
-        // Log the items in the project
-        for (int i = 0; i < libraryProject->getNumProjectItems(); ++i)
-        {
-            auto item = libraryProject->getProjectItemAt(i);
-            if (item != nullptr)
-            {
-                DBG("  Item " + juce::String(i) + ": " + item->getName() + 
-                    " (BPM: " + juce::String(item->getNamedProperty("bpm").getFloatValue(), 1) + 
-                    ", File: " + item->getSourceFile().getFileName() + ")");
-            }
-        }
-    }
+    // The library used to be a Tracktion project; bring it across the first time
+    if (store.wasCreated())
+        migrateFromProject();
     
     // Set up add file button
     addFileButton.setColour(juce::TextButton::buttonColourId, black);
@@ -94,6 +47,9 @@ LibraryComponent::LibraryComponent(te::Engine& engineToUse)
     playlistTable->setModel(this);
     playlistTable->getHeader().addColumn("Name", 1, 300);
     playlistTable->getHeader().addColumn("BPM", 2, 100);
+    playlistTable->getHeader().addColumn("LUFS", 3, 80);
+    playlistTable->getHeader().addColumn("Key", 4, 60);
+    playlistTable->getHeader().addColumn("Screwed", 5, 70);
     playlistTable->getHeader().setStretchToFitActive(true);
     playlistTable->setColour(juce::ListBox::backgroundColourId, black);
     playlistTable->setColour(juce::ListBox::outlineColourId, matrixGreen.withAlpha(0.5f));
@@ -143,7 +99,11 @@ LibraryComponent::LibraryComponent(te::Engine& engineToUse)
 
 LibraryComponent::~LibraryComponent()
 {
-    // No need to explicitly save as the Project class handles this
+    // Any analysis still running is abandoned; it'll be redone next time the file is added.
+    // The jobs only reach back to us through a SafePointer, so there's no need to wait.
+    analysisToken.cancel();
+
+    // The store writes out anything still queued when it's destroyed
 }
 
 void LibraryComponent::paint(juce::Graphics& g)
@@ -171,7 +131,7 @@ void LibraryComponent::resized()
 // TableListBoxModel implementations
 int LibraryComponent::getNumRows()
 {
-    return libraryProject ? libraryProject->getNumProjectItems() : 0;
+    return store.getNumEntries();
 }
 
 void LibraryComponent::paintRowBackground(juce::Graphics& g, int rowNumber, int width, int height, bool rowIsSelected)
@@ -182,29 +142,38 @@ void LibraryComponent::paintRowBackground(juce::Graphics& g, int rowNumber, int
 
 void LibraryComponent::paintCell(juce::Graphics& g, int rowNumber, int columnId, int width, int height, bool rowIsSelected)
 {
-    if (!libraryProject || rowNumber >= libraryProject->getNumProjectItems())
-        return;
-        
-    auto projectItem = libraryProject->getProjectItemAt(rowNumber);
-    if (projectItem == nullptr)
+    auto* entry = store.getEntry(rowNumber);
+    if (entry == nullptr)
         return;
         
     g.setColour(matrixGreen);
     
     if (columnId == 1) // Name column
-        g.drawText(projectItem->getName(), 2, 0, width - 4, height, juce::Justification::centredLeft);
+        g.drawText(entry->name, 2, 0, width - 4, height, juce::Justification::centredLeft);
     else if (columnId == 2) // BPM column
-        g.drawText(juce::String(projectItem->getNamedProperty("bpm").getFloatValue(), 1), 2, 0, width - 4, height, juce::Justification::centred);
+        g.drawText(juce::String(entry->getProperty("bpm").getFloatValue(), 1), 2, 0, width - 4, height, juce::Justification::centred);
+    else if (columnId == 3) // Loudness column, blank until the track has been analysed
+    {
+        auto lufs = entry->getProperty("lufs");
+        if (lufs.isNotEmpty())
+            g.drawText(juce::String(lufs.getDoubleValue(), 1), 2, 0, width - 4, height, juce::Justification::centred);
+    }
+    else if (columnId == 4 || columnId == 5) // Original key, and the key it sounds in at the current screw ratio
+    {
+        ChromaProfile chroma;
+        if (KeyDetector::chromaFromString(entry->getProperty("chroma"), chroma))
+        {
+            auto shift = columnId == 5 ? KeyDetector::getSemitoneShiftForRatio(playbackRatio) : 0.0;
+            g.drawText(KeyDetector::estimateKey(chroma, shift).getName(), 2, 0, width - 4, height, juce::Justification::centred);
+        }
+    }
 }
 
 void LibraryComponent::cellDoubleClicked(int rowNumber, int columnId, const juce::MouseEvent&)
 {
-    if (!libraryProject || rowNumber >= libraryProject->getNumProjectItems())
-        return;
-        
-    auto projectItem = libraryProject->getProjectItemAt(rowNumber);
-    if (projectItem != nullptr && onFileSelected) {
-        juce::File file(projectItem->getSourceFile());
+    auto* entry = store.getEntry(rowNumber);
+    if (entry != nullptr && onFileSelected) {
+        juce::File file(entry->file);
         if (file.exists())
             onFileSelected(file);
     }
@@ -212,21 +181,20 @@ void LibraryComponent::cellDoubleClicked(int rowNumber, int columnId, const juce
 
 void LibraryComponent::cellClicked(int rowNumber, int columnId, const juce::MouseEvent& event)
 {
-    if (event.mods.isRightButtonDown() && libraryProject && rowNumber < libraryProject->getNumProjectItems())
+    if (event.mods.isRightButtonDown())
     {
-        auto projectItem = libraryProject->getProjectItemAt(rowNumber);
-        if (projectItem == nullptr)
+        auto* entry = store.getEntry(rowNumber);
+        if (entry == nullptr)
             return;
             
         juce::PopupMenu menu;
         menu.addItem(1, "Show in Finder");
         menu.addItem(2, "Remove");
 
-        menu.showMenuAsync(juce::PopupMenu::Options(), [this, rowNumber, projectItem](int result)
+        menu.showMenuAsync(juce::PopupMenu::Options(), [this, rowNumber, file = entry->file](int result)
         {
             if (result == 1) // Show in Finder
             {
-                juce::File file(projectItem->getSourceFile());
                 if (file.exists())
                     file.revealToUser();
             }
@@ -245,42 +213,23 @@ void LibraryComponent::sortOrderChanged(int newSortColumnId, bool isForwards)
         sortedColumnId = newSortColumnId;
         sortedForward = isForwards;
         
-        // We can't directly sort the project items, so we'll need to reload the table
+        // The store keeps its own order, so just reload the table
         // after sorting is changed
         playlistTable->updateContent();
     }
 }
 
-void LibraryComponent::addToLibrary(const juce::File& file)
+void LibraryComponent::addToLibrary(const juce::File& file, TaskPriority priority, std::function<void()> onStored)
 {
     // Log the file we're trying to add
     DBG("Attempting to add file to library: " + file.getFullPathName());
     
-    if (!libraryProject)
-    {
-        DBG("ERROR: No library project available");
-        return;
-    }
-    
     if (!file.existsAsFile())
     {
         DBG("ERROR: File does not exist: " + file.getFullPathName());
         return;
     }
     
-    // Check if the project is valid and not read-only
-    if (!libraryProject->isValid())
-    {
-        DBG("ERROR: Library project is not valid");
-        return;
-    }
-    
-    if (libraryProject->isReadOnly())
-    {
-        DBG("ERROR: Library project is read-only");
-        return;
-    }
-    
     // Check if the file format is supported
     juce::AudioFormatManager formatManager;
     formatManager.registerBasicFormats();
@@ -309,229 +258,224 @@ void LibraryComponent::addToLibrary(const juce::File& file)
         return;
     }
     
-    // Calculate BPM
-    float detectedBPM = 120.0f; // Default BPM
+    // Decode and analyse off the message thread; the result comes back via storeAnalysis()
+    juce::Component::SafePointer<LibraryComponent> safeThis(this);
     
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    if (reader)
+    TaskScheduler::getInstance()->schedule([safeThis, file, priority, onStored, token = analysisToken]
     {
-        DBG("Successfully created audio reader for file: " + file.getFileName() + 
-            " (Sample rate: " + juce::String(reader->sampleRate) + 
-            ", Channels: " + juce::String(reader->numChannels) + 
-            ", Length: " + juce::String(reader->lengthInSamples) + " samples)");
+        auto analysis = TrackAnalyser::analyseFile(file, [token] { return token.isCancelled(); }, priority);
             
-        // Create MiniBPM detector
-        breakfastquay::MiniBPM bpmDetector(reader->sampleRate);
-        bpmDetector.setBPMRange(60, 180);  // typical range for music
-        
-        // Process audio in chunks
-        const int blockSize = 1024;
-        juce::AudioBuffer<float> buffer(1, blockSize);
-        std::vector<float> samples(blockSize);
-        
-        for (int pos = 0; pos < reader->lengthInSamples; pos += blockSize) 
+        if (!analysis)
         {
-            const int numSamples = std::min(blockSize, 
-                static_cast<int>(reader->lengthInSamples - pos));
-                
-            reader->read(&buffer, 0, numSamples, pos, true, false);
-            memcpy(samples.data(), buffer.getReadPointer(0), numSamples * sizeof(float));
-            
-            bpmDetector.process(samples.data(), numSamples);
+            DBG("ERROR: Failed to analyse file: " + file.getFileName());
+            return; // If we can't read the file, we shouldn't try to add it
         }
         
-        float tempBPM = bpmDetector.estimateTempo();
-        if (tempBPM > 0)
-        {
-            detectedBPM = tempBPM;
-            DBG("BPM detection successful: " + juce::String(detectedBPM, 1));
-        }
-        else
+        juce::MessageManager::callAsync([safeThis, file, onStored, result = *analysis]
         {
-            DBG("BPM detection failed, using default BPM: " + juce::String(detectedBPM, 1));
-        }
-    }
-    else
+            if (safeThis == nullptr)
+                return;
+
+            safeThis->storeAnalysis(file, result);
+
+            if (onStored)
+                onStored();
+        });
+    }, priority, analysisToken);
+}
+
+void LibraryComponent::storeAnalysis(const juce::File& file, const TrackAnalysis& analysis)
+{
+    const float detectedBPM = (float) analysis.bpm;
+
+    juce::StringPairArray properties;
+    properties.set("bpm", juce::String(detectedBPM));
+
+    // Silent files have no finite loudness; leave them unmeasured so they play at unity gain
+    if (std::isfinite(analysis.integratedLufs) && std::isfinite(analysis.truePeakDb))
     {
-        DBG("ERROR: Failed to create audio reader for file: " + file.getFileName());
-        return; // If we can't read the file, we shouldn't try to add it
+        properties.set("lufs", juce::String(analysis.integratedLufs, 2));
+        properties.set("truePeak", juce::String(analysis.truePeakDb, 2));
+        properties.set("lra", juce::String(analysis.loudnessRange, 2));
     }
     
+    if (analysis.hasCues)
+    {
+        properties.set("audioStart", juce::String(analysis.cues.audioStart, 3));
+        properties.set("audioEnd", juce::String(analysis.cues.audioEnd, 3));
+        properties.set("downbeat", juce::String(analysis.cues.firstDownbeat, 3));
+    }
+
+    // Keep the whole chroma profile so the key can be re-estimated at any screw ratio
+    if (*std::max_element(analysis.chroma.begin(), analysis.chroma.end()) > 0.0f)
+    {
+        properties.set("chroma", KeyDetector::chromaToString(analysis.chroma));
+        properties.set("key", KeyDetector::estimateKey(analysis.chroma).getName());
+    }
+
+    // The whole beat map, so loading can warp the track onto an even grid without re-analysing
+    if (!analysis.beats.empty())
+        properties.set("beats", BeatTracker::beatsToString(analysis.beats));
+
     // Check if the file is already in the library
-    auto existingItem = libraryProject->getProjectItemForFile(file);
-    if (existingItem != nullptr)
+    if (store.findEntry(file) != nullptr)
     {
-        DBG("File already exists in library: " + file.getFileName() + 
-            " (ID: " + existingItem->getID().toString() + ")");
+        DBG("File already exists in library: " + file.getFileName() + ", updating analysis");
             
-        // Update the BPM if needed
-        float existingBPM = existingItem->getNamedProperty("bpm").getFloatValue();
-        if (std::abs(existingBPM - detectedBPM) > 0.1f)
-        {
-            DBG("Updating BPM from " + juce::String(existingBPM, 1) + 
-                " to " + juce::String(detectedBPM, 1));
-                
-            existingItem->setNamedProperty("bpm", juce::String(detectedBPM));
-            libraryProject->save();
-            playlistTable->updateContent();
-        }
+        store.setProperties(file, properties);
+        playlistTable->updateContent();
+        playlistTable->repaint();
         return;
     }
     
-    // Log the file type we're creating
-    juce::String fileType = file.hasFileExtension("mid;midi") ? 
-        te::ProjectItem::midiItemType() : te::ProjectItem::waveItemType();
-    DBG("Creating project item with type: " + fileType);
+    store.add(file, file.getFileNameWithoutExtension(), properties);
+    playlistTable->updateContent();
     
-    // Create a new project item for the file
-    try
-    {
-        auto projectItem = libraryProject->createNewItem(
-            file,                                   // File to reference
-            fileType,                               // Type
-            file.getFileNameWithoutExtension(),     // Name
-            "",                                     // Description
-            te::ProjectItem::Category::imported,    // Category
-            true);                                  // Add at top of list
-        
-        // Store the BPM as a named property
-        if (projectItem != nullptr) 
-        {
-            DBG("Successfully created project item: " + projectItem->getID().toString());
-            
-            // Set the BPM property
-            projectItem->setNamedProperty("bpm", juce::String(detectedBPM));
-            
-            // Save the project
-            DBG("Saving project...");
-            libraryProject->save();
-            
-            // Update the table
-            playlistTable->updateContent();
-            
-            DBG("Added file to library: " + file.getFileName() + 
-                " (BPM: " + juce::String(detectedBPM, 1) + 
-                ", ID: " + projectItem->getID().toString() + ")");
-            DBG("Library now contains " + juce::String(libraryProject->getNumProjectItems()) + " items");
-        }
-        else 
-        {
-            DBG("ERROR: createNewItem returned nullptr for file: " + file.getFileName());
-            
-            // Try to get more information about why it failed
-                
-            // Check if the file can be opened for reading
-            std::unique_ptr<juce::FileInputStream> fileStream(file.createInputStream());
-            if (fileStream == nullptr || !fileStream->openedOk())
-            {
-                DBG("ERROR: Cannot open file for reading");
-            }
-            else
-            {
-                DBG("File can be opened for reading");
-            }
-        }
-    }
-    catch (const std::exception& e)
-    {
-        DBG("EXCEPTION while adding file to library: " + juce::String(e.what()));
-    }
-    catch (...)
-    {
-        DBG("UNKNOWN EXCEPTION while adding file to library");
-    }
+    DBG("Added file to library: " + file.getFileName() + 
+        " (BPM: " + juce::String(detectedBPM, 1) + ")");
+    DBG("Library now contains " + juce::String(store.getNumEntries()) + " items");
 }
 
 void LibraryComponent::removeFromLibrary(int index)
 {
-    if (!libraryProject || index < 0 || index >= libraryProject->getNumProjectItems())
+    auto* entry = store.getEntry(index);
+    if (entry == nullptr)
         return;
         
-    auto projectItem = libraryProject->getProjectItemAt(index);
-    auto projectItemID = libraryProject->getProjectItemID(index);
+    DBG("Removing item from library: " + entry->name);
     
-    if (projectItem != nullptr) {
-        DBG("Removing item from library: " + projectItem->getName() + 
-            " (ID: " + projectItemID.toString() + ")");
+    store.remove(entry->file); // the source material is left alone
+    playlistTable->updateContent();
+    
+    DBG("Library now contains " + juce::String(store.getNumEntries()) + " items");
+}
+
+void LibraryComponent::migrateFromProject()
+{
+    auto projectFile = LibraryStore::getDefaultDirectory().getChildFile("Library.tracktion");
+
+    if (!projectFile.existsAsFile())
+        return;
+
+    auto project = engine.getProjectManager().getProject(projectFile);
+
+    if (project == nullptr || !project->isValid())
+    {
+        DBG("Couldn't open the old library project at: " + projectFile.getFullPathName());
+        return;
     }
     
-    libraryProject->removeProjectItem(projectItemID, false); // false = don't delete source material
-    libraryProject->save();
-    playlistTable->updateContent();
+    // Everything storeAnalysis() has ever written
+    static const char* const keys[] = { "bpm", "lufs", "truePeak", "lra", "audioStart", "audioEnd",
+                                        "downbeat", "chroma", "key" };
     
-    DBG("Library now contains " + juce::String(libraryProject->getNumProjectItems()) + " items");
+    // The project lists newest first, and the store adds at the top, so go from the bottom up
+    for (int i = project->getNumProjectItems(); --i >= 0;)
+    {
+        auto item = project->getProjectItemAt(i);
+        if (item == nullptr)
+            continue;
+
+        juce::StringPairArray properties;
+
+        for (auto* key : keys)
+        {
+            auto value = item->getNamedProperty(key);
+            if (value.isNotEmpty())
+                properties.set(key, value);
+        }
+
+        store.add(item->getSourceFile(), item->getName(), properties);
+    }
+
+    store.flush();
+
+    // The project file is left where it is, as a backup
+    DBG("Migrated " + juce::String(store.getNumEntries()) + " items from " + projectFile.getFullPathName());
 }
 
 void LibraryComponent::loadLibrary()
 {
-    // The project is already loaded in the constructor
+    // The store is already loaded in the constructor
     playlistTable->updateContent();
     
     // Log the current state of the library
-    if (libraryProject) {
-        DBG("Library loaded with " + juce::String(libraryProject->getNumProjectItems()) + " items");
+    DBG("Library loaded with " + juce::String(store.getNumEntries()) + " items");
         
-        // Sort the items if needed
-        if (sortedColumnId != 0) {
-            DBG("Items are sorted by " + juce::String(sortedColumnId == 1 ? "Name" : "BPM") + 
-                (sortedForward ? " (ascending)" : " (descending)"));
-        }
+    // Sort the items if needed
+    if (sortedColumnId != 0) {
+        DBG("Items are sorted by " + juce::String(sortedColumnId == 1 ? "Name" : "BPM") + 
+            (sortedForward ? " (ascending)" : " (descending)"));
     }
 }
 
-te::ProjectItem::Ptr LibraryComponent::getProjectItemForFile(const juce::File& file) const
+void LibraryComponent::setPlaybackRatio(double newRatio)
 {
-    if (!libraryProject)
-    {
-        DBG("getProjectItemForFile: No library project available");
-        return nullptr;
-    }
+    if (std::abs(newRatio - playbackRatio) < 1.0e-6)
+        return;
         
-    auto projectItem = libraryProject->getProjectItemForFile(file);
-    
-    if (projectItem != nullptr)
-    {
-        DBG("Found project item for file: " + file.getFileName() + 
-            " (BPM: " + juce::String(projectItem->getNamedProperty("bpm").getFloatValue(), 1) + 
-            ", ID: " + projectItem->getID().toString() + ")");
-    }
-    else
-    {
-        DBG("No project item found for file: " + file.getFileName());
-    }
+    // Only the effective key column depends on this, and it's worked out from
+    // the stored chroma when painted, so a repaint is all that's needed
+    playbackRatio = newRatio;
+    playlistTable->repaint();
+}
     
-    return projectItem;
+std::optional<CuePoints> LibraryComponent::getCuePointsForFile(const juce::File& file) const
+{
+    auto* entry = store.findEntry(file);
+    if (entry == nullptr || entry->getProperty("audioEnd").isEmpty())
+        return std::nullopt;
+    
+    CuePoints cues;
+    cues.audioStart = entry->getProperty("audioStart").getDoubleValue();
+    cues.audioEnd = entry->getProperty("audioEnd").getDoubleValue();
+    cues.firstDownbeat = entry->getProperty("downbeat").getDoubleValue();
+    return cues;
+}
+
+std::vector<double> LibraryComponent::getBeatsForFile(const juce::File& file) const
+{
+    if (auto* entry = store.findEntry(file))
+        return BeatTracker::beatsFromString(entry->getProperty("beats"));
+
+    return {};
+}
+
+bool LibraryComponent::containsFile(const juce::File& file) const
+{
+    return store.findEntry(file) != nullptr;
+}
+
+float LibraryComponent::getNormalisationGainForFile(const juce::File& file) const
+{
+    auto* entry = store.findEntry(file);
+    if (entry == nullptr)
+        return 0.0f;
+
+    auto lufs = entry->getProperty("lufs");
+    if (lufs.isEmpty())
+        return 0.0f; // Added before loudness analysis existed
+
+    return TrackAnalyser::getNormalisationGainDb(lufs.getDoubleValue(),
+                                                 entry->getProperty("truePeak").getDoubleValue());
 }
 
 void LibraryComponent::showBpmEditorWindow(int rowIndex)
 {
     DBG("Opening BPM editor for row: " + juce::String(rowIndex));
     
-    if (!libraryProject)
-    {
-        DBG("ERROR: No library project available");
-        return;
-    }
-    
-    if (rowIndex < 0 || rowIndex >= libraryProject->getNumProjectItems())
+    auto* entry = store.getEntry(rowIndex);
+    if (entry == nullptr)
     {
         DBG("ERROR: Invalid row index: " + juce::String(rowIndex) + 
-            " (Project has " + juce::String(libraryProject->getNumProjectItems()) + " items)");
-        return;
-    }
-
-    auto projectItem = libraryProject->getProjectItemAt(rowIndex);
-    if (projectItem == nullptr)
-    {
-        DBG("ERROR: Failed to get project item at index: " + juce::String(rowIndex));
+            " (Library has " + juce::String(store.getNumEntries()) + " items)");
         return;
     }
     
-    DBG("Editing BPM for item: " + projectItem->getName() + 
-        " (ID: " + projectItem->getID().toString() + 
-        ", File: " + projectItem->getSourceFile().getFileName() + ")");
-        
-    float currentBpm = projectItem->getNamedProperty("bpm").getFloatValue();
+    DBG("Editing BPM for item: " + entry->name + 
+        " (File: " + entry->file.getFileName() + ")");
+
+    float currentBpm = entry->getProperty("bpm").getFloatValue();
     if (currentBpm <= 0)
     {
         currentBpm = 120.0f;
@@ -588,10 +532,10 @@ void LibraryComponent::showBpmEditorWindow(int rowIndex)
     okButton->setColour(juce::TextButton::textColourOffId, matrixGreen);
     okButton->setColour(juce::TextButton::textColourOnId, matrixGreen);
     
-    // Store a reference to the project item for the lambda
-    te::ProjectItem::Ptr itemRef = projectItem;
+    // The entry could be removed while the dialog is open, so look it up again by file
+    juce::File file = entry->file;
     
-    okButton->onClick = [this, itemRef, editor, currentBpm]() {
+    okButton->onClick = [this, file, editor, currentBpm]() {
         float newBpm = editor->getText().getFloatValue();
         
         if (newBpm <= 0)
@@ -600,34 +544,22 @@ void LibraryComponent::showBpmEditorWindow(int rowIndex)
             return;
         }
         
-        if (itemRef != nullptr) 
+        if (store.findEntry(file) != nullptr) 
         {
-            DBG("Updating BPM for item: " + itemRef->getName() + 
+            DBG("Updating BPM for item: " + file.getFileName() + 
                 " from " + juce::String(currentBpm, 1) + 
                 " to " + juce::String(newBpm, 1));
                 
-            try
-            {
-                itemRef->setNamedProperty("bpm", juce::String(newBpm));
+            juce::StringPairArray properties;
+            properties.set("bpm", juce::String(newBpm));
+            store.setProperties(file, properties);
                 
-                DBG("Saving project after BPM update...");
-                libraryProject->save();
-                
-                playlistTable->updateContent();
-                DBG("BPM updated successfully");
-            }
-            catch (const std::exception& e)
-            {
-                DBG("EXCEPTION while updating BPM: " + juce::String(e.what()));
-            }
-            catch (...)
-            {
-                DBG("UNKNOWN EXCEPTION while updating BPM");
-            }
+            playlistTable->updateContent();
+            DBG("BPM updated successfully");
         }
         else
         {
-            DBG("ERROR: Project item reference is null");
+            DBG("ERROR: Item is no longer in the library");
         }
         
         if (auto* dw = juce::Component::getCurrentlyModalComponent())
@@ -17,7 +17,10 @@
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <tracktion_engine/tracktion_engine.h>
 
-// We'll use ProjectItem instead of PlaylistEntry
+#include "TaskScheduler.h"
+#include "TrackAnalyser.h"
+#include "LibraryStore.h"
+
 class LibraryComponent : public juce::Component,
                         public juce::FileBrowserListener,
                         public juce::TableListBoxModel
@@ -46,20 +49,46 @@ public:
     std::function<void(const juce::File&)> onFileSelected;
 
     float getBPMForFile(const juce::File& file) const {
-        auto projectItem = getProjectItemForFile(file);
-        if (projectItem != nullptr)
-            return projectItem->getNamedProperty("bpm").getFloatValue();
+        if (auto* entry = store.findEntry(file))
+            return entry->getProperty("bpm").getFloatValue();
         return 120.0f;
     }
 
+    /** Clip gain in dB that normalises the file to the playback loudness target,
+        from the stored analysis. Returns 0 for files that haven't been measured.
+    */
+    float getNormalisationGainForFile(const juce::File& file) const;
+
+    /** Analyses the file in the background and adds it, or refreshes its
+        analysis if it's already in the library. Use interactive priority when
+        someone is waiting on the result, e.g. for the track being loaded.
+        onStored is called on the message thread once the analysis is in.
+    */
+    void addToLibrary(const juce::File& file, TaskPriority priority = TaskPriority::bulk,
+                      std::function<void()> onStored = {});
+
+    bool containsFile(const juce::File& file) const;
+
+    /** Silence and downbeat cues from the stored analysis, in seconds of the source file. */
+    std::optional<CuePoints> getCuePointsForFile(const juce::File& file) const;
+
+    /** Every beat from the stored analysis, in seconds of the source file.
+        Empty if the file hasn't been analysed or no beats were tracked.
+    */
+    std::vector<double> getBeatsForFile(const juce::File& file) const;
+
+    /** Tells the library how fast tracks are currently being played relative to
+        their original tempo, so it can show the key they'll be heard in.
+    */
+    void setPlaybackRatio(double newRatio);
+
 private:
-    void addToLibrary(const juce::File& file);
+    void storeAnalysis(const juce::File& file, const TrackAnalysis& analysis);
     void removeFromLibrary(int index);
     void loadLibrary();
+    void migrateFromProject();
     void showBpmEditorWindow(int rowIndex);
     
-    tracktion::engine::ProjectItem::Ptr getProjectItemForFile(const juce::File& file) const;
-    
     const juce::Colour matrixGreen { 0xFF00FF41 };  // Bright matrix green
     const juce::Colour darkWire { 0xFF003B00 };     // Dark green for backgrounds
     const juce::Colour black { 0xFF000000 };        // Pure black
@@ -71,10 +100,16 @@ private:
     std::unique_ptr<juce::TableListBox> playlistTable;
     
     tracktion::engine::Engine& engine;
-    tracktion::engine::Project::Ptr libraryProject;
+
+    // Every add, analysis and BPM edit is a single logged record, not a rewrite of the whole library
+    LibraryStore store { LibraryStore::getDefaultDirectory() };
     
     std::shared_ptr<juce::FileChooser> fileChooser;
     
+    CancellationToken analysisToken;
+    
+    double playbackRatio = 1.0;
+    
     int sortedColumnId = 0;  // 0 means unsorted
     bool sortedForward = true;
     
@@ -0,0 +1,391 @@
+#include "LibraryStore.h"
+#include "RecordFraming.h"
+
+#include <algorithm>
+
+namespace
+{
+    const juce::Identifier addType ("ADD"), setType ("SET"), removeType ("REMOVE");
+    const juce::Identifier libraryType ("LIBRARY"), trackType ("TRACK"), propertiesType ("PROPERTIES");
+    const juce::Identifier pathId ("path"), nameId ("name"), sequenceId ("seq");
+
+    constexpr int snapshotMagic = 0x424c5343;      // "CSLB"
+    constexpr int snapshotVersion = 1;
+    constexpr juce::uint32 maxRecordSize = 64 * 1024 * 1024;
+
+    juce::MemoryBlock frame (const juce::ValueTree& tree)
+    {
+        juce::MemoryOutputStream payload;
+        tree.writeToStream (payload);
+        return RecordFraming::frame (payload.getData(), payload.getDataSize());
+    }
+
+    /** Reads one framed tree, or returns an invalid one if what's there is torn or corrupt. */
+    juce::ValueTree readFrame (juce::InputStream& in)
+    {
+        auto payload = RecordFraming::read (in, maxRecordSize);
+
+        if (! payload)
+            return {};
+
+        return juce::ValueTree::readFromData (payload->getData(), payload->getSize());
+    }
+
+    juce::ValueTree toTree (const juce::StringPairArray& properties)
+    {
+        juce::ValueTree tree (propertiesType);
+
+        for (int i = 0; i < properties.size(); ++i)
+            tree.setProperty (properties.getAllKeys()[i], properties.getAllValues()[i], nullptr);
+
+        return tree;
+    }
+
+    void mergeInto (juce::StringPairArray& properties, const juce::ValueTree& tree)
+    {
+        for (int i = 0; i < tree.getNumProperties(); ++i)
+        {
+            const auto key = tree.getPropertyName (i);
+            properties.set (key.toString(), tree[key].toString());
+        }
+    }
+}
+
+//==============================================================================
+LibraryStore::LibraryStore (const juce::File& directory)
+    : juce::Thread ("ChopShop Library Writer"),
+      snapshotFile (directory.getChildFile ("Library.db")),
+      logFile (directory.getChildFile ("Library.wal"))
+{
+    directory.createDirectory();
+    load();
+    startThread (juce::Thread::Priority::low);
+}
+
+LibraryStore::~LibraryStore()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread (5000);
+
+    writePending();
+}
+
+juce::File LibraryStore::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::userMusicDirectory).getChildFile ("ChopShop");
+}
+
+//==============================================================================
+const LibraryStore::Entry* LibraryStore::getEntry (int index) const
+{
+    if (! juce::isPositiveAndBelow (index, getNumEntries()))
+        return nullptr;
+
+    return entries[entries.size() - 1 - (size_t) index].get();
+}
+
+const LibraryStore::Entry* LibraryStore::findEntry (const juce::File& file) const
+{
+    return find (file);
+}
+
+void LibraryStore::add (const juce::File& file, const juce::String& name, const juce::StringPairArray& properties)
+{
+    juce::ValueTree record (addType);
+    record.setProperty (pathId, file.getFullPathName(), nullptr);
+    record.setProperty (nameId, name, nullptr);
+    record.appendChild (toTree (properties), nullptr);
+    log (record);
+}
+
+void LibraryStore::setProperties (const juce::File& file, const juce::StringPairArray& properties)
+{
+    if (find (file) == nullptr)
+        return;
+
+    juce::ValueTree record (setType);
+    record.setProperty (pathId, file.getFullPathName(), nullptr);
+    record.appendChild (toTree (properties), nullptr);
+    log (record);
+}
+
+void LibraryStore::remove (const juce::File& file)
+{
+    if (find (file) == nullptr)
+        return;
+
+    juce::ValueTree record (removeType);
+    record.setProperty (pathId, file.getFullPathName(), nullptr);
+    log (record);
+}
+
+void LibraryStore::flush()
+{
+    writePending();
+}
+
+//==============================================================================
+LibraryStore::Entry* LibraryStore::find (const juce::File& file) const
+{
+    auto found = entriesByPath.find (file.getFullPathName());
+    return found != entriesByPath.end() ? found->second : nullptr;
+}
+
+LibraryStore::Entry& LibraryStore::insert (const juce::File& file, const juce::String& name)
+{
+    if (auto* existing = find (file))
+        return *existing;
+
+    auto entry = std::make_unique<Entry>();
+    entry->file = file;
+    entry->name = name;
+
+    auto& added = *entry;
+    entriesByPath[file.getFullPathName()] = entry.get();
+    entries.push_back (std::move (entry));
+    return added;
+}
+
+void LibraryStore::apply (const juce::ValueTree& record)
+{
+    const juce::File file (record[pathId].toString());
+
+    if (record.hasType (addType))
+    {
+        mergeInto (insert (file, record[nameId].toString()).properties, record.getChildWithName (propertiesType));
+    }
+    else if (record.hasType (setType))
+    {
+        if (auto* entry = find (file))
+            mergeInto (entry->properties, record.getChildWithName (propertiesType));
+    }
+    else if (record.hasType (removeType))
+    {
+        if (auto* entry = find (file))
+        {
+            entriesByPath.erase (file.getFullPathName());
+            entries.erase (std::find_if (entries.begin(), entries.end(),
+                                         [entry] (const auto& e) { return e.get() == entry; }));
+        }
+    }
+}
+
+void LibraryStore::log (const juce::ValueTree& record)
+{
+    const auto sequence = nextSequence++;
+
+    juce::ValueTree sequenced (record);
+    sequenced.setProperty (sequenceId, sequence, nullptr);
+    apply (sequenced);
+
+    Job job;
+    job.record = frame (sequenced);
+    job.sequence = sequence;
+
+    // Every so often, fold the log into a fresh snapshot. It's built here so it
+    // matches this point in the sequence exactly; the writer does the rest.
+    Job checkpoint;
+
+    if (++recordsSinceCheckpoint >= recordsPerCheckpoint)
+    {
+        checkpoint.snapshot = createSnapshot();
+        checkpoint.sequence = sequence;
+        recordsSinceCheckpoint = 0;
+    }
+
+    {
+        const juce::ScopedLock sl (pendingLock);
+        pending.push_back (std::move (job));
+
+        if (checkpoint.snapshot.isValid())
+            pending.push_back (std::move (checkpoint));
+    }
+
+    notify();
+}
+
+juce::ValueTree LibraryStore::createSnapshot() const
+{
+    juce::ValueTree library (libraryType);
+
+    for (const auto& entry : entries)
+    {
+        juce::ValueTree track (trackType);
+        track.setProperty (pathId, entry->file.getFullPathName(), nullptr);
+        track.setProperty (nameId, entry->name, nullptr);
+        track.appendChild (toTree (entry->properties), nullptr);
+        library.appendChild (track, nullptr);
+    }
+
+    return library;
+}
+
+//==============================================================================
+void LibraryStore::load()
+{
+    created = ! snapshotFile.existsAsFile() && ! logFile.existsAsFile();
+
+    if (! readSnapshot() && snapshotFile.existsAsFile())
+        DBG ("LibraryStore: couldn't read " + snapshotFile.getFullPathName() + ", rebuilding from the log");
+
+    replayLog();
+
+    DBG ("LibraryStore: opened with " + juce::String (getNumEntries()) + " entries");
+}
+
+bool LibraryStore::readSnapshot()
+{
+    juce::FileInputStream in (snapshotFile);
+
+    if (! in.openedOk() || in.readInt() != snapshotMagic || in.readInt() != snapshotVersion)
+        return false;
+
+    const auto sequence = in.readInt64();
+    auto library = readFrame (in);
+
+    if (! library.hasType (libraryType))
+        return false;
+
+    for (const auto& track : library)
+    {
+        juce::ValueTree record (addType);
+        record.copyPropertiesFrom (track, nullptr);
+        record.appendChild (track.getChildWithName (propertiesType).createCopy(), nullptr);
+        apply (record);
+    }
+
+    snapshotSequence = sequence;
+    nextSequence = sequence + 1;
+    return true;
+}
+
+void LibraryStore::replayLog()
+{
+    juce::int64 goodLength = 0;
+
+    {
+        juce::FileInputStream in (logFile);
+
+        if (! in.openedOk())
+            return;
+
+        while (! in.isExhausted())
+        {
+            auto record = readFrame (in);
+
+            if (! record.isValid())
+                break;
+
+            goodLength = in.getPosition();
+            const auto sequence = (juce::int64) record[sequenceId];
+
+            // Records already folded into the snapshot are still here if we
+            // stopped between writing it and emptying the log
+            if (sequence > snapshotSequence)
+            {
+                apply (record);
+                ++recordsSinceCheckpoint;
+            }
+
+            nextSequence = juce::jmax (nextSequence, sequence + 1);
+        }
+    }
+
+    // Drop a torn tail so new records don't land after it
+    if (goodLength < logFile.getSize())
+    {
+        DBG ("LibraryStore: dropping " + juce::String (logFile.getSize() - goodLength) + " bytes of torn log");
+
+        juce::FileOutputStream out (logFile);
+
+        if (out.openedOk())
+        {
+            out.setPosition (goodLength);
+            out.truncate();
+        }
+    }
+}
+
+//==============================================================================
+void LibraryStore::run()
+{
+    int timeoutMs = -1;
+
+    while (! threadShouldExit())
+    {
+        wait (timeoutMs);
+
+        // If the log couldn't be opened, keep trying until it can be
+        timeoutMs = writePending() ? -1 : retryIntervalMs;
+    }
+}
+
+bool LibraryStore::writePending()
+{
+    const juce::ScopedLock sl (writeLock);
+
+    std::vector<Job> jobs;
+
+    {
+        const juce::ScopedLock pl (pendingLock);
+        jobs.swap (pending);
+    }
+
+    if (jobs.empty())
+        return true;
+
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        auto& job = *it;
+
+        if (job.snapshot.isValid())
+        {
+            if (writeSnapshot (job.snapshot, job.sequence))
+            {
+                logStream.reset();
+                logFile.deleteFile();
+            }
+
+            continue;
+        }
+
+        if (logStream == nullptr)
+        {
+            logStream = std::make_unique<juce::FileOutputStream> (logFile);
+
+            if (! logStream->openedOk())
+            {
+                DBG ("LibraryStore: can't write " + logFile.getFullPathName() + ": " + logStream->getStatus().getErrorMessage());
+                logStream.reset();
+
+                // Put back what's left ahead of anything logged since, so the order holds
+                const juce::ScopedLock pl (pendingLock);
+                pending.insert (pending.begin(), std::make_move_iterator (it), std::make_move_iterator (jobs.end()));
+                return false;
+            }
+        }
+
+        logStream->write (job.record.getData(), job.record.getSize());
+    }
+
+    // Syncs to the disk as well as emptying the stream's buffer
+    if (logStream != nullptr)
+        logStream->flush();
+
+    return true;
+}
+
+bool LibraryStore::writeSnapshot (const juce::ValueTree& library, juce::int64 sequence)
+{
+    juce::MemoryOutputStream out;
+    out.writeInt (snapshotMagic);
+    out.writeInt (snapshotVersion);
+    out.writeInt64 (sequence);
+
+    const auto framed = frame (library);
+    out.write (framed.getData(), framed.getSize());
+
+    // A rename, so there's always a whole snapshot on disk
+    return RecordFraming::replaceAtomically (snapshotFile, out.getData(), out.getDataSize());
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_data_structures/juce_data_structures.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//==============================================================================
+/** The track library on disk: a snapshot plus a write-ahead log.
+
+    Everything lives in memory and is changed there straight away. Each change
+    is also turned into a small checksummed record and handed to a writer
+    thread, which appends it to Library.wal and syncs it, so adding a track or
+    editing a BPM costs the same however big the crate is, and never blocks on
+    the disk.
+
+    Every few thousand records the whole library is written to a new
+    Library.db next to the old one, swapped in by renaming, and the log is
+    emptied. Each record carries a sequence number, and the snapshot remembers
+    the last one it includes, so a crash at any point loses at most what was
+    still queued: a torn record at the end of the log fails its checksum and
+    is dropped when the library is next opened, along with anything after it.
+
+    All the public functions are for the message thread.
+*/
+class LibraryStore  : private juce::Thread
+{
+public:
+    struct Entry
+    {
+        juce::File file;
+        juce::String name;
+        juce::StringPairArray properties;
+
+        juce::String getProperty (const juce::String& key) const    { return properties[key]; }
+    };
+
+    /** Opens the library in the given directory, creating it if need be. */
+    explicit LibraryStore (const juce::File& directory);
+
+    /** Writes out anything still queued. */
+    ~LibraryStore() override;
+
+    /** Where ChopShop keeps its library: ~/Music/ChopShop. */
+    static juce::File getDefaultDirectory();
+
+    /** True if there was no library on disk when this one was opened. */
+    bool wasCreated() const noexcept                    { return created; }
+
+    //==============================================================================
+    /** Entries newest first, the order they're shown in. */
+    int getNumEntries() const noexcept                  { return (int) entries.size(); }
+    const Entry* getEntry (int index) const;
+    const Entry* findEntry (const juce::File&) const;
+
+    /** Adds a file at the top of the library. If it's already there, its
+        properties are merged with the new ones instead.
+    */
+    void add (const juce::File&, const juce::String& name, const juce::StringPairArray& properties);
+
+    /** Merges properties into a file's entry. Does nothing if it isn't in the library. */
+    void setProperties (const juce::File&, const juce::StringPairArray& properties);
+
+    void remove (const juce::File&);
+
+    /** Blocks until every change so far is on disk. If the log can't be
+        opened, the changes stay queued and the writer thread keeps retrying.
+    */
+    void flush();
+
+private:
+    struct Job
+    {
+        juce::MemoryBlock record;           // appended to the log
+        juce::ValueTree snapshot;           // or, if valid, written out as the new Library.db
+        juce::int64 sequence = 0;
+    };
+
+    static constexpr int recordsPerCheckpoint = 4096;
+    static constexpr int retryIntervalMs = 1000;      // between attempts at a log that won't open
+
+    void run() override;
+
+    void load();
+    bool readSnapshot();
+    void replayLog();
+    void apply (const juce::ValueTree& record);
+
+    void log (const juce::ValueTree& record);
+    juce::ValueTree createSnapshot() const;
+
+    /** Returns false if the log couldn't be opened, in which case the jobs
+        are back at the front of the queue for the next try.
+    */
+    bool writePending();
+    bool writeSnapshot (const juce::ValueTree&, juce::int64 sequence);
+
+    Entry* find (const juce::File&) const;
+    Entry& insert (const juce::File&, const juce::String& name);
+
+    const juce::File snapshotFile, logFile;
+    bool created = false;
+
+    // Oldest first, so adding is a push_back; getEntry() reads it backwards
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::unordered_map<juce::String, Entry*> entriesByPath;
+
+    juce::int64 nextSequence = 1;
+    juce::int64 snapshotSequence = 0;
+    int recordsSinceCheckpoint = 0;
+
+    juce::CriticalSection pendingLock;
+    std::vector<Job> pending;
+
+    juce::CriticalSection writeLock;
+    std::unique_ptr<juce::FileOutputStream> logStream;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryStore)
+};
@@ -0,0 +1,342 @@
+#include "LoudnessAnalyser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // ITU-R BS.1770-4 Annex 2, 48-tap interpolator split into its four phases
+    constexpr float truePeakCoefficients[TruePeakDetector::numPhases][TruePeakDetector::tapsPerPhase] =
+    {
+        {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+           0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+        { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+           0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+        { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+           0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+        { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+           0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+    };
+
+    constexpr double absoluteGateLufs = -70.0;
+    constexpr double integratedRelativeGateLu = -10.0;
+    constexpr double rangeRelativeGateLu = -20.0;
+    constexpr int stepsPerMomentaryBlock = 4;      // 400 ms
+    constexpr int stepsPerShortTermBlock = 30;     // 3 s
+}
+
+//==============================================================================
+void KWeightingFilter::prepare (double sampleRate)
+{
+    // Coefficients derived for any sample rate, matching the 48 kHz values in the spec
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow (10.0, gainDb / 20.0);
+        const double vb = std::pow (vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf.b0 = (float) ((vh + vb * k / q + k * k) / a0);
+        shelf.b1 = (float) (2.0 * (k * k - vh) / a0);
+        shelf.b2 = (float) ((vh - vb * k / q + k * k) / a0);
+        shelf.a1 = (float) (2.0 * (k * k - 1.0) / a0);
+        shelf.a2 = (float) ((1.0 - k / q + k * k) / a0);
+    }
+
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highPass.b0 = 1.0f;
+        highPass.b1 = -2.0f;
+        highPass.b2 = 1.0f;
+        highPass.a1 = (float) (2.0 * (k * k - 1.0) / a0);
+        highPass.a2 = (float) ((1.0 - k / q + k * k) / a0);
+    }
+
+    reset();
+}
+
+void KWeightingFilter::reset()
+{
+    std::fill (std::begin (shelfZ1), std::end (shelfZ1), 0.0f);
+    std::fill (std::begin (shelfZ2), std::end (shelfZ2), 0.0f);
+    std::fill (std::begin (highPassZ1), std::end (highPassZ1), 0.0f);
+    std::fill (std::begin (highPassZ2), std::end (highPassZ2), 0.0f);
+}
+
+void KWeightingFilter::process (const float* const* input, float* const* output, int numChannels, int numSamples) noexcept
+{
+    numChannels = juce::jmin (numChannels, maxChannels);
+
+    // Work through the block in small chunks transposed to channel-interleaved
+    // order so the per-sample update below operates on all lanes at once.
+    constexpr int chunkSize = 64;
+    alignas (16) float lanes[chunkSize][maxChannels];
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        const int num = juce::jmin (chunkSize, numSamples - offset);
+
+        for (int i = 0; i < num; ++i)
+            for (int ch = 0; ch < maxChannels; ++ch)
+                lanes[i][ch] = ch < numChannels ? input[ch][offset + i] : 0.0f;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto* x = lanes[i];
+
+            for (int ch = 0; ch < maxChannels; ++ch)
+            {
+                const float in = x[ch];
+                const float s = shelf.b0 * in + shelfZ1[ch];
+                shelfZ1[ch] = shelf.b1 * in - shelf.a1 * s + shelfZ2[ch];
+                shelfZ2[ch] = shelf.b2 * in - shelf.a2 * s;
+
+                const float h = highPass.b0 * s + highPassZ1[ch];
+                highPassZ1[ch] = highPass.b1 * s - highPass.a1 * h + highPassZ2[ch];
+                highPassZ2[ch] = highPass.b2 * s - highPass.a2 * h;
+
+                x[ch] = h;
+            }
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < num; ++i)
+                output[ch][offset + i] = lanes[i][ch];
+    }
+}
+
+//==============================================================================
+void TruePeakDetector::prepare (int numChannels, int maxBlockSize)
+{
+    maxBlock = maxBlockSize;
+    history.setSize (numChannels, tapsPerPhase - 1 + maxBlockSize);
+    phaseOutput.allocate ((size_t) maxBlockSize, true);
+    reset();
+}
+
+void TruePeakDetector::reset()
+{
+    history.clear();
+}
+
+float TruePeakDetector::process (int channel, const float* samples, int numSamples) noexcept
+{
+    jassert (numSamples <= maxBlock);
+    jassert (channel < history.getNumChannels());
+
+    constexpr int numHistory = tapsPerPhase - 1;
+    auto* hist = history.getWritePointer (channel);
+    juce::FloatVectorOperations::copy (hist + numHistory, samples, numSamples);
+
+    float peak = 0.0f;
+
+    for (int phase = 0; phase < numPhases; ++phase)
+    {
+        juce::FloatVectorOperations::clear (phaseOutput.get(), numSamples);
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            juce::FloatVectorOperations::addWithMultiply (phaseOutput.get(), hist + tap,
+                                                          truePeakCoefficients[phase][tap], numSamples);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax (phaseOutput.get(), numSamples);
+        peak = juce::jmax (peak, -range.getStart(), range.getEnd());
+    }
+
+    // Keep the tail of this block as history for the next one
+    std::memmove (hist, hist + numSamples, sizeof (float) * (size_t) numHistory);
+
+    return peak;
+}
+
+//==============================================================================
+void LoudnessAnalyser::prepare (double sampleRate, int numChannelsToUse, int maxBlockSize)
+{
+    numChannels = juce::jlimit (1, KWeightingFilter::maxChannels, numChannelsToUse);
+    samplesPerStep = juce::roundToInt (sampleRate / 10.0);
+
+    kWeighting.prepare (sampleRate);
+    truePeakDetector.prepare (numChannels, maxBlockSize);
+    filtered.setSize (numChannels, maxBlockSize);
+
+    reset();
+}
+
+void LoudnessAnalyser::reset()
+{
+    kWeighting.reset();
+    truePeakDetector.reset();
+    stepFill = 0;
+    stepEnergy = 0.0;
+    truePeak = 0.0f;
+    stepEnergies.clear();
+}
+
+void LoudnessAnalyser::process (const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const int channelsToUse = juce::jmin (numChannels, buffer.getNumChannels());
+
+    if (channelsToUse == 0 || numSamples <= 0)
+        return;
+
+    for (int ch = 0; ch < channelsToUse; ++ch)
+        truePeak = juce::jmax (truePeak, truePeakDetector.process (ch, buffer.getReadPointer (ch), numSamples));
+
+    kWeighting.process (buffer.getArrayOfReadPointers(), filtered.getArrayOfWritePointers(), channelsToUse, numSamples);
+
+    // Accumulate the K-weighted energy into 100 ms steps; the gating blocks
+    // are built from these steps when the results are requested.
+    int pos = 0;
+
+    while (pos < numSamples)
+    {
+        const int num = juce::jmin (samplesPerStep - stepFill, numSamples - pos);
+
+        for (int ch = 0; ch < channelsToUse; ++ch)
+        {
+            const auto* data = filtered.getReadPointer (ch, pos);
+            float sum = 0.0f;
+
+            for (int i = 0; i < num; ++i)
+                sum += data[i] * data[i];
+
+            stepEnergy += sum;
+        }
+
+        stepFill += num;
+        pos += num;
+
+        if (stepFill == samplesPerStep)
+        {
+            stepEnergies.push_back (stepEnergy / samplesPerStep);
+            stepEnergy = 0.0;
+            stepFill = 0;
+        }
+    }
+}
+
+double LoudnessAnalyser::energyToLoudness (double meanSquare) noexcept
+{
+    if (meanSquare <= 0.0)
+        return -std::numeric_limits<double>::infinity();
+
+    return -0.691 + 10.0 * std::log10 (meanSquare);
+}
+
+double LoudnessAnalyser::getIntegratedLoudness() const
+{
+    const int numSteps = (int) stepEnergies.size();
+    std::vector<double> blocks;
+
+    // 400 ms blocks with 75% overlap, i.e. one starting on every 100 ms step
+    for (int i = stepsPerMomentaryBlock - 1; i < numSteps; ++i)
+    {
+        double energy = 0.0;
+
+        for (int j = 0; j < stepsPerMomentaryBlock; ++j)
+            energy += stepEnergies[(size_t) (i - j)];
+
+        energy /= stepsPerMomentaryBlock;
+
+        if (energyToLoudness (energy) > absoluteGateLufs)
+            blocks.push_back (energy);
+    }
+
+    if (blocks.empty())
+        return -std::numeric_limits<double>::infinity();
+
+    double ungatedMean = 0.0;
+
+    for (auto e : blocks)
+        ungatedMean += e;
+
+    ungatedMean /= (double) blocks.size();
+
+    const double relativeGate = energyToLoudness (ungatedMean) + integratedRelativeGateLu;
+    double gatedSum = 0.0;
+    int numGated = 0;
+
+    for (auto e : blocks)
+    {
+        if (energyToLoudness (e) > relativeGate)
+        {
+            gatedSum += e;
+            ++numGated;
+        }
+    }
+
+    return numGated > 0 ? energyToLoudness (gatedSum / numGated)
+                        : -std::numeric_limits<double>::infinity();
+}
+
+double LoudnessAnalyser::getLoudnessRange() const
+{
+    const int numSteps = (int) stepEnergies.size();
+    std::vector<double> energies;
+
+    if (numSteps < stepsPerShortTermBlock)
+        return 0.0;
+
+    // Sliding 3 s window, advanced by one 100 ms step at a time
+    double window = 0.0;
+
+    for (int i = 0; i < numSteps; ++i)
+    {
+        window += stepEnergies[(size_t) i];
+
+        if (i >= stepsPerShortTermBlock)
+            window -= stepEnergies[(size_t) (i - stepsPerShortTermBlock)];
+
+        if (i >= stepsPerShortTermBlock - 1)
+        {
+            const double energy = window / stepsPerShortTermBlock;
+
+            if (energyToLoudness (energy) > absoluteGateLufs)
+                energies.push_back (energy);
+        }
+    }
+
+    if (energies.empty())
+        return 0.0;
+
+    double mean = 0.0;
+
+    for (auto e : energies)
+        mean += e;
+
+    mean /= (double) energies.size();
+
+    const double relativeGate = energyToLoudness (mean) + rangeRelativeGateLu;
+    std::vector<double> loudness;
+
+    for (auto e : energies)
+        if (const auto l = energyToLoudness (e); l > relativeGate)
+            loudness.push_back (l);
+
+    if (loudness.size() < 2)
+        return 0.0;
+
+    std::sort (loudness.begin(), loudness.end());
+
+    auto percentile = [&loudness] (double p)
+    {
+        const auto index = (size_t) std::round (p * (double) (loudness.size() - 1));
+        return loudness[index];
+    };
+
+    return percentile (0.95) - percentile (0.10);
+}
+
+double LoudnessAnalyser::getTruePeakDecibels() const
+{
+    return juce::Decibels::gainToDecibels ((double) truePeak, -std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <vector>
+
+//==============================================================================
+/** ITU-R BS.1770 K-weighting: the high-shelf "head" pre-filter followed by the
+    RLB high-pass.
+
+    Up to four channels are filtered in lockstep, one channel per lane, so the
+    recursive part of the filter vectorises across channels instead of being
+    stuck as a scalar loop per channel.
+*/
+class KWeightingFilter
+{
+public:
+    static constexpr int maxChannels = 4;
+
+    void prepare (double sampleRate);
+    void reset();
+
+    /** Filters numSamples of each channel. The output may alias the input. */
+    void process (const float* const* input, float* const* output, int numChannels, int numSamples) noexcept;
+
+private:
+    struct Coefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    Coefficients shelf, highPass;
+
+    // Transposed direct form II state, one lane per channel
+    alignas (16) float shelfZ1[maxChannels] {}, shelfZ2[maxChannels] {};
+    alignas (16) float highPassZ1[maxChannels] {}, highPassZ2[maxChannels] {};
+};
+
+//==============================================================================
+/** Estimates inter-sample (true) peaks with the 4x polyphase interpolator from
+    ITU-R BS.1770 Annex 2.
+
+    Each phase is applied across the whole block with FloatVectorOperations, so
+    the cost is 48 vectorised multiply-adds per block rather than per sample.
+*/
+class TruePeakDetector
+{
+public:
+    static constexpr int numPhases = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    void prepare (int numChannels, int maxBlockSize);
+    void reset();
+
+    /** Returns the largest absolute oversampled value seen in this block. */
+    float process (int channel, const float* samples, int numSamples) noexcept;
+
+private:
+    juce::AudioBuffer<float> history;   // (tapsPerPhase - 1) samples of history followed by the block
+    juce::HeapBlock<float> phaseOutput;
+    int maxBlock = 0;
+};
+
+//==============================================================================
+/** Offline programme loudness measurement: integrated loudness, loudness range
+    and true peak, as per EBU R128 / ITU-R BS.1770.
+
+    Feed it consecutive blocks with process(), then read the results. Only the
+    mean-square energy of each 100 ms step is kept, so memory grows by a few
+    bytes per second of audio.
+*/
+class LoudnessAnalyser
+{
+public:
+    void prepare (double sampleRate, int numChannels, int maxBlockSize);
+    void reset();
+
+    void process (const juce::AudioBuffer<float>& buffer, int numSamples);
+
+    /** Gated integrated loudness in LUFS, or -inf for silence. */
+    double getIntegratedLoudness() const;
+
+    /** Loudness range in LU (10th to 95th percentile of short-term loudness). */
+    double getLoudnessRange() const;
+
+    /** Maximum true peak in dBTP. */
+    double getTruePeakDecibels() const;
+
+    static double energyToLoudness (double meanSquare) noexcept;
+
+private:
+    KWeightingFilter kWeighting;
+    TruePeakDetector truePeakDetector;
+    juce::AudioBuffer<float> filtered;
+
+    int numChannels = 0;
+    int samplesPerStep = 4800;
+    int stepFill = 0;
+    double stepEnergy = 0.0;
+    float truePeak = 0.0f;
+
+    std::vector<double> stepEnergies;   // mean-square per 100 ms step, summed over channels
+};
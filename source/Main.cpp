@@ -13,6 +13,9 @@
 
 #include "MainComponent.h"
 #include "CustomLookAndFeel.h"
+#include "TaskScheduler.h"
+#include "RealtimeMode.h"
+#include "AudioTap.h"
 
 //==============================================================================
 class ChopShopApplication  : public juce::JUCEApplication
@@ -26,12 +29,15 @@ public:
     bool moreThanOneInstanceAllowed() override             { return true; }
 
     //==============================================================================
-    void initialise ([[maybe_unused]] const juce::String& commandLine) override
+    void initialise (const juce::String& commandLine) override
     {
         // This method is where you should put your application's initialisation code..
 
         Process::setPriority(Process::HighPriority);
 
+        // Before anything allocates, so locked memory covers the whole session
+        RealtimeMode::getInstance()->enable (RealtimeMode::Options::fromCommandLine (commandLine));
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -45,6 +51,13 @@ public:
         
         // Then destroy the window
         mainWindow = nullptr; // (deletes our window)
+
+        // Join the background workers while JUCE is still around
+        TaskScheduler::getInstance()->shutdown();
+        RealtimeMode::getInstance()->shutdown();
+
+        // Nothing reads or writes the taps now, so free them before the leak detectors go
+        AudioTapService::getInstance()->shutdown();
     }
 
     //==============================================================================
@@ -119,4 +132,7 @@ private:
 
 //==============================================================================
 // This macro generates the main() routine that launches the app.
+// Headless targets (tests, benchmarks) link the same code with their own main().
+#if ! CHOPSHOP_HEADLESS
 START_JUCE_APPLICATION (ChopShopApplication)
+#endif
@@ -1,5 +1,6 @@
 #include "MainComponent.h"
 #include "ChopComponent.h"
+#include "EditLayout.h"
 #include <algorithm>
 
 #define JUCE_USE_DIRECTWRITE 0 // Fix drawing of Monospace fonts in Code Editor!
@@ -19,14 +20,13 @@ MainComponent::MainComponent()
     controlBarComponent->onStopButtonClicked = [this] { stop(); };
 
     // Register our custom plugins with the engine
-    engine.getPluginManager().createBuiltInType<tracktion::engine::OscilloscopePlugin>();
-    engine.getPluginManager().createBuiltInType<FlangerPlugin>();
-    engine.getPluginManager().createBuiltInType<AutoDelayPlugin>();
-    engine.getPluginManager().createBuiltInType<AutoPhaserPlugin>();
+    EditLayout::registerPlugins (engine);
 
+    saveButton.onClick = [this] { showSessionMenu(); };
     addAndMakeVisible (saveButton);
     addAndMakeVisible (recordButton);
     addAndMakeVisible (audioSettingsButton);
+    addAndMakeVisible (autoBufferButton);
 
     customLookAndFeel = std::make_unique<CustomLookAndFeel>();
     // // setLookAndFeel(customLookAndFeel.get());
@@ -52,7 +52,7 @@ MainComponent::MainComponent()
     // setup effects
     recordButton.setToggleState (false, juce::NotificationType::dontSendNotification);
     recordButton.onClick = [this] {
-        if (edit.getTransport().isRecording())
+        if (auto recorder = getMasterRecorder(); recorder != nullptr && recorder->isRecording())
             stopRecording();
         else
             startRecording();
@@ -101,9 +101,26 @@ MainComponent::MainComponent()
         EngineHelpers::showAudioDeviceSettings (engine);
     };
 
+    autoBufferButton.onClick = [this] { autoTuneBufferSize(); };
+
+    bufferSizeTuner.onBufferSizeChanged = [this] (int bufferSize, const juce::String& reason) {
+        if (bufferSizeTuner.isTuning())
+            autoBufferButton.setButtonText ("Tuning: " + juce::String (bufferSize) + "...");
+        else
+            autoBufferButton.setButtonText ("Buffer " + juce::String (bufferSize) + " (" + reason + ")");
+
+        DBG ("Buffer size " + juce::String (bufferSize) + ": " + reason);
+    };
+
     gamepadManager = GamepadManager::getInstance();
     gamepadManager->addListener (this);
 
+    engine.getDeviceManager().deviceManager.addAudioCallback (&audioThreadPinner);
+
+    // Added after the engine's own callback, so commands land between rendered blocks
+    engine.getDeviceManager().deviceManager.addAudioCallback (&performanceBridge);
+    enableMidiInputs();
+
     // Add after reverbComponent initialization
     flangerComponent = std::make_unique<FlangerComponent> (edit);
     addAndMakeVisible (*flangerComponent);
@@ -124,57 +141,78 @@ MainComponent::MainComponent()
         handleFileSelection (file);
     };
 
-    // Initialize two tracks
-    if (auto track1 = EngineHelpers::getOrInsertAudioTrackAt (edit, 0))
+    // One track per deck; each deck's chop voices read its stretched clip back at their beat offsets
+    for (int i = 0; i < (int) decks.size(); ++i)
     {
-        EngineHelpers::removeAllClips (*track1);
-        volumeAndPan1 = dynamic_cast<te::VolumeAndPanPlugin*> (track1->pluginList.insertPlugin (te::VolumeAndPanPlugin::create(), 0).get());
-
-        // Add oscilloscope plugin to track 1
-        track1->pluginList.insertPlugin (te::OscilloscopePlugin::create(), -1);
+        decks[(size_t) i] = std::make_unique<Deck> (edit, i);
+        performanceBridge.setDeckTarget (i, decks[(size_t) i]->getChopVoices());
     }
 
-    if (auto track2 = EngineHelpers::getOrInsertAudioTrackAt (edit, 1))
-    {
-        EngineHelpers::removeAllClips (*track2);
-        volumeAndPan2 = dynamic_cast<te::VolumeAndPanPlugin*> (track2->pluginList.insertPlugin (te::VolumeAndPanPlugin::create(), 0).get());
-    }
+    deckComponent = std::make_unique<DeckComponent> (edit);
+    addAndMakeVisible (*deckComponent);
+
+    deckComponent->onLoadTargetChanged = [this] (int deck) {
+        selectedDeck = deck;
+
+        // The chop controls now play this deck
+        updateCrossfader();
+        updateChopLayers();
+    };
+
+    deckComponent->onDeckFaderChanged = [this] {
+        updateDeckFader();
+    };
+
+    deckComponent->onSendChanged = [this] (int deck, float amount) {
+        if (auto& d = decks[(size_t) deck])
+            d->setSend (amount);
+    };
+
+    updateDeckFader();
 
     createVinylBrakeComponent();
 
     startTimerHz (30); // Update 30 times per second
 
-    // Add oscilloscope to master track
+    // Tap the master output; the scope, and anything else that wants to watch
+    // it, subscribes to the tap by name
     if (auto masterTrack = edit.getMasterTrack())
+        masterTrack->pluginList.insertPlugin (tracktion::engine::TapPlugin::create (TapNames::master), -1);
+
+    oscilloscopeComponent = std::make_unique<ScopeView> (TapNames::master);
+
+    // Beat windows follow what the audio thread last played, counted from
+    // the master deck's bar lines
+    oscilloscopeComponent->setBeatClock ([this]
     {
-        DBG ("Found master track");
+        const auto& state = performanceBridge.getState();
+        const auto position = tracktion::TimePosition::fromSeconds (state.positionSeconds);
+        const auto& master = *decks[(size_t) masterDeck];
 
-        // Register our custom plugins with the engine
-        engine.getPluginManager().createBuiltInType<tracktion::engine::OscilloscopePlugin>();
+        ScopeSettings::BeatClock clock;
+        clock.beat = edit.tempoSequence.toBeats (position).inBeats() - master.getBarPhase().inBeats();
+        clock.bpm = edit.tempoSequence.getTempoAt (position).getBpm();
+        clock.isPlaying = state.isPlaying;
+        return clock;
+    });
+    addAndMakeVisible (*oscilloscopeComponent);
 
-        oscilloscopePlugin = masterTrack->pluginList.insertPlugin (tracktion::engine::OscilloscopePlugin::create(), -1);
-        if (oscilloscopePlugin != nullptr)
-        {
-            DBG ("Created oscilloscope plugin");
-            if (auto* oscPlugin = dynamic_cast<tracktion::engine::OscilloscopePlugin*> (oscilloscopePlugin.get()))
-            {
-                DBG ("Cast to oscilloscope plugin successful");
-                oscPlugin->addListener (this);
-            }
-        }
-    }
+    spectrumComponent = std::make_unique<SpectrumComponent> (TapNames::master);
+    addAndMakeVisible (*spectrumComponent);
 
-    // Add oscilloscope to visualizer box
-    if (oscilloscopeComponent != nullptr)
-        DBG ("Oscilloscope component added to visualizer box");
-    else
-        DBG ("Oscilloscope component not added to visualizer box");
+    meterBridge = std::make_unique<MeterBridgeComponent> (juce::StringArray { TapNames::deck (0), TapNames::deck (1),
+                                                                              TapNames::effectsOut, TapNames::master });
+    addAndMakeVisible (*meterBridge);
 
     // Add after other component setup
     chopComponent->onCrossfaderValueChanged = [this] ([[maybe_unused]] float value) {
         updateCrossfader();
     };
 
+    chopComponent->onLayersChanged = [this] {
+        updateChopLayers();
+    };
+
     screwComponent = std::make_unique<ScrewComponent> (edit);
     addAndMakeVisible (*screwComponent);
 
@@ -204,12 +242,44 @@ MainComponent::MainComponent()
     // };
     DBG("MainComponent: ScratchComponent callbacks set up");
 
-    // Create plugin rack after all effects are initialized
-    createPluginRack();
+    // Create the effect returns after all effects are initialized
+    createEffectReturns();
+    setUpScenes();
+
+    // Hot cues move the shared transport, so they sit on the master and jump every deck at once
+    if (auto masterTrack = edit.getMasterTrack())
+        hotCuePlugin = masterTrack->pluginList.insertPlugin (tracktion::engine::HotCuePlugin::create(), 0);
+
+    performanceBridge.setHotCueTarget (getHotCues());
+
+    thumbnail->getHotCuePositions = [this] {
+        std::vector<std::optional<tracktion::TimePosition>> positions;
+
+        if (auto hotCues = getHotCues())
+        {
+            for (int slot = 0; slot < tracktion::engine::HotCuePlugin::numCues; ++slot)
+            {
+                if (auto cue = hotCues->getCue (slot))
+                    positions.push_back (edit.tempoSequence.toTime (*cue));
+                else
+                    positions.push_back ({});
+            }
+        }
+
+        return positions;
+    };
+
+    // The recorder goes last on the master so it captures the effect returns too
+    if (auto masterTrack = edit.getMasterTrack())
+        masterRecorderPlugin = masterTrack->pluginList.insertPlugin (tracktion::engine::MasterRecorderPlugin::create(), -1);
 
     controllerMappingComponent = std::make_unique<ControllerMappingComponent>();
     addAndMakeVisible (*controllerMappingComponent);
 
+    // Autosaving starts with the first track, so an empty set at startup
+    // doesn't bury the last session in the journal
+    sessionStore.captureSnapshot = [this] { return captureSession(); };
+
     resized();
 }
 
@@ -253,8 +323,19 @@ void MainComponent::resized()
     // Row 1: Thumbnail and Oscilloscope (about 1/3 of height)
     juce::FlexBox visualizerBox;
     visualizerBox.flexDirection = juce::FlexBox::Direction::column;
+    juce::FlexBox scopeRow;
+    scopeRow.flexDirection = juce::FlexBox::Direction::row;
+
     if (oscilloscopeComponent != nullptr)
-        visualizerBox.items.add (juce::FlexItem (*oscilloscopeComponent).withFlex (0.6f).withMargin (5));
+        scopeRow.items.add (juce::FlexItem (*oscilloscopeComponent).withFlex (1.0f).withMargin (5));
+
+    if (spectrumComponent != nullptr)
+        scopeRow.items.add (juce::FlexItem (*spectrumComponent).withFlex (1.0f).withMargin (5));
+
+    if (meterBridge != nullptr)
+        scopeRow.items.add (juce::FlexItem (*meterBridge).withWidth (180).withMargin (5));
+
+    visualizerBox.items.add (juce::FlexItem (scopeRow).withFlex (0.6f));
 
     // Give the thumbnail more space for better visualization
     visualizerBox.items.add (juce::FlexItem (*thumbnail).withFlex (0.4f).withMargin (5));
@@ -274,11 +355,14 @@ void MainComponent::resized()
     column1.flexDirection = juce::FlexBox::Direction::column;
     column1.items.add (juce::FlexItem (*libraryComponent).withFlex (1.0f).withHeight (300).withMargin (5));
     column1.items.add (juce::FlexItem (audioSettingsButton).withHeight (30).withMargin (5));
+    column1.items.add (juce::FlexItem (autoBufferButton).withHeight (30).withMargin (5));
+    column1.items.add (juce::FlexItem (recordButton).withHeight (30).withMargin (5));
     column1.items.add (juce::FlexItem (*controllerMappingComponent).withHeight (30).withMargin (5));
 
     // Column 2 (Tempo and crossfader)
     juce::FlexBox column2;
     column2.flexDirection = juce::FlexBox::Direction::column;
+    column2.items.add (juce::FlexItem (*deckComponent).withFlex (0.25f).withMinHeight (150).withMargin (5));
     column2.items.add (juce::FlexItem (*screwComponent).withFlex (0.25f).withMinHeight (100).withMargin (5));
     column2.items.add (juce::FlexItem (*chopComponent).withFlex (0.5f).withMinHeight (200).withMargin (5));
     column2.items.add (juce::FlexItem (*scratchComponent).withFlex (0.25f).withMinHeight (100).withMargin (5));
@@ -306,6 +390,9 @@ void MainComponent::resized()
 
 void MainComponent::play()
 {
+    if (! edit.getTransport().isPlaying())
+        prepareForPlayback();
+
     EngineHelpers::togglePlay (edit);
 
     // Update button states based on transport state
@@ -315,13 +402,99 @@ void MainComponent::play()
     playState = isPlaying ? PlayState::Playing : PlayState::Stopped;
 }
 
+void MainComponent::prepareForPlayback()
+{
+    // Build the graph and initialise every plugin now, which allocates and
+    // clears the effects' delay lines, instead of on the first blocks
+    edit.getTransport().ensureContextAllocated();
+
+    // Then fault in the rings the audio thread is about to write
+    AudioTapService::getInstance()->prefault();
+}
+
+void MainComponent::autoTuneBufferSize()
+{
+    if (bufferSizeTuner.isTuning())
+    {
+        bufferSizeTuner.cancelAutoTune();
+        endTuningLoad();
+        autoBufferButton.setButtonText ("Auto Buffer Size");
+        return;
+    }
+
+    auto& master = *decks[(size_t) masterDeck];
+
+    if (! master.isLoaded())
+    {
+        autoBufferButton.setButtonText ("Load a track to tune");
+        return;
+    }
+
+    // The heaviest normal load: both decks stretching, every effect fully
+    // wet. An empty deck gets the master's track, nearly silent.
+    tuningDeck = -1;
+
+    for (int i = 0; i < (int) decks.size(); ++i)
+    {
+        if (i != masterDeck && ! decks[(size_t) i]->isLoaded())
+        {
+            decks[(size_t) i]->load (master.getFile(), master.getBpm(), master.getBarPhase(), 0.0, -60.0f);
+            tuningDeck = i;
+            break;
+        }
+    }
+
+    for (auto* effect : getEffectComponents())
+        if (effect != nullptr)
+            effect->storeAndSetMixLevel (1.0f);
+
+    wasPlayingBeforeTuning = edit.getTransport().isPlaying();
+
+    if (! wasPlayingBeforeTuning)
+        play();
+
+    autoBufferButton.setButtonText ("Tuning...");
+
+    bufferSizeTuner.startAutoTune ([this] (const BufferSizeTuner::Result& result) {
+        endTuningLoad();
+
+        autoBufferButton.setButtonText ("Buffer " + juce::String (result.bufferSize)
+                                        + (result.metTarget ? " (auto)" : " (overloaded)"));
+
+        // From here on, step up if the set gets heavier than the tuning run
+        bufferSizeTuner.setWatching (true);
+    });
+}
+
+std::array<BaseEffectComponent*, 4> MainComponent::getEffectComponents() const
+{
+    return { reverbComponent.get(), delayComponent.get(), flangerComponent.get(), phaserComponent.get() };
+}
+
+void MainComponent::endTuningLoad()
+{
+    if (! wasPlayingBeforeTuning && edit.getTransport().isPlaying())
+        play();
+
+    for (auto* effect : getEffectComponents())
+        if (effect != nullptr)
+            effect->restoreMixLevel();
+
+    if (tuningDeck >= 0)
+    {
+        decks[(size_t) tuningDeck]->unload();
+        tuningDeck = -1;
+    }
+}
+
 void MainComponent::stop()
 {
     EngineHelpers::togglePlay (edit, EngineHelpers::ReturnToStart::yes);
 
-    // Stop transport and reset position
+    // Stop transport and go back to the cue point
     edit.getTransport().stop (true, false);
-    edit.getTransport().setPosition (tracktion::TimePosition::fromSeconds (0.0));
+    edit.getTransport().setPosition (cueLoopBeats ? edit.getTransport().getLoopRange().getStart()
+                                                  : tracktion::TimePosition::fromSeconds (0.0));
 
     playState = PlayState::Stopped;
     controlBarComponent->setPlayButtonState (false);
@@ -335,7 +508,8 @@ void MainComponent::loadAudioFile()
     EngineHelpers::browseForAudioFile (engine, [this] (const juce::File& file) { handleFileSelection (file); });
 }
 
-void MainComponent::handleFileSelection (const juce::File& file)
+void MainComponent::handleFileSelection (const juce::File& file, bool autoPlay,
+                                         std::optional<tracktion::BeatPosition> alignedStart)
 {
     if (!file.existsAsFile())
         return;
@@ -345,52 +519,40 @@ void MainComponent::handleFileSelection (const juce::File& file)
     if (!audioFile.isValid())
         return;
 
-    tracktion::AudioTrack* track1 = EngineHelpers::getOrInsertAudioTrackAt (edit, 0);
-    tracktion::AudioTrack* track2 = EngineHelpers::getOrInsertAudioTrackAt (edit, 1);
+    // Files loaded straight from disk haven't been analysed yet; put them at
+    // the front of the queue so the BPM and loudness arrive for next time
+    if (!libraryComponent->containsFile (file))
+        libraryComponent->addToLibrary (file, TaskPriority::interactive);
 
-    if (!track1 || !track2)
-        return;
+    const float detectedBPM = libraryComponent->getBPMForFile (file);
+    const float normalisationGain = libraryComponent->getNormalisationGainForFile (file);
+    DBG ("Normalisation gain: " + juce::String (normalisationGain, 1) + " dB");
+
+    auto cues = libraryComponent->getCuePointsForFile (file);
+    const auto beats = libraryComponent->getBeatsForFile (file);
 
-    EngineHelpers::removeAllClips (*track1);
-    EngineHelpers::removeAllClips (*track2);
+    auto& deck = *decks[(size_t) selectedDeck];
 
-    // Load clip into first track
-    float detectedBPM = libraryComponent->getBPMForFile (file);
+    // With another deck already loaded, the new track follows its clock and
+    // bars, and the transport, loop and cues are left alone
+    for (int i = 0; i < (int) decks.size(); ++i)
+    {
+        if (i != selectedDeck && decks[(size_t) i]->isLoaded())
+        {
+            masterDeck = i;
+            loadBeatAligned (deck, file, detectedBPM, normalisationGain, cues, beats, alignedStart);
+            return;
+        }
+    }
+
+    masterDeck = selectedDeck;
     baseTempo = detectedBPM;
-    // Load clip into first track
-    tracktion::engine::WaveAudioClip::Ptr clip1 = track1->insertWaveClip (file.getFileNameWithoutExtension(), file, { { {}, tracktion::TimeDuration::fromSeconds (audioFile.getLength()) }, {} }, true);
-    clip1->setSyncType (te::Clip::syncBarsBeats);
-    clip1->setAutoPitch (false);
-    clip1->setTimeStretchMode (te::TimeStretcher::elastiquePro);
-    clip1->setUsesProxy (false);
-    clip1->setAutoTempo (true);
 
+    // The chop voice sits one beat behind
     trackOffset = (60.0 / baseTempo) * 1000.0;
 
     DBG ("Track offset: " + juce::String (trackOffset));
 
-    // Create clip2 with a positive offset instead of negative start time
-    tracktion::engine::WaveAudioClip::Ptr clip2 = track2->insertWaveClip (file.getFileNameWithoutExtension(), 
-                                                                          file, 
-                                                                          { { tracktion::TimePosition::fromSeconds (0.0), // Start at 0
-                                                                              tracktion::TimeDuration::fromSeconds (audioFile.getLength()) },
-                                                                            tracktion::TimeDuration::fromSeconds (trackOffset / 1000.0) }, // Use offset parameter
-                                                                          true);
-    clip2->setSyncType (te::Clip::syncBarsBeats);
-    clip2->setAutoPitch (false);
-    clip2->setTimeStretchMode (te::TimeStretcher::elastiquePro);
-    clip2->setUsesProxy (false);
-    clip2->setAutoTempo (true);
-    clip2->setGainDB (0.0f);
-
-    if (!clip1 || !clip2)
-        return;
-
-    DBG ("Setting BPM for clip 1: " + juce::String (baseTempo));
-    DBG ("Setting BPM for clip 2: " + juce::String (baseTempo));
-    clip1->getLoopInfo().setBpm (baseTempo, clip1->getAudioFile().getInfo());
-    clip2->getLoopInfo().setBpm (baseTempo, clip2->getAudioFile().getInfo());
-
     // Store current tempo ratio before updating base tempo
     const double currentRatio = screwComponent->getTempo() / baseTempo;
     screwComponent->setBaseTempo (baseTempo);
@@ -398,9 +560,15 @@ void MainComponent::handleFileSelection (const juce::File& file)
     const double newTempo = baseTempo * currentRatio;
     screwComponent->setTempo (newTempo, juce::dontSendNotification);
     // Initialize the tempo sequence with the base tempo
-    auto tempoSetting = edit.tempoSequence.insertTempo (tracktion::TimePosition::fromSeconds (0.0));
-    if (tempoSetting != nullptr)
-        tempoSetting->setBpm (baseTempo);
+    EngineHelpers::setTempo (edit, baseTempo);
+
+    // Load the clip at the start of the edit, at its own tempo; this also
+    // moves the cues onto the grid the clip is warped to
+    DBG ("Setting BPM for clip 1: " + juce::String (baseTempo));
+    auto clip1 = deck.loadAnalysed (file, baseTempo, normalisationGain, cues, beats, tracktion::BeatPosition(), false);
+
+    if (!clip1)
+        return;
 
     // Stop playback and reset transport
     edit.getTransport().stop (false, false);
@@ -422,42 +590,402 @@ void MainComponent::handleFileSelection (const juce::File& file)
 
     double ratio = screwComponent->getTempo() / baseTempo;
 
-    auto loopedClip = EngineHelpers::loopAroundClip (*clip1);
-    edit.getTransport().stop (false, false); // Stop playback after loop setup
+    // Loop the musically relevant part, from the first strong downbeat to the
+    // last whole bar before the trailing silence. The cues come from the
+    // library analysis, so nothing needs decoding here.
+    const double beatsPerSecond = baseTempo / 60.0;
+    double cueStart = 0.0, cueEnd = audioFile.getLength();
+
+    if (cues)
+    {
+        cueStart = cues->getStart();
+        cueEnd = juce::jmax (cueStart, cues->audioEnd);
+
+        if (cues->firstDownbeat >= 0.0)
+        {
+            const double numBars = std::floor ((cueEnd - cueStart) * beatsPerSecond / Deck::beatsPerBar);
+
+            if (numBars >= 1.0)
+                cueEnd = cueStart + numBars * Deck::beatsPerBar / beatsPerSecond;
+        }
+
+        DBG ("Cue region: " + juce::String (cueStart, 2) + "s to " + juce::String (cueEnd, 2) + "s");
+    }
+
+    cueLoopBeats = tracktion::BeatRange (tracktion::BeatPosition::fromBeats (cueStart * beatsPerSecond),
+                                         tracktion::BeatPosition::fromBeats (cueEnd * beatsPerSecond));
+
+    // Cues from the last track mean nothing here; start off with the first downbeat in slot 1
+    if (auto hotCues = getHotCues())
+    {
+        hotCues->clearAllCues();
+
+        if (cues && cues->firstDownbeat >= 0.0)
+            hotCues->setCue (0, cueLoopBeats->getStart());
+    }
 
     // Update the thumbnail with the new audio file
-    thumbnail->setFile (loopedClip->getPlaybackFile());
+    thumbnail->setFile (clip1->getPlaybackFile());
+    thumbnail->setSourceRange ({ cueStart, cueEnd });
     thumbnail->setSpeedRatio (ratio);
 
     // Reset crossfader to first track
     chopComponent->setCrossfaderValue (0.0);
     updateCrossfader();
+    updateChopLayers();
+    updateDeckInfo();
     updateButtonStates();
 
-    // Apply the current tempo to the clips
+    // Apply the current tempo to the clips, which also places the loop range
     updateTempo();
 
-    // Auto-play the newly loaded track
-    if (playState != PlayState::Playing)
+    sessionStore.startAutosaving();
+
+    // Auto-play the newly loaded track from its cue point
+    if (autoPlay && playState != PlayState::Playing)
     {
-        edit.getTransport().setPosition (tracktion::TimePosition::fromSeconds (0.0));
+        edit.getTransport().setPosition (edit.getTransport().getLoopRange().getStart());
         play();
     }
 }
 
+void MainComponent::loadBeatAligned (Deck& deck, const juce::File& file, double fileBpm, float gainDb,
+                                     std::optional<CuePoints> cues, const std::vector<double>& beats,
+                                     std::optional<tracktion::BeatPosition> startBeat)
+{
+    auto& master = *decks[(size_t) masterDeck];
+    auto& transport = edit.getTransport();
+
+    // Drop it on the master deck's next bar line, at least a beat away so the
+    // clip is in the graph before the playhead gets there. A restored session
+    // puts it back where it was instead.
+    if (! startBeat)
+    {
+        const double now = edit.tempoSequence.toBeats (transport.getPosition()).inBeats();
+        const double phase = master.getBarPhase().inBeats();
+        const double barLine = phase + std::ceil ((now + 1.0 - phase) / Deck::beatsPerBar) * Deck::beatsPerBar;
+        startBeat = tracktion::BeatPosition::fromBeats (juce::jmax (0.0, barLine));
+    }
+
+    // Start the new track from its first downbeat, or wherever the music starts
+    if (deck.loadAnalysed (file, fileBpm, gainDb, cues, beats, *startBeat, true) == nullptr)
+        return;
+
+    // The master's loop would keep the playhead from ever reaching the new track
+    transport.looping = false;
+
+    DBG ("Beat-aligned " + file.getFileName() + " at " + juce::String (fileBpm, 1)
+         + " BPM to bar beat " + juce::String (startBeat->inBeats(), 2));
+
+    updateCrossfader();
+    updateChopLayers();
+    updateDeckInfo();
+    updateButtonStates();
+}
+
+//==============================================================================
+void MainComponent::showSessionMenu()
+{
+    juce::PopupMenu menu;
+    menu.addItem (1, "Save Session...", isTrackLoaded());
+    menu.addItem (2, "Open Session...");
+    menu.addItem (3, "Restore Last Autosave", sessionStore.recoverAutosave().has_value());
+
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (saveButton), [this] (int result)
+    {
+        if (result == 1)
+        {
+            // What's playing when Save is clicked, not when the dialog closes
+            auto session = captureSession();
+            const auto& master = *decks[(size_t) masterDeck];
+            const auto name = master.isLoaded() ? master.getFile().getFileNameWithoutExtension() : juce::String ("Session");
+
+            sessionChooser = std::make_shared<juce::FileChooser> ("Save Session",
+                                                                  sessionStore.getDirectory().getChildFile (name + SessionStore::fileExtension),
+                                                                  juce::String ("*") + SessionStore::fileExtension);
+
+            sessionChooser->launchAsync (juce::FileBrowserComponent::saveMode
+                                          | juce::FileBrowserComponent::canSelectFiles
+                                          | juce::FileBrowserComponent::warnAboutOverwriting,
+                                         [this, session] (const juce::FileChooser& fc)
+                                         {
+                                             const auto file = fc.getResult();
+
+                                             if (file != juce::File())
+                                                 sessionStore.save (session, file.withFileExtension (SessionStore::fileExtension));
+                                         });
+        }
+        else if (result == 2)
+        {
+            sessionChooser = std::make_shared<juce::FileChooser> ("Open Session", sessionStore.getDirectory(),
+                                                                  juce::String ("*") + SessionStore::fileExtension);
+
+            sessionChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                         [this] (const juce::FileChooser& fc)
+                                         {
+                                             const auto file = fc.getResult();
+
+                                             if (file == juce::File())
+                                                 return;
+
+                                             if (auto session = SessionStore::load (file))
+                                                 restoreSession (*session);
+                                             else
+                                                 juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Open Session",
+                                                                                         file.getFileName() + " isn't a session this version can read.");
+                                         });
+        }
+        else if (result == 3)
+        {
+            if (auto session = sessionStore.recoverAutosave())
+                restoreSession (*session);
+        }
+    });
+}
+
+std::array<std::pair<const char*, BaseEffectComponent*>, 5> MainComponent::getSessionPanels() const
+{
+    return { { { "reverb", reverbComponent.get() },
+               { "delay", delayComponent.get() },
+               { "flanger", flangerComponent.get() },
+               { "phaser", phaserComponent.get() },
+               { "chop", chopComponent.get() } } };
+}
+
+const TrackFingerprint& MainComponent::getFingerprint (int deck)
+{
+    auto& cached = deckFingerprints[(size_t) deck];
+    const auto file = decks[(size_t) deck]->getFile();
+
+    if (cached.first != file)
+        cached = { file, TrackFingerprint::of (file) };
+
+    return cached.second;
+}
+
+SessionSnapshot MainComponent::captureSession()
+{
+    SessionSnapshot session;
+
+    for (int i = 0; i < (int) decks.size(); ++i)
+    {
+        const auto& deck = *decks[(size_t) i];
+        SessionSnapshot::DeckState state;
+
+        if (deck.isLoaded())
+        {
+            state.file = deck.getFile();
+            state.fingerprint = getFingerprint (i);
+            state.barPhase = deck.getBarPhase().inBeats();
+        }
+
+        state.send = deck.getSend();
+        session.decks.push_back (state);
+    }
+
+    session.selectedDeck = selectedDeck;
+    session.masterDeck = masterDeck;
+    session.deckFader = deckComponent->getDeckFaderPosition();
+    session.screwRatio = screwComponent->getTempo() / baseTempo;
+    session.positionSeconds = edit.getTransport().getPosition().inSeconds();
+
+    for (const auto& [name, panel] : getSessionPanels())
+        for (const auto& [id, value] : panel->getParameterValues())
+            session.parameters.push_back ({ name, id, value });
+
+    if (auto hotCues = getHotCues())
+    {
+        for (int slot = 0; slot < tracktion::engine::HotCuePlugin::numCues; ++slot)
+        {
+            if (auto cue = hotCues->getCue (slot))
+                session.hotCueBeats.push_back (cue->inBeats());
+            else
+                session.hotCueBeats.push_back (std::nullopt);
+        }
+    }
+
+    for (const auto& mapping : controllerMappingComponent->getMappings())
+        session.controllerMapping.push_back ({ mapping.buttonId, mapping.actionName, mapping.isAxis });
+
+    return session;
+}
+
+void MainComponent::restoreSession (const SessionSnapshot& session)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    ++restoreGeneration;
+
+    edit.getTransport().stop (false, false);
+
+    auto savedDeck = [&session] (int i) -> const SessionSnapshot::DeckState*
+    {
+        if (! juce::isPositiveAndBelow (i, (int) session.decks.size()) || session.decks[(size_t) i].file == juce::File())
+            return nullptr;
+
+        return &session.decks[(size_t) i];
+    };
+
+    // Only reload if the decks hold something else: the same tracks are
+    // already stretched and in the graph
+    bool sameTracks = true;
+
+    for (int i = 0; i < (int) decks.size(); ++i)
+    {
+        auto* saved = savedDeck (i);
+        const auto& deck = *decks[(size_t) i];
+
+        if (saved != nullptr ? (! deck.isLoaded() || deck.getFile() != saved->file) : deck.isLoaded())
+            sameTracks = false;
+    }
+
+    if (! sameTracks)
+    {
+        for (auto& deck : decks)
+            deck->unload();
+
+        // The master first, so the others line up with its bars as they did
+        const int master = juce::jlimit (0, (int) decks.size() - 1, session.masterDeck);
+        std::vector<int> loadOrder { master };
+
+        for (int i = 0; i < (int) decks.size(); ++i)
+            if (i != master)
+                loadOrder.push_back (i);
+
+        for (auto i : loadOrder)
+        {
+            auto* saved = savedDeck (i);
+
+            if (saved == nullptr || ! saved->file.existsAsFile())
+            {
+                if (saved != nullptr)
+                    DBG ("Session: " + saved->file.getFullPathName() + " is missing");
+
+                continue;
+            }
+
+            // The BPM, loudness and cues come from the library, and the
+            // stretched audio and peaks from their caches, so nothing is
+            // decoded here unless the file itself has changed. If it has, the
+            // library's BPM, cues and beats are for the old file, so the deck
+            // is loaded once the fresh analysis is in instead.
+            if (TrackFingerprint::of (saved->file) != saved->fingerprint)
+            {
+                DBG ("Session: " + saved->file.getFileName() + " has changed since it was saved, re-analysing");
+
+                libraryComponent->addToLibrary (saved->file, TaskPriority::interactive,
+                                                [this, generation = restoreGeneration, i, file = saved->file, barPhase = saved->barPhase]
+                {
+                    // Unless another session has been restored, or the deck loaded by hand, since
+                    if (generation == restoreGeneration && ! decks[(size_t) i]->isLoaded())
+                        loadRestoredDeck (i, file, barPhase);
+                });
+
+                continue;
+            }
+
+            selectedDeck = i;
+            handleFileSelection (saved->file, false, tracktion::BeatPosition::fromBeats (saved->barPhase));
+        }
+
+        updateDeckInfo();
+    }
+
+    deckComponent->setLoadTarget (juce::jlimit (0, (int) decks.size() - 1, session.selectedDeck));
+    selectedDeck = deckComponent->getLoadTarget();
+    deckComponent->setDeckFaderPosition (session.deckFader);
+
+    for (int i = 0; i < (int) decks.size() && i < (int) session.decks.size(); ++i)
+        deckComponent->setSend (i, session.decks[(size_t) i].send);
+
+    screwComponent->setTempo (baseTempo * session.screwRatio, juce::dontSendNotification);
+    updateTempo();
+
+    for (const auto& parameter : session.parameters)
+        for (const auto& [name, panel] : getSessionPanels())
+            if (parameter.panel == name)
+                panel->setParameterValue (parameter.id, parameter.value);
+
+    if (auto hotCues = getHotCues())
+    {
+        hotCues->clearAllCues();
+
+        for (int slot = 0; slot < (int) session.hotCueBeats.size() && slot < tracktion::engine::HotCuePlugin::numCues; ++slot)
+            if (auto beat = session.hotCueBeats[(size_t) slot])
+                hotCues->setCue (slot, tracktion::BeatPosition::fromBeats (*beat));
+    }
+
+    if (! session.controllerMapping.empty())
+    {
+        std::vector<ControllerMappingComponent::ControllerMapping> mappings;
+
+        for (const auto& binding : session.controllerMapping)
+            mappings.push_back ({ binding.control, binding.action, binding.isAxis });
+
+        controllerMappingComponent->setMappings (std::move (mappings));
+    }
+
+    edit.getTransport().setPosition (tracktion::TimePosition::fromSeconds (session.positionSeconds));
+    playState = PlayState::Stopped;
+    controlBarComponent->setPlayButtonState (false);
+    controlBarComponent->setStopButtonState (true);
+
+    updateCrossfader();
+    updateChopLayers();
+    updateButtonStates();
+
+    if (isTrackLoaded())
+        sessionStore.startAutosaving();
+
+    const auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+    DBG ("Session restored in " + juce::String (elapsedMs, 1) + " ms");
+
+    // Reloading should come out of the caches; if not, something's being decoded
+    if (elapsedMs > 200.0)
+        DBG ("Session: restore took longer than 200 ms, check the stretch and peak caches are being hit");
+}
+
+void MainComponent::loadRestoredDeck (int deck, const juce::File& file, double barPhase)
+{
+    // Into its own deck, without moving the load target the session put back
+    const int target = selectedDeck;
+    selectedDeck = deck;
+    handleFileSelection (file, false, tracktion::BeatPosition::fromBeats (barPhase));
+    selectedDeck = target;
+
+    updateDeckInfo();
+    updateCrossfader();
+    updateChopLayers();
+    updateButtonStates();
+
+    if (isTrackLoaded())
+        sessionStore.startAutosaving();
+}
+
+void MainComponent::applyCueLoopRange()
+{
+    // The cues are held in beats so the loop stays on the same bars when the tempo changes
+    if (!cueLoopBeats)
+        return;
+
+    auto& ts = edit.tempoSequence;
+    edit.getTransport().setLoopRange ({ ts.toTime (cueLoopBeats->getStart()), ts.toTime (cueLoopBeats->getEnd()) });
+}
+
 void MainComponent::updateTempo()
 {
     // Calculate the new BPM based on the current tempo from the screw component
     double newBpm = screwComponent->getTempo();
 
-    // Insert tempo change at the beginning of the track
-    auto tempoSetting = edit.tempoSequence.insertTempo (tracktion::TimePosition::fromSeconds (0.0));
-    if (tempoSetting != nullptr)
-        tempoSetting->setBpm (newBpm);
+    // Move the one tempo at the start of the edit
+    EngineHelpers::setTempo (edit, newBpm);
 
     // Calculate ratio for thumbnail display
     const double ratio = baseTempo / newBpm;
 
+    // Screwing also shifts pitch, so the library's effective key follows the tempo
+    if (libraryComponent)
+        libraryComponent->setPlaybackRatio (newBpm / baseTempo);
+
     // Update the thumbnail to reflect the speed ratio
     if (thumbnail)
     {
@@ -469,6 +997,15 @@ void MainComponent::updateTempo()
     {
         delayComponent->setTempo (newBpm);
     }
+
+    if (auto hotCues = getHotCues())
+        hotCues->syncToTempoSequence();
+
+    for (auto& deck : decks)
+        if (deck != nullptr)
+            deck->syncToTempoSequence();
+
+    applyCueLoopRange();
 }
 
 te::WaveAudioClip::Ptr MainComponent::getClip (int trackIndex)
@@ -483,57 +1020,106 @@ te::WaveAudioClip::Ptr MainComponent::getClip (int trackIndex)
 void MainComponent::updateCrossfader()
 {
     const float position = chopComponent->getCrossfaderValue();
-    const float minDB = -60.0f; // Effectively silent
+    const float silence = juce::Decibels::decibelsToGain (-60.0f); // Effectively silent
 
     // Calculate volume curves that give equal power at center position
-    float gainTrack1 = std::cos (position * juce::MathConstants<float>::halfPi);
-    float gainTrack2 = std::sin (position * juce::MathConstants<float>::halfPi);
+    float gainVoice1 = std::cos (position * juce::MathConstants<float>::halfPi);
+    float gainVoice2 = std::sin (position * juce::MathConstants<float>::halfPi);
+
+    // The crossfader chops between the live voice and the one a beat behind;
+    // a voice that's fully off is skipped by the mixer
+    using Type = PerformanceCommand::Type;
+    performanceBridge.post ({ Type::chopVoiceGain, selectedDeck, 0, gainVoice1 < silence ? 0.0 : gainVoice1 });
+    performanceBridge.post ({ Type::chopVoiceGain, selectedDeck, 1, gainVoice2 < silence ? 0.0 : gainVoice2 });
+}
+
+void MainComponent::updateChopLayers()
+{
+    using Type = PerformanceCommand::Type;
 
-    // Convert linear gains to dB
-    float gainDB1 = gainTrack1 <= 0.0f ? minDB : juce::Decibels::gainToDecibels (gainTrack1);
-    float gainDB2 = gainTrack2 <= 0.0f ? minDB : juce::Decibels::gainToDecibels (gainTrack2);
+    // Layers take the voices after the crossfader pair
+    for (int layer = 0; layer < ChopComponent::numLayers; ++layer)
+    {
+        const int voice = 2 + layer;
+        const double offset = chopComponent->getLayerOffsetInBeats (layer);
 
-    // Apply volumes to tracks
-    setTrackVolume (0, gainDB1);
-    setTrackVolume (1, gainDB2);
+        performanceBridge.post ({ Type::chopVoiceOffset, selectedDeck, voice, offset });
+        performanceBridge.post ({ Type::chopVoiceGain, selectedDeck, voice, offset > 0.0 ? chopComponent->getLayerLevel() : 0.0 });
+    }
 }
 
-void MainComponent::setTrackVolume (int trackIndex, float gainDB)
+void MainComponent::updateDeckFader()
 {
-    if (trackIndex == 0 && volumeAndPan1)
-        volumeAndPan1->setVolumeDb (gainDB);
-    else if (trackIndex == 1 && volumeAndPan2)
-        volumeAndPan2->setVolumeDb (gainDB);
+    for (int i = 0; i < (int) decks.size(); ++i)
+        performanceBridge.post ({ PerformanceCommand::Type::deckLevel, i, 0, deckComponent->getDeckGain (i) });
 }
 
-void MainComponent::armTrack (int trackIndex, bool arm)
+void MainComponent::updateDeckInfo()
 {
-    if (auto track = EngineHelpers::getOrInsertAudioTrackAt (edit, trackIndex))
+    for (int i = 0; i < (int) decks.size(); ++i)
     {
-        EngineHelpers::armTrack (*track, arm);
+        const auto& deck = decks[(size_t) i];
+        const bool loaded = deck != nullptr && deck->isLoaded();
+
+        deckComponent->setDeckInfo (i, loaded ? deck->getFile().getFileNameWithoutExtension() : juce::String(),
+                                    loaded && i == masterDeck);
     }
 }
 
+tracktion::engine::MasterRecorderPlugin* MainComponent::getMasterRecorder() const
+{
+    return dynamic_cast<tracktion::engine::MasterRecorderPlugin*> (masterRecorderPlugin.get());
+}
+
 void MainComponent::startRecording()
 {
-    // Arm the first track for recording
-    armTrack (0, true);
+    auto recorder = getMasterRecorder();
+
+    if (recorder == nullptr)
+        return;
 
-    // Start transport recording
-    edit.getTransport().record (false);
+    auto recordingsDir = juce::File::getSpecialLocation (juce::File::userMusicDirectory)
+                             .getChildFile ("ChopShop").getChildFile ("Recordings");
+    auto file = recordingsDir.getNonexistentChildFile ("ChopShop " + juce::Time::getCurrentTime().formatted ("%Y-%m-%d %H-%M-%S"), ".wav");
+
+    if (! recorder->startRecording (file))
+        return;
 
     recordButton.setToggleState (true, juce::NotificationType::dontSendNotification);
+    updateRecordButton();
 }
 
 void MainComponent::stopRecording()
 {
-    // Stop recording
-    edit.getTransport().stop (false, false);
+    if (auto recorder = getMasterRecorder())
+    {
+        recorder->stopRecording();
 
-    // Disarm track
-    armTrack (0, false);
+        if (recorder->getNumUnderruns() > 0)
+            DBG ("Recording had " + juce::String (recorder->getNumUnderruns()) + " underruns: " + recorder->getCurrentFile().getFullPathName());
+    }
 
     recordButton.setToggleState (false, juce::NotificationType::dontSendNotification);
+    updateRecordButton();
+}
+
+void MainComponent::updateRecordButton()
+{
+    auto recorder = getMasterRecorder();
+
+    if (recorder == nullptr || ! recorder->isRecording())
+    {
+        recordButton.setButtonText ("Record");
+        return;
+    }
+
+    const auto seconds = (double) recorder->getNumSamplesWritten() / recorder->getRecordingSampleRate();
+    juce::String text ("Rec " + PlayHeadHelpers::timeToTimecodeString (seconds).dropLastCharacters (4));
+
+    if (const int underruns = recorder->getNumUnderruns(); underruns > 0)
+        text << " (" << underruns << " dropped)";
+
+    recordButton.setButtonText (text);
 }
 
 bool MainComponent::isTempoPercentageActive (double percentage) const
@@ -546,6 +1132,9 @@ bool MainComponent::isTempoPercentageActive (double percentage) const
 
 void MainComponent::gamepadButtonPressed (int buttonId)
 {
+    if (handleHotCueGamepadButton (buttonId, true))
+        return;
+
     float currentPosition;
     switch (buttonId)
     {
@@ -577,6 +1166,9 @@ void MainComponent::gamepadButtonPressed (int buttonId)
 
 void MainComponent::gamepadButtonReleased (int buttonId)
 {
+    if (handleHotCueGamepadButton (buttonId, false))
+        return;
+
     switch (buttonId)
     {
         case SDL_GAMEPAD_BUTTON_SOUTH: // Cross
@@ -701,10 +1293,310 @@ void MainComponent::gamepadAxisMoved (int axisId, float value)
     }
 }
 
+tracktion::engine::HotCuePlugin* MainComponent::getHotCues() const
+{
+    return dynamic_cast<tracktion::engine::HotCuePlugin*> (hotCuePlugin.get());
+}
+
+void MainComponent::triggerHotCue (int slot)
+{
+    performanceBridge.post ({ PerformanceCommand::Type::triggerHotCue, 0, slot, 0.0 });
+}
+
+void MainComponent::startLoopRoll (double lengthInBeats)
+{
+    performanceBridge.post ({ PerformanceCommand::Type::startLoopRoll, 0, 0, lengthInBeats });
+}
+
+void MainComponent::stopLoopRoll()
+{
+    performanceBridge.post ({ PerformanceCommand::Type::stopLoopRoll, 0, 0, 0.0 });
+}
+
+bool MainComponent::handleHotCueGamepadButton (int buttonId, bool isDown)
+{
+    if (buttonId == SDL_GAMEPAD_BUTTON_BACK)
+    {
+        hotCueLayerHeld = isDown;
+        return true;
+    }
+
+    auto hotCues = getHotCues();
+
+    if (hotCues == nullptr)
+        return false;
+
+    if (hotCueLayerHeld)
+    {
+        static constexpr int cueButtons[] = { SDL_GAMEPAD_BUTTON_SOUTH, SDL_GAMEPAD_BUTTON_EAST,
+                                              SDL_GAMEPAD_BUTTON_WEST, SDL_GAMEPAD_BUTTON_NORTH,
+                                              SDL_GAMEPAD_BUTTON_DPAD_UP, SDL_GAMEPAD_BUTTON_DPAD_RIGHT,
+                                              SDL_GAMEPAD_BUTTON_DPAD_DOWN, SDL_GAMEPAD_BUTTON_DPAD_LEFT };
+
+        for (int slot = 0; slot < (int) std::size (cueButtons); ++slot)
+        {
+            if (buttonId == cueButtons[slot])
+            {
+                if (isDown)
+                    triggerHotCue (slot);
+
+                return true;
+            }
+        }
+    }
+
+    double rollLength = 0.0;
+
+    if (buttonId == SDL_GAMEPAD_BUTTON_DPAD_LEFT)
+        rollLength = 1.0;
+    else if (buttonId == SDL_GAMEPAD_BUTTON_LEFT_STICK)
+        rollLength = 0.5;
+    else
+        return false;
+
+    if (isDown)
+        startLoopRoll (rollLength);
+    else
+        stopLoopRoll();
+
+    return true;
+}
+
+void MainComponent::enableMidiInputs()
+{
+    auto& deviceManager = engine.getDeviceManager().deviceManager;
+
+    for (const auto& device : juce::MidiInput::getAvailableDevices())
+        deviceManager.setMidiInputDeviceEnabled (device.identifier, true);
+
+    // An empty identifier means every enabled input
+    deviceManager.addMidiInputDeviceCallback ({}, this);
+}
+
+void MainComponent::handleIncomingMidiMessage (juce::MidiInput*, const juce::MidiMessage& message)
+{
+    // Controller input should be as punctual as the audio it drives
+    thread_local bool askedForPromotion = false;
+
+    if (! askedForPromotion)
+    {
+        askedForPromotion = true;
+        RealtimeMode::getInstance()->requestPromotion (RealtimeMode::Role::input);
+    }
+
+    // Runs on the MIDI thread; the bridge's queue is safe to push to from here
+    auto hotCues = getHotCues();
+
+    if (hotCues == nullptr || ! (message.isNoteOn() || message.isNoteOff()))
+        return;
+
+    const int cueSlot = message.getNoteNumber() - firstHotCueNote;
+    const int rollIndex = cueSlot - tracktion::engine::HotCuePlugin::numCues;
+
+    if (juce::isPositiveAndBelow (cueSlot, tracktion::engine::HotCuePlugin::numCues))
+    {
+        if (message.isNoteOn())
+            triggerHotCue (cueSlot);
+    }
+    else if (juce::isPositiveAndBelow (rollIndex, (int) loopRollLengths.size()))
+    {
+        if (message.isNoteOn())
+            startLoopRoll (loopRollLengths[(size_t) rollIndex]);
+        else
+            stopLoopRoll();
+    }
+}
+
+//==============================================================================
+void MainComponent::getAllCommands (juce::Array<juce::CommandID>& commands)
+{
+    for (int slot = 0; slot < tracktion::engine::HotCuePlugin::numCues; ++slot)
+    {
+        commands.add (CommandIDs::hotCue1 + slot);
+        commands.add (CommandIDs::clearHotCue1 + slot);
+    }
+
+    for (int i = 0; i < (int) loopRollLengths.size(); ++i)
+        commands.add (CommandIDs::loopRoll1 + i);
+
+    for (int slot = 0; slot < SceneMemory::numSlots; ++slot)
+    {
+        commands.add (CommandIDs::morphToScene1 + slot);
+        commands.add (CommandIDs::jumpToScene1 + slot);
+        commands.add (CommandIDs::storeScene1 + slot);
+    }
+}
+
+void MainComponent::getCommandInfo (juce::CommandID commandID, juce::ApplicationCommandInfo& result)
+{
+    const int hotCueSlot = commandID - CommandIDs::hotCue1;
+    const int clearSlot = commandID - CommandIDs::clearHotCue1;
+    const int rollIndex = commandID - CommandIDs::loopRoll1;
+    const int morphSlot = commandID - CommandIDs::morphToScene1;
+    const int jumpSlot = commandID - CommandIDs::jumpToScene1;
+    const int storeSlot = commandID - CommandIDs::storeScene1;
+
+    const int sceneKeys[SceneMemory::numSlots] = { juce::KeyPress::F1Key, juce::KeyPress::F2Key, juce::KeyPress::F3Key, juce::KeyPress::F4Key,
+                                                   juce::KeyPress::F5Key, juce::KeyPress::F6Key, juce::KeyPress::F7Key, juce::KeyPress::F8Key };
+
+    if (juce::isPositiveAndBelow (hotCueSlot, tracktion::engine::HotCuePlugin::numCues))
+    {
+        result.setInfo ("Hot Cue " + juce::String (hotCueSlot + 1), "Jumps to the cue on the next beat, or sets it if empty", "Hot Cues", 0);
+        result.addDefaultKeypress ('1' + hotCueSlot, 0);
+    }
+    else if (juce::isPositiveAndBelow (clearSlot, tracktion::engine::HotCuePlugin::numCues))
+    {
+        result.setInfo ("Clear Hot Cue " + juce::String (clearSlot + 1), "Empties the hot cue slot", "Hot Cues", 0);
+        result.addDefaultKeypress ('1' + clearSlot, juce::ModifierKeys::shiftModifier);
+    }
+    else if (juce::isPositiveAndBelow (rollIndex, (int) loopRollLengths.size()))
+    {
+        static constexpr char rollKeys[] = { 'q', 'w', 'e', 'r' };
+        const double beats = loopRollLengths[(size_t) rollIndex];
+        const auto name = beats < 1.0 ? "1/" + juce::String (juce::roundToInt (1.0 / beats)) : juce::String (beats, 0);
+
+        result.setInfo ("Loop Roll " + name, "Loops the last " + name + " beat while held", "Hot Cues", 0);
+        result.addDefaultKeypress (rollKeys[rollIndex], 0);
+        result.flags |= juce::ApplicationCommandInfo::wantsKeyUpDownCallbacks;
+    }
+    else if (juce::isPositiveAndBelow (morphSlot, SceneMemory::numSlots))
+    {
+        result.setInfo ("Morph to Scene " + juce::String (morphSlot + 1), "Blends the effects and screw into the scene over "
+                        + juce::String (sceneMorphBeats, 0) + " beats", "Scenes", 0);
+        result.addDefaultKeypress (sceneKeys[morphSlot], 0);
+    }
+    else if (juce::isPositiveAndBelow (jumpSlot, SceneMemory::numSlots))
+    {
+        result.setInfo ("Jump to Scene " + juce::String (jumpSlot + 1), "Switches the effects and screw to the scene at once", "Scenes", 0);
+        result.addDefaultKeypress (sceneKeys[jumpSlot], juce::ModifierKeys::commandModifier);
+    }
+    else if (juce::isPositiveAndBelow (storeSlot, SceneMemory::numSlots))
+    {
+        result.setInfo ("Store Scene " + juce::String (storeSlot + 1), "Keeps the current effects and screw in the scene slot", "Scenes", 0);
+        result.addDefaultKeypress (sceneKeys[storeSlot], juce::ModifierKeys::shiftModifier);
+    }
+}
+
+bool MainComponent::perform (const juce::ApplicationCommandTarget::InvocationInfo& info)
+{
+    const int morphSlot = info.commandID - CommandIDs::morphToScene1;
+    const int jumpSlot = info.commandID - CommandIDs::jumpToScene1;
+    const int storeSlot = info.commandID - CommandIDs::storeScene1;
+
+    if (juce::isPositiveAndBelow (morphSlot, SceneMemory::numSlots))
+    {
+        recallScene (morphSlot, sceneMorphBeats);
+        return true;
+    }
+
+    if (juce::isPositiveAndBelow (jumpSlot, SceneMemory::numSlots))
+    {
+        recallScene (jumpSlot, 0.0);
+        return true;
+    }
+
+    if (juce::isPositiveAndBelow (storeSlot, SceneMemory::numSlots))
+    {
+        storeScene (storeSlot);
+        return true;
+    }
+
+    auto hotCues = getHotCues();
+
+    if (hotCues == nullptr)
+        return false;
+
+    const int hotCueSlot = info.commandID - CommandIDs::hotCue1;
+    const int clearSlot = info.commandID - CommandIDs::clearHotCue1;
+    const int rollIndex = info.commandID - CommandIDs::loopRoll1;
+
+    if (juce::isPositiveAndBelow (hotCueSlot, tracktion::engine::HotCuePlugin::numCues))
+    {
+        triggerHotCue (hotCueSlot);
+        return true;
+    }
+
+    if (juce::isPositiveAndBelow (clearSlot, tracktion::engine::HotCuePlugin::numCues))
+    {
+        hotCues->clearCue (clearSlot);
+        return true;
+    }
+
+    if (juce::isPositiveAndBelow (rollIndex, (int) loopRollLengths.size()))
+    {
+        if (info.isKeyDown)
+            startLoopRoll (loopRollLengths[(size_t) rollIndex]);
+        else
+            stopLoopRoll();
+
+        return true;
+    }
+
+    return false;
+}
+
 void MainComponent::updatePositionLabel()
 {
+    // Draw what the audio thread last played rather than asking the transport
+    const auto& state = performanceBridge.getState();
+
     if (controlBarComponent)
-        controlBarComponent->updatePositionLabel();
+        controlBarComponent->updatePositionLabel (tracktion::TimePosition::fromSeconds (state.positionSeconds));
+
+    if (state.numDroppedCommands != lastDroppedCommands)
+    {
+        DBG ("Performance queue full: " + juce::String (state.numDroppedCommands - lastDroppedCommands) + " commands dropped");
+        lastDroppedCommands = state.numDroppedCommands;
+    }
+}
+
+void MainComponent::setUpScenes()
+{
+    // A scene is every slider on the effect panels, plus the screw
+    std::vector<te::AutomatableParameter::Ptr> parameters;
+
+    for (auto* panel : getEffectComponents())
+        for (auto& parameter : panel->getBoundParameters())
+            parameters.push_back (parameter);
+
+    // ChopShop's own effects play a morph on the audio thread; the reverb is
+    // Tracktion's, so it follows as the SceneMemory sets its parameters
+    std::vector<SceneFollower*> followers;
+
+    for (auto* panel : getEffectComponents())
+        if (auto* follower = dynamic_cast<SceneFollower*> (panel->getPlugin().get()))
+            followers.push_back (follower);
+
+    sceneMemory.setParameters (std::move (parameters), followers);
+
+    sceneMemory.onSceneApplied = [this] (const Scene& scene) {
+        for (auto* panel : getEffectComponents())
+            panel->showValues ([this, &scene] (const te::AutomatableParameter& parameter) {
+                return sceneMemory.getValue (scene, parameter);
+            });
+
+        const double tempo = baseTempo * scene.tempoRatio;
+
+        if (std::abs (screwComponent->getTempo() - tempo) > 0.001)
+        {
+            screwComponent->setTempo (tempo, juce::dontSendNotification);
+            updateTempo();
+        }
+    };
+}
+
+void MainComponent::storeScene (int slot)
+{
+    sceneMemory.store (slot, sceneMemory.capture (screwComponent->getTempo() / baseTempo));
+    DBG ("Stored scene " + juce::String (slot + 1));
+}
+
+void MainComponent::recallScene (int slot, double lengthBeats)
+{
+    const auto live = sceneMemory.capture (screwComponent->getTempo() / baseTempo);
+
+    if (! sceneMemory.recall (slot, live, lengthBeats, baseTempo))
+        DBG ("Scene " + juce::String (slot + 1) + " is empty");
 }
 
 void MainComponent::createVinylBrakeComponent()
@@ -727,53 +1619,43 @@ void MainComponent::createVinylBrakeComponent()
     addAndMakeVisible (*vinylBrakeComponent);
 }
 
-void MainComponent::createPluginRack()
+void MainComponent::createEffectReturns()
 {
-    if (auto masterTrack = edit.getMasterTrack())
-    {
-        tracktion::engine::Plugin::Array plugins;
+    std::vector<te::Plugin::Ptr> effects;
 
-        if (reverbComponent)
-            plugins.add (reverbComponent->getPlugin());
-        if (delayComponent)
-            plugins.add (delayComponent->getPlugin());
-        if (flangerComponent)
-            plugins.add (flangerComponent->getPlugin());
-        if (phaserComponent)
-            plugins.add (phaserComponent->getPlugin());
-
-        // Create the rack type with proper channel connections
-        if (auto rack = tracktion::engine::RackType::createTypeToWrapPlugins (plugins, edit))
-        {
-            masterTrack->pluginList.insertPlugin (tracktion::engine::RackInstance::create (*rack), 0);
-        }
-    }
+    for (auto* effect : getEffectComponents())
+        effects.push_back (effect != nullptr ? effect->getPlugin() : nullptr);
+
+    EditLayout::createEffectReturns (edit, DeckComponent::numDecks, effects);
 }
 
 void MainComponent::releaseResources()
 {
     // Stop any active timers
     stopTimer();
+    sessionStore.stopAutosaving();
+    sessionStore.captureSnapshot = nullptr;
+    sceneMemory.onSceneApplied = nullptr;
+    bufferSizeTuner.cancelAutoTune();
+    bufferSizeTuner.setWatching (false);
+
+    engine.getDeviceManager().deviceManager.removeAudioCallback (&audioThreadPinner);
+    engine.getDeviceManager().deviceManager.removeAudioCallback (&performanceBridge);
+
+    performanceBridge.setHotCueTarget (nullptr);
+
+    for (int i = 0; i < (int) decks.size(); ++i)
+        performanceBridge.setDeckTarget (i, nullptr);
+    engine.getDeviceManager().deviceManager.removeMidiInputDeviceCallback ({}, this);
 
     // Stop playback if active
     if (edit.getTransport().isPlaying())
         edit.getTransport().stop (true, false);
 
-    // Debug reference counting
-    if (oscilloscopePlugin != nullptr)
-    {
-        DBG ("Oscilloscope plugin reference count: " + juce::String (oscilloscopePlugin->getReferenceCount()));
-    }
-
-    // Remove oscilloscope listener
-    if (auto* oscPlugin = dynamic_cast<tracktion::engine::OscilloscopePlugin*> (oscilloscopePlugin.get()))
-    {
-        oscPlugin->removeListener (this);
-        DBG ("Removed oscilloscope listener");
-    }
-
     // Clear all component pointers in a specific order
     oscilloscopeComponent = nullptr;
+    spectrumComponent = nullptr;
+    meterBridge = nullptr;
     thumbnail = nullptr;
 
     controllerMappingComponent = nullptr;
@@ -787,9 +1669,18 @@ void MainComponent::releaseResources()
     scratchComponent = nullptr;
     reverbComponent = nullptr;
     vinylBrakeComponent = nullptr;
+    deckComponent = nullptr;
+
+    // Make sure a running recording gets flushed and closed
+    if (auto recorder = getMasterRecorder())
+        recorder->stopRecording();
 
     // Release plugin reference
-    oscilloscopePlugin = nullptr;
+    masterRecorderPlugin = nullptr;
+    hotCuePlugin = nullptr;
+
+    for (auto& deck : decks)
+        deck = nullptr;
 
     // Clear gamepad manager
     if (gamepadManager)
@@ -25,7 +25,22 @@ namespace ProjectInfo
 #include "LibraryComponent.h"
 #include "VinylBrakeComponent.h"
 #include "DelayComponent.h"
-#include "OscilloscopePlugin.h"
+#include "ScopeView.h"
+#include "MeterComponent.h"
+#include "SpectrumComponent.h"
+#include "TapPlugin.h"
+#include "EffectReturnPlugin.h"
+#include "MasterRecorderPlugin.h"
+#include "HotCuePlugin.h"
+#include "ChopVoicesPlugin.h"
+#include "Deck.h"
+#include "PerformanceBridge.h"
+#include "SceneMemory.h"
+#include "DeckComponent.h"
+#include "TaskScheduler.h"
+#include "RealtimeMode.h"
+#include "BufferSizeTuner.h"
+#include "SessionStore.h"
 #include "ChopComponent.h"
 #include "ScrewComponent.h"
 #include "ControllerMappingComponent.h"
@@ -42,6 +57,16 @@ namespace ProjectInfo
 // Add this line to enable console output
 #define JUCE_DEBUG 1
 
+namespace CommandIDs
+{
+    static const int hotCue1 = 100;         // keys 1-8, one ID per slot
+    static const int clearHotCue1 = 110;    // shift + 1-8
+    static const int loopRoll1 = 120;       // one ID per entry in MainComponent::loopRollLengths
+    static const int morphToScene1 = 130;   // F1-F8, one ID per scene slot
+    static const int jumpToScene1 = 140;    // cmd + F1-F8
+    static const int storeScene1 = 150;     // shift + F1-F8
+}
+
 //==============================================================================
 /*
     This component lives inside our window, and this is where you should put all
@@ -51,8 +76,8 @@ class MainComponent : public juce::Component,
                       public juce::Timer,
                       public GamepadManager::Listener,
                       public juce::ChangeListener,
-                      public tracktion::engine::OscilloscopePlugin::Listener,
-                      public juce::ApplicationCommandTarget
+                      public juce::ApplicationCommandTarget,
+                      private juce::MidiInputCallback
 {
 public:
     //==============================================================================
@@ -70,6 +95,10 @@ public:
     // Toggles playback state and updates UI
     void play();
     void stop();
+
+    /** Allocates the playback graph and prefaults what the audio thread will touch. */
+    void prepareForPlayback();
+
     void loadAudioFile();
     void updateTempo();
     tracktion::engine::WaveAudioClip::Ptr getClip(int trackIndex);
@@ -84,6 +113,7 @@ public:
         }
         
         updatePositionLabel();
+        updateRecordButton();
         
         // Only manipulate the crossfader if we're handling a chop release
         if (chopReleaseDelay > 0)
@@ -100,54 +130,59 @@ public:
         // This will be called when the transport state changes
     }
 
-    void oscilloscopePluginInitialised() override
-    {
-        // Create and add the component on the message thread
-        juce::MessageManager::callAsync([this]()
-        {
-            if (auto* oscPlugin = dynamic_cast<tracktion::engine::OscilloscopePlugin*>(oscilloscopePlugin.get()))
-            {
-                oscilloscopeComponent.reset(oscPlugin->createControlPanel());
-                if (oscilloscopeComponent != nullptr)
-                {
-                    DBG("Created oscilloscope component after initialization");
-                    addAndMakeVisible(*oscilloscopeComponent);
-                    resized();
-                }
-            }
-        });
-    }
-
     // Add these required methods from ApplicationCommandTarget
     juce::ApplicationCommandTarget* getNextCommandTarget() override
     {
         return chopComponent.get();
     }
     
-    void getAllCommands([[maybe_unused]] juce::Array<juce::CommandID>& commands) override
-    {
-        // Add any commands your main component handles
-    }
-    
-    void getCommandInfo([[maybe_unused]] juce::CommandID commandID, [[maybe_unused]] juce::ApplicationCommandInfo& result) override
-    {
-        // Provide info for your commands
-    }
-    
-    bool perform([[maybe_unused]] const juce::ApplicationCommandTarget::InvocationInfo& info) override
-    {
-        return false; // Return true if you handle the command
-    }
+    void getAllCommands(juce::Array<juce::CommandID>& commands) override;
+    void getCommandInfo(juce::CommandID commandID, juce::ApplicationCommandInfo& result) override;
+    bool perform(const juce::ApplicationCommandTarget::InvocationInfo& info) override;
 
     void setupAudioGraph();
 
 private:
     //==============================================================================
-    tracktion::engine::Engine engine{ProjectInfo::projectName};
+    // Lets Tracktion render each deck's track on its own audio worker thread
+    struct EngineBehaviour : public tracktion::engine::EngineBehaviour
+    {
+        int getNumberOfCPUsToUseForAudio() override
+        {
+            // One per deck, plus the device thread that mixes them on the master,
+            // as long as each has a core kept free of background work
+            return juce::jmax (1, TaskScheduler::getInstance()->getNumAudioCores());
+        }
+    };
+
+    static_assert (TaskScheduler::numAudioThreads == DeckComponent::numDecks + 1,
+                   "Keep a core free for each deck's audio worker and the device thread");
+
+    tracktion::engine::Engine engine{ProjectInfo::projectName, nullptr, std::make_unique<EngineBehaviour>()};
     tracktion::engine::Edit edit{engine, tracktion::engine::Edit::forEditing};
+
+    // Every performance gesture goes to the audio thread through here
+    PerformanceBridge performanceBridge{edit};
+
+    // Effect and screw scenes, blended on the audio thread
+    SceneMemory sceneMemory{performanceBridge};
+    static constexpr double sceneMorphBeats = 4.0;
+    void setUpScenes();
+    void storeScene(int slot);
+    void recallScene(int slot, double lengthBeats);
+    juce::uint32 lastDroppedCommands = 0;
     std::unique_ptr<CustomLookAndFeel> customLookAndFeel;
     juce::TextButton audioSettingsButton{"Audio Settings"};
 
+    // Picks the smallest buffer that copes with both decks and every effect
+    BufferSizeTuner bufferSizeTuner{engine.getDeviceManager().deviceManager};
+    juce::TextButton autoBufferButton{"Auto Buffer Size"};
+    int tuningDeck = -1;            // deck loaded just for the tuning run
+    bool wasPlayingBeforeTuning = false;
+    void autoTuneBufferSize();
+    void endTuningLoad();
+    std::array<BaseEffectComponent*, 4> getEffectComponents() const;
+
     double baseTempo = 120.0;
     double trackOffset = 0.0;
 
@@ -163,24 +198,54 @@ private:
     juce::TextButton saveButton{"Save"};
     juce::TextButton recordButton{"Record"};
 
-    void handleFileSelection(const juce::File &file);
+    void handleFileSelection(const juce::File &file, bool autoPlay = true,
+                             std::optional<tracktion::BeatPosition> alignedStart = {});
+    void loadBeatAligned(Deck& deck, const juce::File& file, double fileBpm, float gainDb,
+                         std::optional<CuePoints> cues, const std::vector<double>& beats,
+                         std::optional<tracktion::BeatPosition> startBeat = {});
+
+    // Session snapshots: the Save button's menu, and an autosave journal behind it
+    SessionStore sessionStore{SessionStore::getDefaultDirectory()};
+    std::shared_ptr<juce::FileChooser> sessionChooser;
+    void showSessionMenu();
+    SessionSnapshot captureSession();
+    void restoreSession(const SessionSnapshot& session);
+    void loadRestoredDeck(int deck, const juce::File& file, double barPhase);
+    int restoreGeneration = 0;  // so a re-analysis that lands after another restore is ignored
+
+    // Everything with controls saved in a session, by the name it's saved under
+    std::array<std::pair<const char*, BaseEffectComponent*>, 5> getSessionPanels() const;
+
+    // Taken once per loaded file, so autosaves don't read the disk
+    std::array<std::pair<juce::File, TrackFingerprint>, DeckComponent::numDecks> deckFingerprints;
+    const TrackFingerprint& getFingerprint(int deck);
+
+    // Loop region of the loaded track, from its analysis cue points
+    std::optional<tracktion::BeatRange> cueLoopBeats;
+    void applyCueLoopRange();
 
     void updateCrossfader();
-    void setTrackVolume(int trackIndex, float volume);
+    void updateChopLayers();
 
     std::unique_ptr<Thumbnail> thumbnail;
 
-    void armTrack(int trackIndex, bool arm);
     void startRecording();
     void stopRecording();
+    void updateRecordButton();
+    tracktion::engine::MasterRecorderPlugin* getMasterRecorder() const;
 
     bool isTempoPercentageActive(double percentage) const;
 
     double chopStartTime = 0.0;
     double chopReleaseDelay = 0.0;
 
-    te::VolumeAndPanPlugin *volumeAndPan1 = nullptr;
-    te::VolumeAndPanPlugin *volumeAndPan2 = nullptr;
+    // Each deck is its own track with its own stretch, chop voices and effects send
+    std::array<std::unique_ptr<Deck>, DeckComponent::numDecks> decks;
+    int selectedDeck = 0;   // where the library loads to, and what the chop controls play
+    int masterDeck = 0;     // the deck whose tempo and bars the others follow
+
+    void updateDeckFader();
+    void updateDeckInfo();
 
     // GameController member variables
     GamepadManager* gamepadManager = nullptr;
@@ -194,10 +259,12 @@ private:
     std::unique_ptr<ScrewComponent> screwComponent;
     std::unique_ptr<PhaserComponent> phaserComponent;
     std::unique_ptr<ScratchComponent> scratchComponent;
+    std::unique_ptr<DeckComponent> deckComponent;
     bool isTrackLoaded()
     {
-        if (auto track = EngineHelpers::getOrInsertAudioTrackAt(edit, 0))
-            return !track->getClips().isEmpty();
+        for (auto& deck : decks)
+            if (deck != nullptr && deck->isLoaded())
+                return true;
         return false;
     }
 
@@ -209,16 +276,41 @@ private:
 
     void updatePositionLabel();
 
-    std::unique_ptr<Component> oscilloscopeComponent;
+    std::unique_ptr<ScopeView> oscilloscopeComponent;
+    std::unique_ptr<SpectrumComponent> spectrumComponent;
+    std::unique_ptr<MeterBridgeComponent> meterBridge;
+
+    // Taps the master output after the effects for recording sets
+    tracktion::engine::Plugin::Ptr masterRecorderPlugin;
+
+    // Hot cues and loop rolls, run on the audio thread ahead of the effects
+    tracktion::engine::Plugin::Ptr hotCuePlugin;
+    tracktion::engine::HotCuePlugin* getHotCues() const;
+
+    // Loop roll lengths in beats, for the Q/W/E/R keys and MIDI notes 44-47
+    static constexpr std::array<double, 4> loopRollLengths { 0.25, 0.5, 1.0, 2.0 };
+
+    // While Select is held, the face buttons and D-pad trigger hot cues
+    bool hotCueLayerHeld = false;
+    bool handleHotCueGamepadButton(int buttonId, bool isDown);
+
+    void triggerHotCue(int slot);
+    void startLoopRoll(double lengthInBeats);
+    void stopLoopRoll();
+
+    // MIDI pads go straight to the hot cue queue from the MIDI thread
+    void enableMidiInputs();
+    void handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage&) override;
+    static constexpr int firstHotCueNote = 36;    // 36-43 hot cues, 44-47 loop rolls
 
-    // Add a member to hold the plugin reference
-    tracktion::engine::Plugin::Ptr oscilloscopePlugin;
+    // Moves the audio device thread onto the cores the TaskScheduler leaves free
+    TaskScheduler::AudioThreadPinner audioThreadPinner;
 
     std::unique_ptr<ControllerMappingComponent> controllerMappingComponent;
 
     void createVinylBrakeComponent();
 
-    void createPluginRack();
+    void createEffectReturns();
 
     void releaseResources();
 
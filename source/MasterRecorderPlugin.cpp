@@ -0,0 +1,330 @@
+#include "MasterRecorderPlugin.h"
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+namespace tracktion { inline namespace engine
+{
+
+namespace
+{
+    /** Reserves disk blocks for part of the file ahead of time so that the
+        filesystem doesn't have to go looking for free extents while we're
+        streaming into it. FALLOC_FL_KEEP_SIZE leaves the logical size alone, so
+        the encoder still writes from where it is as normal.
+    */
+    void preallocate (const juce::File& file, juce::int64 offset, juce::int64 numBytes)
+    {
+       #if JUCE_LINUX
+        const int fd = ::open (file.getFullPathName().toRawUTF8(), O_WRONLY | O_CREAT, 0644);
+
+        if (fd < 0)
+            return;
+
+        if (::fallocate (fd, FALLOC_FL_KEEP_SIZE, (off_t) offset, (off_t) numBytes) != 0)
+            DBG ("MasterRecorder: fallocate failed, recording without preallocation");
+
+        ::close (fd);
+       #else
+        juce::ignoreUnused (file, offset, numBytes);
+       #endif
+    }
+
+    /** Gives back any reserved blocks past the end of what was actually written. */
+    void releaseUnusedPreallocation (const juce::File& file)
+    {
+       #if JUCE_LINUX
+        if (file.existsAsFile())
+            if (::truncate (file.getFullPathName().toRawUTF8(), (off_t) file.getSize()) != 0)
+                DBG ("MasterRecorder: failed to release preallocated space");
+       #else
+        juce::ignoreUnused (file);
+       #endif
+    }
+
+    std::unique_ptr<juce::AudioFormat> createFormatForFile (const juce::File& file)
+    {
+        if (file.hasFileExtension ("flac"))
+            return std::make_unique<juce::FlacAudioFormat>();
+
+        return std::make_unique<juce::WavAudioFormat>();
+    }
+}
+
+//==============================================================================
+/** Drains the FIFO on its own thread and feeds the encoder in large chunks. */
+class MasterRecorderPlugin::DiskWriter  : public juce::Thread
+{
+public:
+    DiskWriter (MasterRecorderPlugin& o,
+                std::unique_ptr<juce::AudioFormat> f,
+                std::unique_ptr<juce::AudioFormatWriter> w,
+                const juce::File& destFile, juce::int64 bytesAhead)
+        : juce::Thread ("ChopShop Master Recorder"),
+          owner (o), format (std::move (f)), writer (std::move (w)),
+          chunk (numChannels, writeChunkSize),
+          file (destFile), reserveAheadBytes (bytesAhead)
+    {
+        reserveAhead();
+    }
+
+    ~DiskWriter() override
+    {
+        // The run loop flushes whatever is left in the FIFO before returning
+        stopThread (10000);
+        writer.reset();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            // Only write full chunks while running so the encoder and the
+            // filesystem see large, evenly sized writes.
+            if (owner.fifo.getNumReady() < writeChunkSize)
+            {
+                wait (50);
+                continue;
+            }
+
+            writeChunk();
+            reserveAhead();
+        }
+
+        while (owner.fifo.getNumReady() > 0)
+            writeChunk();
+
+        writer->flush();
+    }
+
+private:
+    void writeChunk()
+    {
+        const int numToRead = juce::jmin (owner.fifo.getNumReady(), writeChunkSize);
+
+        int start1, size1, start2, size2;
+        owner.fifo.prepareToRead (numToRead, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (size1 > 0)
+                chunk.copyFrom (ch, 0, owner.fifoBuffer, ch, start1, size1);
+
+            if (size2 > 0)
+                chunk.copyFrom (ch, size1, owner.fifoBuffer, ch, start2, size2);
+        }
+
+        owner.fifo.finishedRead (size1 + size2);
+
+        if (! writer->writeFromAudioSampleBuffer (chunk, 0, size1 + size2))
+            DBG ("MasterRecorder: encoder write failed");
+
+        owner.numSamplesWritten += size1 + size2;
+    }
+
+    /** Keeps a few minutes of disk reserved past what's been written, topping
+        it up once half of it has been used, rather than a whole set's worth up front.
+    */
+    void reserveAhead()
+    {
+        const auto written = file.getSize();
+
+        if (written + reserveAheadBytes / 2 < reservedBytes)
+            return;
+
+        preallocate (file, reservedBytes, written + reserveAheadBytes - reservedBytes);
+        reservedBytes = written + reserveAheadBytes;
+    }
+
+    MasterRecorderPlugin& owner;
+    std::unique_ptr<juce::AudioFormat> format;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    juce::AudioBuffer<float> chunk;
+
+    const juce::File file;
+    const juce::int64 reserveAheadBytes;
+    juce::int64 reservedBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DiskWriter)
+};
+
+//==============================================================================
+const char* MasterRecorderPlugin::xmlTypeName ("masterRecorder");
+
+MasterRecorderPlugin::MasterRecorderPlugin (PluginCreationInfo info)  : Plugin (info)
+{
+}
+
+MasterRecorderPlugin::~MasterRecorderPlugin()
+{
+    stopRecording();
+    notifyListenersOfDeletion();
+}
+
+juce::ValueTree MasterRecorderPlugin::create()
+{
+    return createValueTree (IDs::PLUGIN,
+                            IDs::type, xmlTypeName);
+}
+
+void MasterRecorderPlugin::initialise (const PluginInitialisationInfo& info)
+{
+    // The graph gets rebuilt whenever clips change, so keep the FIFO alive
+    // across re-initialisation while a recording is running.
+    if (isRecording())
+    {
+        if (info.sampleRate != sampleRate)
+            DBG ("MasterRecorder: sample rate changed mid-recording, file will play back at the wrong speed");
+
+        return;
+    }
+
+    sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+
+    const int capacity = juce::roundToInt (sampleRate * fifoSeconds);
+
+    if (fifoBuffer.getNumSamples() != capacity)
+    {
+        fifoBuffer.setSize (numChannels, capacity);
+        fifo.setTotalSize (capacity);
+    }
+}
+
+void MasterRecorderPlugin::deinitialise()
+{
+}
+
+bool MasterRecorderPlugin::startRecording (const juce::File& destFile)
+{
+    stopRecording();
+
+    if (fifoBuffer.getNumSamples() == 0)
+    {
+        DBG ("MasterRecorder: not initialised yet, can't record");
+        return false;
+    }
+
+    destFile.getParentDirectory().createDirectory();
+    destFile.deleteFile();
+
+    auto format = createFormatForFile (destFile);
+    const int bitsPerSample = 24;
+
+    auto stream = std::make_unique<juce::FileOutputStream> (destFile, 1 << 20);
+
+    if (! stream->openedOk())
+    {
+        DBG ("MasterRecorder: couldn't open " + destFile.getFullPathName());
+        return false;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), sampleRate,
+                                                                              (unsigned int) numChannels,
+                                                                              bitsPerSample, {}, 0));
+
+    if (writer == nullptr)
+    {
+        DBG ("MasterRecorder: couldn't create a " + format->getFormatName() + " writer");
+        return false;
+    }
+
+    stream.release(); // now owned by the writer
+
+    fifo.reset();
+    numUnderruns = 0;
+    numSamplesWritten = 0;
+    currentFile = destFile;
+
+    // Sized for uncompressed audio; FLAC usually lands well under this
+    const auto bytesPerSecond = (juce::int64) (sampleRate * numChannels * (bitsPerSample / 8));
+
+    auto newWriter = std::make_unique<DiskWriter> (*this, std::move (format), std::move (writer),
+                                                   destFile, bytesPerSecond * (juce::int64) preallocateAheadSeconds);
+    newWriter->startThread (juce::Thread::Priority::high);
+
+    {
+        const juce::SpinLock::ScopedLockType sl (writerLock);
+        diskWriter = std::move (newWriter);
+        recording = true;
+    }
+
+    DBG ("MasterRecorder: recording to " + destFile.getFullPathName());
+    return true;
+}
+
+void MasterRecorderPlugin::stopRecording()
+{
+    std::unique_ptr<DiskWriter> writerToStop;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (writerLock);
+        recording = false;
+        writerToStop = std::move (diskWriter);
+    }
+
+    if (writerToStop == nullptr)
+        return;
+
+    // Joins the writer thread, which flushes the rest of the FIFO and closes the file
+    writerToStop.reset();
+    releaseUnusedPreallocation (currentFile);
+
+    DBG ("MasterRecorder: stopped, wrote " + juce::String (numSamplesWritten.load())
+         + " samples with " + juce::String (numUnderruns.load()) + " underruns");
+}
+
+void MasterRecorderPlugin::applyToBuffer (const PluginRenderContext& rc)
+{
+    if (! recording.load (std::memory_order_relaxed) || rc.destBuffer == nullptr || rc.bufferNumSamples <= 0)
+        return;
+
+    const juce::SpinLock::ScopedTryLockType sl (writerLock);
+
+    // Recording is being started or stopped; the block is lost all the same
+    if (! sl.isLocked())
+    {
+        ++numUnderruns;
+        return;
+    }
+
+    if (diskWriter == nullptr)
+        return;
+
+    const int numSamples = rc.bufferNumSamples;
+
+    if (fifo.getFreeSpace() < numSamples)
+    {
+        ++numUnderruns;
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+    const int numSourceChannels = rc.destBuffer->getNumChannels();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (numSourceChannels == 0)
+        {
+            fifoBuffer.clear (ch, start1, size1);
+            fifoBuffer.clear (ch, start2, size2);
+            continue;
+        }
+
+        // Mono sources get duplicated into both channels of the file
+        auto* src = rc.destBuffer->getReadPointer (juce::jmin (ch, numSourceChannels - 1), rc.bufferStartSample);
+
+        if (size1 > 0)
+            juce::FloatVectorOperations::copy (fifoBuffer.getWritePointer (ch, start1), src, size1);
+
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy (fifoBuffer.getWritePointer (ch, start2), src + size1, size2);
+    }
+
+    fifo.finishedWrite (size1 + size2);
+}
+
+}} // namespace tracktion { inline namespace engine
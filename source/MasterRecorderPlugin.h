@@ -0,0 +1,90 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+namespace tracktion { inline namespace engine
+{
+
+/** Records the master bus, after the effect returns, to a WAV or FLAC file.
+
+    The audio thread only ever copies into a preallocated lock-free FIFO. A
+    dedicated writer thread drains that FIFO in large chunks and does all the
+    encoding and disk I/O, so long sets can be recorded without touching the
+    disk from the audio callback.
+
+    If the writer falls behind and the FIFO fills up, or the writer is being
+    swapped while a block comes in, the block is dropped and counted as an
+    underrun rather than blocking the audio thread.
+*/
+class MasterRecorderPlugin   : public Plugin
+{
+public:
+    MasterRecorderPlugin (PluginCreationInfo);
+    ~MasterRecorderPlugin() override;
+
+    static const char* getPluginName()                  { return NEEDS_TRANS("Master Recorder"); }
+    static juce::ValueTree create();
+
+    //==============================================================================
+    static const char* xmlTypeName;
+
+    juce::String getName() const override               { return TRANS("Master Recorder"); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    void initialise (const PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const PluginRenderContext&) override;
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return numInputChannels; }
+    bool producesAudioWhenNoAudioInput() override       { return false; }
+    juce::String getSelectableDescription() override    { return TRANS("Master Recorder Plugin"); }
+
+    //==============================================================================
+    /** Starts writing the master output to the given file. The format is chosen
+        from the file extension (.wav or .flac). Returns false if the file
+        couldn't be opened or the plugin hasn't been initialised yet.
+    */
+    bool startRecording (const juce::File& destFile);
+
+    /** Stops recording, flushes everything still in the FIFO and closes the file. */
+    void stopRecording();
+
+    bool isRecording() const noexcept                   { return recording.load(); }
+
+    /** Number of blocks dropped because the writer thread couldn't keep up,
+        or because they came in while the writer was being swapped.
+    */
+    int getNumUnderruns() const noexcept                { return numUnderruns.load(); }
+
+    /** Number of sample frames that have been handed to the encoder so far. */
+    juce::int64 getNumSamplesWritten() const noexcept   { return numSamplesWritten.load(); }
+
+    double getRecordingSampleRate() const noexcept      { return sampleRate; }
+
+    juce::File getCurrentFile() const                   { return currentFile; }
+
+private:
+    class DiskWriter;
+
+    static constexpr int numChannels = 2;
+    static constexpr int fifoSeconds = 10;
+    static constexpr int writeChunkSize = 64 * 1024;     // frames per encoder call
+    static constexpr double preallocateAheadSeconds = 5.0 * 60.0;     // disk kept reserved past the write position
+
+    double sampleRate = 44100.0;
+    juce::File currentFile;
+
+    juce::AudioBuffer<float> fifoBuffer;
+    juce::AbstractFifo fifo { 1 };
+    std::unique_ptr<DiskWriter> diskWriter;
+
+    juce::SpinLock writerLock;
+    std::atomic<bool> recording { false };
+    std::atomic<int> numUnderruns { 0 };
+    std::atomic<juce::int64> numSamplesWritten { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterRecorderPlugin)
+};
+
+}} // namespace tracktion { inline namespace engine
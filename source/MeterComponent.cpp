@@ -0,0 +1,125 @@
+#include "MeterComponent.h"
+
+namespace
+{
+    constexpr int nameHeight = 14;
+    constexpr int readoutHeight = 36;
+
+    int toTenths (float db) noexcept
+    {
+        return juce::roundToInt (juce::jmax (LevelMeter::minDb, db) * 10.0f);
+    }
+
+    juce::String formatReadout (const char* label, float db)
+    {
+        return juce::String (label) + (db <= MeterComponent::minDb ? juce::String ("-inf") : juce::String (db, 1));
+    }
+}
+
+//==============================================================================
+MeterComponent::MeterComponent (const juce::String& meterName)
+    : name (meterName)
+{
+    setOpaque (true);
+}
+
+juce::Rectangle<int> MeterComponent::getBarArea() const
+{
+    return getLocalBounds().withTrimmedTop (nameHeight).withTrimmedBottom (readoutHeight).reduced (6, 2);
+}
+
+int MeterComponent::getBarHeight (float db) const noexcept
+{
+    const float proportion = juce::jmap (juce::jlimit (minDb, maxDb, db), minDb, maxDb, 0.0f, 1.0f);
+    return juce::roundToInt (proportion * (float) getBarArea().getHeight());
+}
+
+void MeterComponent::setLevels (const LevelMeter::Levels& newLevels)
+{
+    levels = newLevels;
+
+    Drawn now;
+    now.peak = getBarHeight (levels.peakDb);
+    now.rms = getBarHeight (levels.rmsDb);
+    now.truePeak = getBarHeight (levels.truePeakDb);
+    now.truePeakTenths = toTenths (levels.truePeakDb);
+    now.momentaryTenths = toTenths (levels.momentaryLufs);
+    now.shortTermTenths = toTenths (levels.shortTermLufs);
+
+    if (now == drawn)
+        return;
+
+    drawn = now;
+    repaint();
+}
+
+void MeterComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+
+    const auto green = juce::Colour (0xFF00FF41);
+    auto bar = getBarArea();
+
+    g.setColour (green.withAlpha (0.15f));
+    g.fillRect (bar);
+
+    // Peak behind, RMS in front
+    const auto peakColour = levels.peakDb > 0.0f ? juce::Colours::red
+                          : levels.peakDb > -6.0f ? juce::Colours::yellow
+                          : green.withAlpha (0.5f);
+
+    g.setColour (peakColour);
+    g.fillRect (bar.withTop (bar.getBottom() - drawn.peak));
+
+    g.setColour (green);
+    g.fillRect (bar.reduced (bar.getWidth() / 4, 0).withTop (bar.getBottom() - drawn.rms));
+
+    g.setColour (levels.truePeakDb > -1.0f ? juce::Colours::red : juce::Colours::white);
+    g.fillRect (bar.getX(), bar.getBottom() - drawn.truePeak - 1, bar.getWidth(), 2);
+
+    // 0 dB line
+    g.setColour (juce::Colours::white.withAlpha (0.4f));
+    g.fillRect (bar.getX(), bar.getBottom() - getBarHeight (0.0f), bar.getWidth(), 1);
+
+    g.setFont (juce::FontOptions (10.0f));
+    g.setColour (juce::Colours::white.withAlpha (0.8f));
+    g.drawText (name, getLocalBounds().removeFromTop (nameHeight), juce::Justification::centred);
+
+    auto readouts = getLocalBounds().removeFromBottom (readoutHeight);
+    g.drawText (formatReadout ("TP ", levels.truePeakDb), readouts.removeFromTop (12), juce::Justification::centred);
+    g.drawText (formatReadout ("M ", levels.momentaryLufs), readouts.removeFromTop (12), juce::Justification::centred);
+    g.drawText (formatReadout ("S ", levels.shortTermLufs), readouts.removeFromTop (12), juce::Justification::centred);
+}
+
+//==============================================================================
+MeterBridgeComponent::MeterBridgeComponent (const juce::StringArray& tapNames)
+{
+    for (auto& tapName : tapNames)
+    {
+        taps.push_back (AudioTapService::getInstance()->subscribe (tapName));
+        addAndMakeVisible (meters.add (new MeterComponent (tapName)));
+    }
+
+    startTimerHz (30);
+}
+
+MeterBridgeComponent::~MeterBridgeComponent()
+{
+    stopTimer();
+}
+
+void MeterBridgeComponent::resized()
+{
+    auto bounds = getLocalBounds();
+    const int width = meters.isEmpty() ? 0 : bounds.getWidth() / meters.size();
+
+    for (auto* meter : meters)
+        meter->setBounds (bounds.removeFromLeft (width).reduced (1, 0));
+}
+
+void MeterBridgeComponent::timerCallback()
+{
+    for (size_t i = 0; i < taps.size(); ++i)
+        if (taps[i])
+            meters[(int) i]->setLevels (taps[i]->getMeter().getLevels());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "AudioTap.h"
+#include "LevelMeter.h"
+
+#include <vector>
+
+//==============================================================================
+/** One vertical meter: RMS bar, peak bar, true-peak hold line, and the
+    true-peak and loudness readouts underneath.
+*/
+class MeterComponent  : public juce::Component
+{
+public:
+    explicit MeterComponent (const juce::String& name);
+
+    static constexpr float minDb = -60.0f, maxDb = 6.0f;
+
+    /** Takes the latest levels and repaints only if something visibly moved. */
+    void setLevels (const LevelMeter::Levels&);
+
+    void paint (juce::Graphics&) override;
+
+private:
+    /** What's on screen: bar heights in pixels and readouts to a tenth of a dB. */
+    struct Drawn
+    {
+        int peak = 0, rms = 0, truePeak = 0;
+        int truePeakTenths = 0, momentaryTenths = 0, shortTermTenths = 0;
+
+        bool operator== (const Drawn& other) const noexcept
+        {
+            return peak == other.peak && rms == other.rms && truePeak == other.truePeak
+                && truePeakTenths == other.truePeakTenths
+                && momentaryTenths == other.momentaryTenths
+                && shortTermTenths == other.shortTermTenths;
+        }
+    };
+
+    juce::Rectangle<int> getBarArea() const;
+    int getBarHeight (float db) const noexcept;
+
+    const juce::String name;
+    LevelMeter::Levels levels;
+    Drawn drawn;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterComponent)
+};
+
+//==============================================================================
+/** A row of meters, one per tap, polled from the taps' LevelMeters.
+
+    Holding the subscriptions keeps the taps, and so their meters, running.
+*/
+class MeterBridgeComponent  : public juce::Component,
+                              private juce::Timer
+{
+public:
+    explicit MeterBridgeComponent (const juce::StringArray& tapNames);
+    ~MeterBridgeComponent() override;
+
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    std::vector<AudioTap::Subscription> taps;
+    juce::OwnedArray<MeterComponent> meters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterBridgeComponent)
+};
@@ -16,7 +16,7 @@
     #include <GL/gl.h>
 #endif
 
-#include "RingBuffer.h"
+#include "AudioTap.h"
 
 /** This 2D Oscilloscope uses a Fragment-Shader based implementation.
  
@@ -38,14 +38,12 @@ class Oscilloscope2D :  public Component,
     
 public:
     
-    Oscilloscope2D (RingBuffer<GLfloat>* bufferToUse)
-    : readBuffer (2, RING_BUFFER_READ_SIZE)
+    Oscilloscope2D (AudioTap::Subscription tapToUse)
+    : tap (std::move (tapToUse)), readBuffer (2, RING_BUFFER_READ_SIZE)
     {
         // Sets the OpenGL version to 3.2
         openGLContext.setOpenGLVersionRequired (OpenGLContext::OpenGLVersion::openGL3_2);
         
-        this->ringBuffer = bufferToUse;
-        
         // Attach the OpenGL context but do not start [ see start() ]
         openGLContext.setRenderer(this);
         openGLContext.attachTo(*this);
@@ -63,16 +61,26 @@ public:
         openGLContext.detach();
 
         stop();
-        
-        // Detach ringBuffer
-        ringBuffer = nullptr;
     }
     
     void handleAsyncUpdate() override
     {
         statusLabel.setText (statusText, dontSendNotification);
+
+        if (! rendererReported && rendererName.isNotEmpty())
+        {
+            rendererReported = true;
+
+            if (onRendererDetected != nullptr)
+                onRendererDetected (rendererName, shader != nullptr);
+        }
     }
     
+    /** Called on the message thread once the context is up, with the
+        GL_RENDERER string and whether the shader compiled.
+     */
+    std::function<void (const String& renderer, bool shaderCompiled)> onRendererDetected;
+    
     //==========================================================================
     // Oscilloscope2D Control Functions
     
@@ -96,14 +104,19 @@ public:
      */
     void newOpenGLContextCreated() override
     {
-        // Add safety check for ring buffer
-        if (ringBuffer == nullptr)
+        // Add safety check for the tap
+        if (! tap)
         {
-            statusText = "No buffer available";
+            statusText = "No tap available";
             triggerAsyncUpdate();
             return;
         }
         
+        if (auto* renderer = glGetString (GL_RENDERER))
+            rendererName = String ((const char*) renderer);
+        else
+            rendererName = "Unknown";
+        
         createShaders();
         
         // Setup Buffer Objects
@@ -125,22 +138,12 @@ public:
      */
     void renderOpenGL() override
     {
-        if (ringBuffer == nullptr)
+        if (! tap)
             return;
         
-        // Create a temporary buffer for reading samples
-        AudioBuffer<GLfloat> tempBuffer(2, RING_BUFFER_READ_SIZE);
-        
-        // Try to read samples, but handle empty buffer case
-        try 
-        {
-            ringBuffer->readSamples(tempBuffer, RING_BUFFER_READ_SIZE);
-        }
-        catch (...)
-        {
-            // If reading fails, just return without rendering
-            return;
-        }
+        // Latest samples from the tap, or silence until something has played
+        if (! tap->readLatest (readBuffer, RING_BUFFER_READ_SIZE))
+            readBuffer.clear();
         
         jassert (OpenGLHelpers::isContextActive());
         
@@ -171,7 +174,7 @@ public:
             // Sum channels together
             for (int i = 0; i < 2; ++i)
             {
-                FloatVectorOperations::add (visualizationBuffer, tempBuffer.getReadPointer(i, 0), RING_BUFFER_READ_SIZE);
+                FloatVectorOperations::add (visualizationBuffer, readBuffer.getReadPointer(i, 0), RING_BUFFER_READ_SIZE);
             }
             
             uniforms->audioSampleData->set (visualizationBuffer, 256);
@@ -346,12 +349,16 @@ private:
 
     
     // Audio Buffer
-    RingBuffer<GLfloat> * ringBuffer;
-    AudioBuffer<GLfloat> readBuffer;    // Stores data read from ring buffer
+    AudioTap::Subscription tap;
+    AudioBuffer<GLfloat> readBuffer;    // Stores data read from the tap
     GLfloat visualizationBuffer [RING_BUFFER_READ_SIZE];    // Single channel to visualize
     
     
     
+    // Written on the GL thread before triggerAsyncUpdate(), read in handleAsyncUpdate()
+    String rendererName;
+    bool rendererReported = false;
+    
     // Overlay GUI
     String statusText;
     Label statusLabel;
@@ -0,0 +1,171 @@
+#include "PeakCache.h"
+
+namespace
+{
+    constexpr juce::int32 peakFileMagic = 0x4b505343;  // "CSPK"
+    constexpr juce::int32 peakFileVersion = 1;
+
+    juce::int8 toPeakValue (float v)
+    {
+        return (juce::int8) juce::jlimit (-127, 127, juce::roundToInt (v * 127.0f));
+    }
+}
+
+void PeakCache::prepare (double newSampleRate, juce::int64 newLengthInSamples)
+{
+    sampleRate = newSampleRate;
+    lengthInSamples = newLengthInSamples;
+
+    const auto expectedPeaks = (size_t) (newLengthInSamples / samplesPerPeak + 1);
+    mins.clear();
+    maxs.clear();
+    mins.reserve (expectedPeaks);
+    maxs.reserve (expectedPeaks);
+
+    currentFill = 0;
+}
+
+void PeakCache::addSamples (const float* samples, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const int num = juce::jmin (numSamples, samplesPerPeak - currentFill);
+        const auto range = juce::FloatVectorOperations::findMinAndMax (samples, num);
+
+        if (currentFill == 0)
+        {
+            currentMin = range.getStart();
+            currentMax = range.getEnd();
+        }
+        else
+        {
+            currentMin = juce::jmin (currentMin, range.getStart());
+            currentMax = juce::jmax (currentMax, range.getEnd());
+        }
+
+        currentFill += num;
+        samples += num;
+        numSamples -= num;
+
+        if (currentFill == samplesPerPeak)
+            flushCurrentPeak();
+    }
+
+    // Make sure the tail end of the file ends up in the last peak
+    if (currentFill > 0 && (juce::int64) mins.size() * samplesPerPeak + currentFill >= lengthInSamples)
+        flushCurrentPeak();
+}
+
+void PeakCache::flushCurrentPeak()
+{
+    mins.push_back (toPeakValue (currentMin));
+    maxs.push_back (toPeakValue (currentMax));
+    currentFill = 0;
+}
+
+void PeakCache::draw (juce::Graphics& g, juce::Rectangle<int> area, double startSeconds, double endSeconds) const
+{
+    if (mins.empty() || area.isEmpty() || endSeconds <= startSeconds)
+        return;
+
+    const double peaksPerSecond = sampleRate / samplesPerPeak;
+    const double peaksPerPixel = (endSeconds - startSeconds) * peaksPerSecond / area.getWidth();
+    const float centreY = (float) area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+    const int numPeaks = (int) mins.size();
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        const int first = (int) (startSeconds * peaksPerSecond + x * peaksPerPixel);
+        const int last = juce::jmax (first + 1, (int) (startSeconds * peaksPerSecond + (x + 1) * peaksPerPixel));
+
+        if (first >= numPeaks)
+            break;
+
+        int lo = 127, hi = -127;
+
+        for (int i = juce::jmax (0, first); i < juce::jmin (last, numPeaks); ++i)
+        {
+            lo = juce::jmin (lo, (int) mins[(size_t) i]);
+            hi = juce::jmax (hi, (int) maxs[(size_t) i]);
+        }
+
+        if (lo > hi)
+            continue;
+
+        g.drawVerticalLine (area.getX() + x,
+                            centreY - hi / 127.0f * halfHeight,
+                            centreY - lo / 127.0f * halfHeight + 1.0f);
+    }
+}
+
+//==============================================================================
+juce::File PeakCache::getCacheFileFor (const juce::File& audioFile)
+{
+    return juce::File::getSpecialLocation (juce::File::userMusicDirectory)
+             .getChildFile ("ChopShop").getChildFile ("Peaks")
+             .getChildFile (juce::String::toHexString (audioFile.getFullPathName().hashCode64()) + ".peaks");
+}
+
+std::unique_ptr<PeakCache> PeakCache::loadFor (const juce::File& audioFile)
+{
+    juce::FileInputStream in (getCacheFileFor (audioFile));
+
+    if (! in.openedOk())
+        return {};
+
+    if (in.readInt() != peakFileMagic || in.readInt() != peakFileVersion)
+        return {};
+
+    // Stale if the audio file has been replaced since the peaks were made
+    if (in.readInt64() != audioFile.getSize()
+         || in.readInt64() != audioFile.getLastModificationTime().toMilliseconds())
+        return {};
+
+    auto cache = std::make_unique<PeakCache>();
+    cache->sampleRate = in.readDouble();
+    cache->lengthInSamples = in.readInt64();
+    const int numPeaks = in.readInt();
+
+    if (numPeaks < 0 || cache->sampleRate <= 0.0 || in.getNumBytesRemaining() < (juce::int64) numPeaks * 2)
+        return {};
+
+    cache->mins.resize ((size_t) numPeaks);
+    cache->maxs.resize ((size_t) numPeaks);
+    in.read (cache->mins.data(), numPeaks);
+    in.read (cache->maxs.data(), numPeaks);
+
+    return cache;
+}
+
+bool PeakCache::saveFor (const juce::File& audioFile) const
+{
+    auto cacheFile = getCacheFileFor (audioFile);
+    cacheFile.getParentDirectory().createDirectory();
+
+    // Write to a temporary and swap it in, so a reader never sees half a file
+    juce::TemporaryFile temp (cacheFile);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        out.writeInt (peakFileMagic);
+        out.writeInt (peakFileVersion);
+        out.writeInt64 (audioFile.getSize());
+        out.writeInt64 (audioFile.getLastModificationTime().toMilliseconds());
+        out.writeDouble (sampleRate);
+        out.writeInt64 (lengthInSamples);
+        out.writeInt ((int) mins.size());
+        out.write (mins.data(), mins.size());
+        out.write (maxs.data(), maxs.size());
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
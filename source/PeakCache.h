@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+
+#include <vector>
+
+/** A compact min/max overview of a file's waveform, written during analysis
+    and kept in a sidecar file so the waveform display never has to decode
+    the audio itself.
+
+    Peaks are stored as 8-bit min/max pairs of the mono mix, one pair per
+    samplesPerPeak input samples.
+*/
+class PeakCache
+{
+public:
+    static constexpr int samplesPerPeak = 256;
+
+    PeakCache() = default;
+
+    /** Starts a new cache for a stream of the given length. */
+    void prepare (double sampleRate, juce::int64 lengthInSamples);
+
+    /** Folds mono samples into the running peaks. */
+    void addSamples (const float* samples, int numSamples);
+
+    double getSampleRate() const noexcept           { return sampleRate; }
+    double getLengthInSeconds() const noexcept      { return sampleRate > 0.0 ? (double) lengthInSamples / sampleRate : 0.0; }
+    int getNumPeaks() const noexcept                { return (int) mins.size(); }
+
+    /** Draws the section between the given times, one vertical line per pixel. */
+    void draw (juce::Graphics&, juce::Rectangle<int> area, double startSeconds, double endSeconds) const;
+
+    //==============================================================================
+    /** Where the cache for an audio file lives (under ~/Music/ChopShop/Peaks). */
+    static juce::File getCacheFileFor (const juce::File& audioFile);
+
+    /** Loads the cache for an audio file, or returns nothing if there isn't one
+        or the audio file has changed since it was written.
+    */
+    static std::unique_ptr<PeakCache> loadFor (const juce::File& audioFile);
+
+    bool saveFor (const juce::File& audioFile) const;
+
+private:
+    double sampleRate = 0.0;
+    juce::int64 lengthInSamples = 0;
+
+    std::vector<juce::int8> mins, maxs;
+
+    float currentMin = 0.0f, currentMax = 0.0f;
+    int currentFill = 0;
+
+    void flushCurrentPeak();
+
+    JUCE_LEAK_DETECTOR (PeakCache)
+};
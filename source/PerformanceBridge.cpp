@@ -0,0 +1,193 @@
+#include "PerformanceBridge.h"
+
+//==============================================================================
+PerformanceBridge::PerformanceBridge (tracktion::engine::Edit& e)
+    : edit (e)
+{
+}
+
+bool PerformanceBridge::post (const PerformanceCommand& command)
+{
+    if (commands.push (command))
+        return true;
+
+    numDroppedCommands.fetch_add (1, std::memory_order_relaxed);
+    return false;
+}
+
+void PerformanceBridge::setDeckTarget (int deck, tracktion::engine::ChopVoicesPlugin* voices)
+{
+    if (juce::isPositiveAndBelow (deck, PerformanceState::maxDecks))
+        deckTargets[(size_t) deck] = voices;
+}
+
+void PerformanceBridge::setHotCueTarget (tracktion::engine::HotCuePlugin* hotCues)
+{
+    hotCueTarget = hotCues;
+}
+
+const PerformanceState& PerformanceBridge::getState()
+{
+    state.update();
+    return state.read();
+}
+
+void PerformanceBridge::startSceneMorph (const SceneMorph& newMorph)
+{
+    sceneMorphs.getWriteBuffer() = newMorph;
+    sceneMorphs.publish();
+}
+
+//==============================================================================
+void PerformanceBridge::apply (const PerformanceCommand& command)
+{
+    using Type = PerformanceCommand::Type;
+
+    switch (command.type)
+    {
+        case Type::chopVoiceGain:
+        case Type::chopVoiceOffset:
+        case Type::deckLevel:
+        {
+            if (! juce::isPositiveAndBelow (command.deck, PerformanceState::maxDecks))
+                break;
+
+            auto voices = deckTargets[(size_t) command.deck].load (std::memory_order_acquire);
+
+            if (voices == nullptr)
+                break;
+
+            if (command.type == Type::chopVoiceGain)
+                voices->setVoiceGain (command.index, (float) command.value);
+            else if (command.type == Type::chopVoiceOffset)
+                voices->setVoiceOffset (command.index, command.value);
+            else
+                voices->setOutputLevel ((float) command.value);
+
+            break;
+        }
+
+        case Type::triggerHotCue:
+        case Type::startLoopRoll:
+        case Type::stopLoopRoll:
+        {
+            auto hotCues = hotCueTarget.load (std::memory_order_acquire);
+
+            if (hotCues == nullptr)
+                break;
+
+            if (command.type == Type::triggerHotCue)
+                hotCues->triggerCue (command.index);
+            else if (command.type == Type::startLoopRoll)
+                hotCues->startLoopRoll (command.value);
+            else
+                hotCues->stopLoopRoll();
+
+            break;
+        }
+    }
+}
+
+void PerformanceBridge::advanceSceneMorph (int numSamples)
+{
+    if (sceneMorphs.update())
+    {
+        // Stays valid until the next update(), which only this thread calls
+        morph = &sceneMorphs.read();
+        morphProgress = 0.0;
+        currentScene = morph->from;
+    }
+
+    if (morph == nullptr)
+        return;
+
+    // Only this thread writes the live sequence, so a release can't be undone
+    // by a block that was already under way
+    if (morph->sequence == releasedSequence.load (std::memory_order_acquire))
+    {
+        morphProgress = 1.0;
+        liveScene.sequence.store (0, std::memory_order_release);
+        return;
+    }
+
+    if (morphProgress >= 1.0)
+        return;
+
+    // Counted in beats at the tempo the morph has reached, so a scene that
+    // moves the screw still lands on the beat it was asked for
+    if (morph->lengthBeats > 0.0)
+    {
+        const double beatsPerSecond = morph->baseBpm * currentScene.tempoRatio / 60.0;
+        morphProgress += numSamples / sampleRate * beatsPerSecond / morph->lengthBeats;
+    }
+    else
+    {
+        morphProgress = 1.0;
+    }
+
+    morphProgress = juce::jmin (1.0, morphProgress);
+    Scene::interpolate (morph->from, morph->to, (float) morphProgress, currentScene);
+
+    for (int i = 0; i < currentScene.numParameters; ++i)
+        liveScene.values[(size_t) i].store (currentScene.values[(size_t) i], std::memory_order_relaxed);
+
+    liveScene.sequence.store (morph->sequence, std::memory_order_release);
+}
+
+void PerformanceBridge::publishState()
+{
+    auto& snapshot = state.getWriteBuffer();
+
+    if (auto* epc = edit.getCurrentPlaybackContext())
+    {
+        snapshot.positionSeconds = epc->getPosition().inSeconds();
+        snapshot.isPlaying = epc->isPlaying();
+    }
+
+    auto hotCues = hotCueTarget.load (std::memory_order_acquire);
+    snapshot.isRolling = hotCues != nullptr && hotCues->isRolling();
+
+    for (size_t deck = 0; deck < deckTargets.size(); ++deck)
+    {
+        auto voices = deckTargets[deck].load (std::memory_order_acquire);
+        snapshot.deckLevels[deck] = voices != nullptr ? voices->getOutputLevel() : 0.0f;
+
+        for (int voice = 0; voice < PerformanceState::maxVoices; ++voice)
+            snapshot.voiceGains[deck][(size_t) voice] = voices != nullptr ? voices->getVoiceGain (voice) : 0.0f;
+    }
+
+    snapshot.scene = currentScene;
+    snapshot.sceneSequence = morph != nullptr ? morph->sequence : 0;
+    snapshot.isMorphing = morph != nullptr && morphProgress < 1.0;
+
+    snapshot.numBlocks = ++numBlocks;
+    snapshot.numDroppedCommands = numDroppedCommands.load (std::memory_order_relaxed);
+
+    state.publish();
+}
+
+void PerformanceBridge::audioDeviceAboutToStart (juce::AudioIODevice* device)
+{
+    if (device != nullptr && device->getCurrentSampleRate() > 0.0)
+        sampleRate = device->getCurrentSampleRate();
+}
+
+void PerformanceBridge::audioDeviceIOCallbackWithContext (const float* const*, int,
+                                                          float* const* outputChannelData, int numOutputChannels,
+                                                          int numSamples, const juce::AudioIODeviceCallbackContext&)
+{
+    // Tracktion has already rendered this block, so everything queued so far
+    // takes effect together from the start of the next one
+    PerformanceCommand command;
+
+    while (commands.pop (command))
+        apply (command);
+
+    advanceSceneMorph (numSamples);
+    publishState();
+
+    // The device manager mixes every callback's output; this one adds nothing
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+        if (outputChannelData[ch] != nullptr)
+            juce::FloatVectorOperations::clear (outputChannelData[ch], numSamples);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "ChopVoicesPlugin.h"
+#include "HotCuePlugin.h"
+#include "CommandQueue.h"
+#include "TripleBuffer.h"
+#include "Scene.h"
+
+#include <array>
+
+//==============================================================================
+/** One performance gesture on its way from the UI or an input device to the
+    audio engine.
+*/
+struct PerformanceCommand
+{
+    enum class Type
+    {
+        chopVoiceGain,      // deck, index = voice, value = linear gain
+        chopVoiceOffset,    // deck, index = voice, value = beats behind the live signal
+        deckLevel,          // deck, value = linear gain
+        triggerHotCue,      // index = slot
+        startLoopRoll,      // value = length in beats
+        stopLoopRoll
+    };
+
+    Type type = Type::chopVoiceGain;
+    int deck = 0;
+    int index = 0;
+    double value = 0.0;
+};
+
+//==============================================================================
+/** What the audio engine was doing at the end of its last block. */
+struct PerformanceState
+{
+    static constexpr int maxDecks = 4;
+    static constexpr int maxVoices = tracktion::engine::ChopVoicesPlugin::maxVoices;
+
+    double positionSeconds = 0.0;
+    bool isPlaying = false;
+    bool isRolling = false;
+
+    std::array<float, maxDecks> deckLevels {};
+    std::array<std::array<float, maxVoices>, maxDecks> voiceGains {};
+
+    // Where the last scene morph has got to, and which morph it was
+    Scene scene;
+    juce::uint32 sceneSequence = 0;
+    bool isMorphing = false;
+
+    juce::uint32 numBlocks = 0;
+    juce::uint32 numDroppedCommands = 0;
+};
+
+//==============================================================================
+/** The one way performance controls reach the audio engine, and the one way
+    the UI hears back from it.
+
+    Keyboard, mouse, gamepad and MIDI handlers post typed commands into a
+    fixed-size lock-free queue from whatever thread they run on. Once per audio
+    callback, after Tracktion has rendered the block, the bridge drains the
+    queue in order and hands each command to its target plugin, so every
+    change lands on a block boundary and the next block sees all of them. The
+    bridge then publishes a snapshot of the engine state through a triple
+    buffer for the UI timer to draw from.
+
+    Scene morphs arrive through a triple buffer of their own. The bridge
+    blends the two scenes a little further each block into the LiveScene,
+    which the effect plugins play from on their next block, and publishes
+    the result with the rest of the state so the SceneMemory can move the
+    sliders along and set the parameters once the morph is over.
+
+    Register it with the device manager after the engine so it runs after
+    Tracktion's callback. Targets must outlive the bridge's registration.
+*/
+class PerformanceBridge  : public juce::AudioIODeviceCallback
+{
+public:
+    explicit PerformanceBridge (tracktion::engine::Edit&);
+
+    //==============================================================================
+    /** Queues a command for the next block boundary. Safe from any thread;
+        returns false, and counts a dropped command, if the queue is full.
+    */
+    bool post (const PerformanceCommand&);
+
+    /** Message thread: where each kind of command goes. */
+    void setDeckTarget (int deck, tracktion::engine::ChopVoicesPlugin*);
+    void setHotCueTarget (tracktion::engine::HotCuePlugin*);
+
+    /** Message thread: the latest snapshot from the audio thread. */
+    const PerformanceState& getState();
+
+    /** Message thread: hands a scene morph to the audio thread, which blends
+        it block by block from the start of the next one. Arming it is a copy
+        into a buffer the audio thread isn't using and one atomic swap.
+    */
+    void startSceneMorph (const SceneMorph&);
+
+    /** The blended scene, for SceneFollower plugins to read on the audio thread. */
+    const LiveScene& getLiveScene() const noexcept      { return liveScene; }
+
+    /** Message thread: the parameters now hold where the morph ended, so the
+        plugins can go back to them from the next block.
+    */
+    void releaseScene (juce::uint32 sequence)           { releasedSequence = sequence; }
+
+    //==============================================================================
+    void audioDeviceIOCallbackWithContext (const float* const*, int,
+                                           float* const* outputChannelData, int numOutputChannels,
+                                           int numSamples, const juce::AudioIODeviceCallbackContext&) override;
+    void audioDeviceAboutToStart (juce::AudioIODevice*) override;
+    void audioDeviceStopped() override {}
+
+private:
+    static constexpr int commandQueueSize = 256;
+
+    void apply (const PerformanceCommand&);
+    void advanceSceneMorph (int numSamples);
+    void publishState();
+
+    tracktion::engine::Edit& edit;
+
+    CommandQueue<PerformanceCommand, commandQueueSize> commands;
+    TripleBuffer<PerformanceState> state;
+    TripleBuffer<SceneMorph> sceneMorphs;
+    LiveScene liveScene;
+    std::atomic<juce::uint32> releasedSequence { 0 };
+
+    std::array<std::atomic<tracktion::engine::ChopVoicesPlugin*>, PerformanceState::maxDecks> deckTargets {};
+    std::atomic<tracktion::engine::HotCuePlugin*> hotCueTarget { nullptr };
+    std::atomic<juce::uint32> numDroppedCommands { 0 };
+
+    // Audio thread only
+    juce::uint32 numBlocks = 0;
+    double sampleRate = 44100.0;
+    const SceneMorph* morph = nullptr;      // the reader's copy in sceneMorphs
+    double morphProgress = 1.0;
+    Scene currentScene;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PerformanceBridge)
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <juce_data_structures/juce_data_structures.h>
+
+//==============================================================================
+/** Parameters that are performed rather than edited.
+
+    Tracktion's plugins keep their values in CachedValues bound to the edit's
+    undo manager, so every knob twist, brake and crossfade during a set would
+    add another undoable action to a history ChopShop never uses. Anything the
+    performer moves live is rebound here to the same property with no undo
+    manager, so it costs a property write and nothing more.
+
+    These can't go the way of EffectReturnPlugin's level, held in the
+    parameter and only written to the state on save: the reverb's DSP is
+    Tracktion's, and it reads the CachedValues themselves, and the flanger,
+    delay and phaser keep their Tracktion bases' attached values, so the
+    property is still where their state is saved from.
+*/
+namespace PerformanceParameters
+{
+    /** Rebinds each value to its current property without an undo manager. */
+    template <typename... Types>
+    inline void stopUndoing (juce::CachedValue<Types>&... values)
+    {
+        (values.referTo (values.getValueTree(), values.getPropertyID(), nullptr, values.getDefault()), ...);
+    }
+}
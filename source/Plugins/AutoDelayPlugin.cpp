@@ -0,0 +1,61 @@
+#include "AutoDelayPlugin.h"
+
+void AutoDelayPlugin::initialise(const PluginInitialisationInfo& info)
+{
+    sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+
+    // The graph gets rebuilt whenever clips change; only reallocate when the
+    // size actually changes so the echoes don't drop out
+    const int bufferSize = (int) std::ceil(maxLengthMs * sampleRate / 1000.0) + 1;
+
+    if (delayBuffer.getNumSamples() != bufferSize)
+    {
+        delayBuffer.setSize(2, bufferSize);
+        delayBuffer.clear();
+        writePosition = 0;
+    }
+}
+
+void AutoDelayPlugin::applyToBuffer(const PluginRenderContext& rc)
+{
+    if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0 || delayBuffer.getNumSamples() == 0)
+        return;
+
+    // Read once a block, from the scene while one is being morphed in
+    const float lengthMs = juce::jlimit(0.0f, maxLengthMs, getFollowedValue(lengthFollowed));
+    const float feedbackDb = getFollowedValue(feedbackFollowed);
+    const float mix = juce::jlimit(0.0f, 1.0f, getFollowedValue(mixFollowed));
+
+    const float feedback = feedbackDb <= minFeedbackDb ? 0.0f : juce::jmin(1.0f, juce::Decibels::decibelsToGain(feedbackDb));
+
+    auto& buffer = *rc.destBuffer;
+    const int numChannels = juce::jmin(buffer.getNumChannels(), delayBuffer.getNumChannels());
+    const int bufferSize = delayBuffer.getNumSamples();
+    const int delaySamples = juce::jlimit(1, bufferSize - 1, juce::roundToInt(lengthMs * sampleRate / 1000.0));
+
+    int position = writePosition;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* samples = buffer.getWritePointer(ch, rc.bufferStartSample);
+        auto* delayed = delayBuffer.getWritePointer(ch);
+        position = writePosition;
+
+        for (int i = 0; i < rc.bufferNumSamples; ++i)
+        {
+            int readPosition = position - delaySamples;
+
+            if (readPosition < 0)
+                readPosition += bufferSize;
+
+            const float echo = delayed[readPosition];
+            delayed[position] = samples[i] + echo * feedback;
+            samples[i] += echo * mix;
+
+            if (++position == bufferSize)
+                position = 0;
+        }
+    }
+
+    writePosition = position;
+}
@@ -2,9 +2,16 @@
 
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "../PerformanceParameters.h"
+#include "../SceneFollower.h"
+
 using namespace tracktion::engine;
 
-class AutoDelayPlugin : public DelayPlugin
+/** Tracktion's delay with a free length in milliseconds, and its own delay
+    line so a scene morph can move it from the audio thread.
+*/
+class AutoDelayPlugin : public DelayPlugin,
+                        public SceneFollower
 {
 public:
     AutoDelayPlugin(PluginCreationInfo info)
@@ -14,9 +21,19 @@ public:
                          [] (float value) { return juce::String(value, 1) + " ms"; },
                          [] (const juce::String& s) { return s.getFloatValue(); });
 
-        auto um = getUndoManager();
-        length.referTo(state, IDs::length, um, 0.0f);
+        // Played live, so kept out of the undo history along with the base delay's values
+        length.referTo(state, IDs::length, nullptr, 0.0f);
         autoLengthMs->attachToCurrentValue(length);
+        PerformanceParameters::stopUndoing(feedbackValue, mixValue);
+
+        feedbackParam = getAutomatableParameterByID("feedback");
+        mixParam = getAutomatableParameterByID("mix proportion");
+        jassert(feedbackParam != nullptr && mixParam != nullptr);
+
+        minFeedbackDb = feedbackParam->getValueRange().getStart();
+        lengthFollowed = follow(*autoLengthMs);
+        feedbackFollowed = follow(*feedbackParam);
+        mixFollowed = follow(*mixParam);
     }
 
     ~AutoDelayPlugin() override
@@ -32,13 +49,28 @@ public:
     juce::String getShortName(int) override            { return getName(); }
     juce::String getSelectableDescription() override   { return TRANS("Auto Delay Plugin"); }
 
+    void initialise(const PluginInitialisationInfo&) override;
+    void deinitialise() override {}
+    void applyToBuffer(const PluginRenderContext&) override;
+
     void setLength(float value)    { autoLengthMs->setParameter(juce::jlimit(0.0f, 1000.0f, value), juce::sendNotification); }
     float getLength()              { return autoLengthMs->getCurrentValue(); }
 
     AutomatableParameter::Ptr autoLengthMs;
 
 private:
+    static constexpr float maxLengthMs = 1000.0f;
+
     juce::CachedValue<float> length;
+    AutomatableParameter::Ptr feedbackParam, mixParam;
+    float minFeedbackDb = -30.0f;       // the bottom of the feedback range, which turns it off
+
+    int lengthFollowed = 0, feedbackFollowed = 0, mixFollowed = 0;
+
+    // Audio thread only
+    double sampleRate = 44100.0;
+    juce::AudioBuffer<float> delayBuffer;
+    int writePosition = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutoDelayPlugin)
 };
@@ -0,0 +1,63 @@
+#include "AutoPhaserPlugin.h"
+
+void AutoPhaserPlugin::initialise(const PluginInitialisationInfo& info)
+{
+  sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+}
+
+void AutoPhaserPlugin::applyToBuffer(const PluginRenderContext& rc)
+{
+  if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0)
+    return;
+
+  // Read once a block, from the scene while one is being morphed in
+  const float depth = juce::jlimit(0.0f, 10.0f, getFollowedValue(depthFollowed));
+  const float rate = juce::jlimit(0.0f, 10.0f, getFollowedValue(rateFollowed));
+  const float feedback = juce::jlimit(0.0f, 0.95f, getFollowedValue(feedbackFollowed));
+
+  auto& buffer = *rc.destBuffer;
+  const int numChannels = juce::jmin(buffer.getNumChannels(), (int) stageStates.size());
+
+  // Depth is the width of the sweep in half-octaves above the lowest notch
+  const float maxFrequency = (float) sampleRate * 0.45f;
+  const float phaseStep = (float) (juce::MathConstants<double>::twoPi * rate / sampleRate);
+
+  for (int start = 0; start < rc.bufferNumSamples; start += coefficientInterval)
+  {
+    const int numSamples = juce::jmin(coefficientInterval, rc.bufferNumSamples - start);
+
+    const float lfo = 0.5f * (1.0f + std::sin(phase));
+    const float frequency = juce::jmin(maxFrequency, minFrequency * std::exp2(0.5f * depth * lfo));
+    const float t = std::tan(juce::MathConstants<float>::pi * frequency / (float) sampleRate);
+    const float coefficient = (t - 1.0f) / (t + 1.0f);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+      auto* samples = buffer.getWritePointer(ch, rc.bufferStartSample + start);
+      auto& states = stageStates[(size_t) ch];
+      float last = lastOutputs[(size_t) ch];
+
+      for (int i = 0; i < numSamples; ++i)
+      {
+        float x = samples[i] + feedback * last;
+
+        for (auto& state : states)
+        {
+          const float y = coefficient * x + state;
+          state = x - coefficient * y;
+          x = y;
+        }
+
+        last = x;
+        samples[i] = 0.5f * (samples[i] + x);
+      }
+
+      lastOutputs[(size_t) ch] = last;
+    }
+
+    phase += phaseStep * (float) numSamples;
+
+    if (phase >= juce::MathConstants<float>::twoPi)
+      phase -= juce::MathConstants<float>::twoPi;
+  }
+}
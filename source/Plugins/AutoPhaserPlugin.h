@@ -2,9 +2,18 @@
 
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "../PerformanceParameters.h"
+#include "../SceneFollower.h"
+
+#include <array>
+
 using namespace tracktion::engine;
 
-class AutoPhaserPlugin : public PhaserPlugin
+/** Tracktion's phaser with its own controls and its own allpass chain, so a
+    scene morph can move it from the audio thread.
+*/
+class AutoPhaserPlugin : public PhaserPlugin,
+                         public SceneFollower
 {
 public:
   AutoPhaserPlugin(PluginCreationInfo info)
@@ -22,9 +31,16 @@ public:
                                  { return juce::String(value); }, [](const juce::String &s)
                                  { return s.getFloatValue(); });
 
+    // Played live, so kept out of the undo history
+    PerformanceParameters::stopUndoing(depth, rate, feedbackGain);
+
     depthParam->attachToCurrentValue(depth);
     rateParam->attachToCurrentValue(rate);
     feedbackGainParam->attachToCurrentValue(feedbackGain);
+
+    depthFollowed = follow(*depthParam);
+    rateFollowed = follow(*rateParam);
+    feedbackFollowed = follow(*feedbackGainParam);
   }
 
   ~AutoPhaserPlugin() override
@@ -43,5 +59,24 @@ public:
   juce::String getShortName(int) override { return getName(); }
   juce::String getSelectableDescription() override { return TRANS("Auto Phaser Plugin"); }
 
+  void initialise(const PluginInitialisationInfo&) override;
+  void deinitialise() override {}
+  void applyToBuffer(const PluginRenderContext&) override;
+
   AutomatableParameter::Ptr depthParam, rateParam, feedbackGainParam;
+
+private:
+  static constexpr int numStages = 6;
+  static constexpr int coefficientInterval = 32;   // samples between sweep updates
+  static constexpr float minFrequency = 200.0f;
+
+  int depthFollowed = 0, rateFollowed = 0, feedbackFollowed = 0;
+
+  // Audio thread only
+  double sampleRate = 44100.0;
+  float phase = 0.0f;
+  std::array<std::array<float, numStages>, 2> stageStates{};
+  std::array<float, 2> lastOutputs{};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutoPhaserPlugin)
 };
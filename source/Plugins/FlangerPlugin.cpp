@@ -0,0 +1,69 @@
+#include "FlangerPlugin.h"
+
+void FlangerPlugin::initialise(const PluginInitialisationInfo& info)
+{
+    sampleRate = info.sampleRate > 0.0 ? info.sampleRate : 44100.0;
+
+    // The graph gets rebuilt whenever clips change; only reallocate when the
+    // size actually changes so the sweep doesn't drop out
+    const int bufferSize = (int) std::ceil((baseDelayMs + maxDepthMs) * sampleRate / 1000.0) + 2;
+
+    if (delayBuffer.getNumSamples() != bufferSize)
+    {
+        delayBuffer.setSize(2, bufferSize);
+        delayBuffer.clear();
+        writePosition = 0;
+    }
+}
+
+void FlangerPlugin::applyToBuffer(const PluginRenderContext& rc)
+{
+    if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0 || delayBuffer.getNumSamples() == 0)
+        return;
+
+    // Read once a block, from the scene while one is being morphed in
+    const float depth = juce::jlimit(0.0f, maxDepthMs, getFollowedValue(depthFollowed));
+    const float speed = juce::jmax(0.0f, getFollowedValue(speedFollowed));
+    const float stereoWidth = juce::jlimit(0.0f, 1.0f, getFollowedValue(widthFollowed));
+    const float mix = juce::jlimit(0.0f, 1.0f, getFollowedValue(mixFollowed));
+
+    auto& buffer = *rc.destBuffer;
+    const int numChannels = juce::jmin(buffer.getNumChannels(), delayBuffer.getNumChannels());
+    const int bufferSize = delayBuffer.getNumSamples();
+
+    const float minDelay = (float) (baseDelayMs * sampleRate / 1000.0);
+    const float sweep = (float) (depth * sampleRate / 1000.0);
+    const float phaseStep = (float) (juce::MathConstants<double>::twoPi * speed / sampleRate);
+
+    // The right channel's sweep trails the left by up to half a cycle
+    const float channelOffset = stereoWidth * juce::MathConstants<float>::pi;
+
+    for (int i = 0; i < rc.bufferNumSamples; ++i)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = buffer.getWritePointer(ch, rc.bufferStartSample);
+            auto* delayed = delayBuffer.getWritePointer(ch);
+
+            const float lfo = 0.5f * (1.0f + std::sin(phase + (float) ch * channelOffset));
+            float readPosition = (float) writePosition - (minDelay + sweep * lfo);
+
+            if (readPosition < 0.0f)
+                readPosition += (float) bufferSize;
+
+            const int index0 = (int) readPosition;
+            const int index1 = (index0 + 1) % bufferSize;
+            const float fraction = readPosition - (float) index0;
+            const float wet = delayed[index0] + fraction * (delayed[index1] - delayed[index0]);
+
+            delayed[writePosition] = samples[i];
+            samples[i] += mix * (wet - samples[i]);
+        }
+
+        writePosition = (writePosition + 1) % bufferSize;
+        phase += phaseStep;
+
+        if (phase >= juce::MathConstants<float>::twoPi)
+            phase -= juce::MathConstants<float>::twoPi;
+    }
+}
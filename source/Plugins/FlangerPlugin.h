@@ -2,9 +2,15 @@
 
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "../SceneFollower.h"
+
 using namespace tracktion::engine;
 
-class FlangerPlugin : public ChorusPlugin
+/** Tracktion's chorus with its own controls and its own sweep, so a scene
+    morph can move it from the audio thread.
+*/
+class FlangerPlugin : public ChorusPlugin,
+                      public SceneFollower
 {
 public:
     FlangerPlugin(PluginCreationInfo info) : ChorusPlugin(info)
@@ -24,18 +30,22 @@ public:
         mixParam = addParam("mix", TRANS("Mix"), {0.0f, 1.0f}, [](float value)
                             { return juce::String((int)(100.0f * value)) + "%"; }, [](const juce::String &s)
                             { return s.getFloatValue(); });
-        auto um = getUndoManager();
-
-        depthMs.referTo(state, IDs::depthMs, um, 3.0f);
-        speedHz.referTo(state, IDs::speedHz, um, 1.0f);
-        width.referTo(state, IDs::width, um, 0.5f);
-        mixProportion.referTo(state, IDs::mixProportion, um, 0.5f);
+        // Played live, so kept out of the undo history
+        depthMs.referTo(state, IDs::depthMs, nullptr, 3.0f);
+        speedHz.referTo(state, IDs::speedHz, nullptr, 1.0f);
+        width.referTo(state, IDs::width, nullptr, 0.5f);
+        mixProportion.referTo(state, IDs::mixProportion, nullptr, 0.5f);
 
         // Attach parameters to their values
         depthParam->attachToCurrentValue(depthMs);
         speedParam->attachToCurrentValue(speedHz);
         widthParam->attachToCurrentValue(width);
         mixParam->attachToCurrentValue(mixProportion);
+
+        depthFollowed = follow(*depthParam);
+        speedFollowed = follow(*speedParam);
+        widthFollowed = follow(*widthParam);
+        mixFollowed = follow(*mixParam);
     }
 
     ~FlangerPlugin() override
@@ -51,10 +61,9 @@ public:
     juce::String getShortName(int) override { return getName(); }
     juce::String getSelectableDescription() override { return TRANS("Flanger Plugin"); }
 
-    void initialise(const PluginInitialisationInfo& info) override 
-    { 
-        ChorusPlugin::initialise(info); 
-    }
+    void initialise(const PluginInitialisationInfo& info) override;
+    void deinitialise() override {}
+    void applyToBuffer(const PluginRenderContext& rc) override;
 
     void restorePluginStateFromValueTree(const juce::ValueTree& v) override 
     { 
@@ -77,5 +86,16 @@ public:
     float getMix() { return mixParam->getCurrentValue(); }
 
 private:
+    static constexpr float baseDelayMs = 20.0f;
+    static constexpr float maxDepthMs = 10.0f;
+
+    int depthFollowed = 0, speedFollowed = 0, widthFollowed = 0, mixFollowed = 0;
+
+    // Audio thread only
+    double sampleRate = 44100.0;
+    juce::AudioBuffer<float> delayBuffer;
+    int writePosition = 0;
+    float phase = 0.0f;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FlangerPlugin)
 };
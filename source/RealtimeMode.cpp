@@ -0,0 +1,387 @@
+#include "RealtimeMode.h"
+
+#include <cstring>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <sched.h>
+ #include <sys/mman.h>
+ #include <sys/resource.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+   #if JUCE_LINUX
+    juce::String describeLimit (rlim_t value)
+    {
+        return value == RLIM_INFINITY ? juce::String ("unlimited") : juce::String ((juce::int64) value);
+    }
+
+    int getCurrentThreadId() noexcept
+    {
+        // Cached, so a thread asking again costs nothing
+        thread_local const int id = (int) syscall (SYS_gettid);
+        return id;
+    }
+
+    //==============================================================================
+    /** Just enough of libdbus to ask RealtimeKit for a thread's priority. */
+    class RealtimeKit
+    {
+    public:
+        RealtimeKit()
+        {
+            library = dlopen ("libdbus-1.so.3", RTLD_NOW | RTLD_LOCAL);
+
+            if (library == nullptr)
+                return;
+
+            load (errorInit, "dbus_error_init");
+            load (errorIsSet, "dbus_error_is_set");
+            load (errorFree, "dbus_error_free");
+            load (busGetPrivate, "dbus_bus_get_private");
+            load (connectionClose, "dbus_connection_close");
+            load (connectionUnref, "dbus_connection_unref");
+            load (newMethodCall, "dbus_message_new_method_call");
+            load (appendArgs, "dbus_message_append_args");
+            load (sendWithReplyAndBlock, "dbus_connection_send_with_reply_and_block");
+            load (messageUnref, "dbus_message_unref");
+        }
+
+        ~RealtimeKit()
+        {
+            if (library != nullptr)
+                dlclose (library);
+        }
+
+        bool isAvailable() const noexcept
+        {
+            return errorInit && errorIsSet && errorFree && busGetPrivate && connectionClose && connectionUnref
+                && newMethodCall && appendArgs && sendWithReplyAndBlock && messageUnref;
+        }
+
+        /** Returns an empty string on success, otherwise what went wrong. */
+        juce::String makeThreadRealtime (int threadId, int priority)
+        {
+            if (! isAvailable())
+                return "libdbus not found";
+
+            Error error;
+            errorInit (&error);
+
+            auto* connection = busGetPrivate (busSystem, &error);
+
+            if (connection == nullptr)
+                return takeError (error, "no system bus");
+
+            juce::String result;
+            auto* message = newMethodCall ("org.freedesktop.RealtimeKit1", "/org/freedesktop/RealtimeKit1",
+                                           "org.freedesktop.RealtimeKit1", "MakeThreadRealtime");
+
+            juce::uint64 thread = (juce::uint64) threadId;
+            juce::uint32 requested = (juce::uint32) priority;
+
+            if (message != nullptr && appendArgs (message, typeUInt64, &thread, typeUInt32, &requested, typeInvalid))
+            {
+                if (auto* reply = sendWithReplyAndBlock (connection, message, 1000, &error))
+                    messageUnref (reply);
+                else
+                    result = takeError (error, "no reply");
+            }
+            else
+            {
+                result = "couldn't build the request";
+            }
+
+            if (message != nullptr)
+                messageUnref (message);
+
+            connectionClose (connection);
+            connectionUnref (connection);
+            return result;
+        }
+
+    private:
+        // Matches DBusError's layout: two strings, a word of flags and a pointer
+        struct Error
+        {
+            const char* name;
+            const char* message;
+            unsigned int flags;
+            void* padding;
+        };
+
+        static constexpr int busSystem = 1;
+        static constexpr int typeInvalid = 0, typeUInt32 = 'u', typeUInt64 = 't';
+
+        template <typename Function>
+        void load (Function& function, const char* name)
+        {
+            function = reinterpret_cast<Function> (dlsym (library, name));
+        }
+
+        juce::String takeError (Error& error, const char* fallback)
+        {
+            juce::String text = errorIsSet (&error) && error.message != nullptr ? juce::String (error.message)
+                                                                               : juce::String (fallback);
+            errorFree (&error);
+            return text;
+        }
+
+        void* library = nullptr;
+
+        void (*errorInit) (Error*) = nullptr;
+        unsigned int (*errorIsSet) (const Error*) = nullptr;
+        void (*errorFree) (Error*) = nullptr;
+        void* (*busGetPrivate) (int, Error*) = nullptr;
+        void (*connectionClose) (void*) = nullptr;
+        void (*connectionUnref) (void*) = nullptr;
+        void* (*newMethodCall) (const char*, const char*, const char*, const char*) = nullptr;
+        unsigned int (*appendArgs) (void*, int, ...) = nullptr;
+        void* (*sendWithReplyAndBlock) (void*, void*, int, Error*) = nullptr;
+        void (*messageUnref) (void*) = nullptr;
+    };
+   #endif
+
+    const char* getRoleName (RealtimeMode::Role role)
+    {
+        return role == RealtimeMode::Role::audio ? "audio" : "input";
+    }
+}
+
+//==============================================================================
+RealtimeMode::Options RealtimeMode::Options::fromCommandLine (const juce::String& commandLine)
+{
+    const auto args = juce::StringArray::fromTokens (commandLine, true);
+
+    Options options;
+    options.enabled = ! args.contains ("--no-realtime");
+    options.lockMemory = args.contains ("--lock-memory");
+    return options;
+}
+
+RealtimeMode::RealtimeMode()  : juce::Thread ("ChopShop RT Promoter")
+{
+}
+
+RealtimeMode::~RealtimeMode()
+{
+    shutdown();
+}
+
+void RealtimeMode::shutdown()
+{
+    enabled = false;
+    signalThreadShouldExit();
+    promotionRequested.signal();
+    stopThread (2000);
+}
+
+void RealtimeMode::log (const juce::String& line)
+{
+    {
+        const juce::ScopedLock sl (reportLock);
+        report.add (line);
+    }
+
+    juce::Logger::writeToLog ("Real-time: " + line);
+}
+
+juce::String RealtimeMode::getReport() const
+{
+    const juce::ScopedLock sl (reportLock);
+    return report.joinIntoString ("\n");
+}
+
+//==============================================================================
+juce::String RealtimeMode::enable (const Options& options)
+{
+   #if JUCE_LINUX
+    if (! options.enabled)
+    {
+        log ("off (--no-realtime)");
+        return getReport();
+    }
+
+    // Take whatever real-time priority we're allowed without asking anyone
+    rlimit limit {};
+
+    if (getrlimit (RLIMIT_RTPRIO, &limit) == 0)
+    {
+        if (limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit (RLIMIT_RTPRIO, &limit);
+        }
+
+        log ("RLIMIT_RTPRIO " + describeLimit (limit.rlim_cur)
+             + (limit.rlim_cur >= (rlim_t) audioPriority ? ", enough for SCHED_FIFO"
+                                                          : ", will ask RealtimeKit"));
+    }
+
+    // RealtimeKit refuses threads that could spin forever: cap a real-time
+    // burst at 200 ms, far beyond any audio block
+    if (getrlimit (RLIMIT_RTTIME, &limit) == 0 && (limit.rlim_max == RLIM_INFINITY || limit.rlim_max > 200000))
+    {
+        limit.rlim_cur = limit.rlim_max = 200000;
+        setrlimit (RLIMIT_RTTIME, &limit);
+    }
+
+    if (options.lockMemory)
+    {
+        if (getrlimit (RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit (RLIMIT_MEMLOCK, &limit);
+        }
+
+        if (mlockall (MCL_CURRENT | MCL_FUTURE) == 0)
+            log ("memory locked");
+        else
+            log ("memory not locked: " + juce::String (strerror (errno))
+                 + " (RLIMIT_MEMLOCK " + describeLimit (limit.rlim_cur) + ")");
+    }
+    else
+    {
+        log ("memory not locked (--lock-memory to lock it); buffers are prefaulted instead");
+    }
+
+    enabled = true;
+    startThread (juce::Thread::Priority::low);
+   #else
+    juce::ignoreUnused (options);
+    log ("only available on Linux");
+   #endif
+
+    return getReport();
+}
+
+void RealtimeMode::requestPromotion ([[maybe_unused]] Role role) noexcept
+{
+   #if JUCE_LINUX
+    if (! enabled.load (std::memory_order_relaxed))
+        return;
+
+    const int threadId = getCurrentThreadId();
+
+    for (int i = 0; i < maxPending; ++i)
+    {
+        int expected = 0;
+
+        if (pendingThreads[(size_t) i].compare_exchange_strong (expected, threadId))
+        {
+            pendingRoles[(size_t) i] = (int) role;
+            pendingThreads[(size_t) i] = -threadId;     // ready to be picked up
+            promotionRequested.signal();
+            return;
+        }
+    }
+   #endif
+}
+
+void RealtimeMode::run()
+{
+    while (! threadShouldExit())
+    {
+        promotionRequested.wait (-1);
+
+        for (int i = 0; i < maxPending; ++i)
+        {
+            const int pending = pendingThreads[(size_t) i].load();
+
+            if (pending >= 0)
+                continue;
+
+            const auto role = (Role) pendingRoles[(size_t) i].load();
+            pendingThreads[(size_t) i] = 0;
+
+            promote (-pending, role);
+        }
+    }
+}
+
+void RealtimeMode::promote ([[maybe_unused]] int threadId, [[maybe_unused]] Role role)
+{
+   #if JUCE_LINUX
+    const int priority = role == Role::audio ? audioPriority : inputPriority;
+    const auto name = juce::String (getRoleName (role)) + " thread " + juce::String (threadId);
+
+    sched_param param {};
+    param.sched_priority = priority;
+
+    // Linux applies this to the one thread when given a thread ID
+    if (sched_setscheduler (threadId, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) == 0)
+    {
+        log (name + ": SCHED_FIFO " + juce::String (priority));
+        return;
+    }
+
+    const juce::String directError (strerror (errno));
+
+    // RealtimeKit caps priorities, at 20 by default
+    static RealtimeKit realtimeKit;
+    const int kitPriority = role == Role::audio ? 20 : 19;
+    const auto kitError = realtimeKit.makeThreadRealtime (threadId, kitPriority);
+
+    if (kitError.isEmpty())
+        log (name + ": SCHED_RR " + juce::String (kitPriority) + " via RealtimeKit");
+    else
+        log (name + ": not real-time (" + directError + "; RealtimeKit: " + kitError + ")");
+   #endif
+}
+
+//==============================================================================
+void RealtimeMode::prefault (void* data, size_t numBytes) noexcept
+{
+    if (data == nullptr || numBytes == 0)
+        return;
+
+    // A read of a page nothing has written yet only maps the shared zero page,
+    // and the first write still faults, so write to every page; the volatile
+    // keeps the stores from being optimised away
+    const size_t pageSize = 4096;
+    auto* bytes = static_cast<volatile char*> (data);
+
+    for (size_t i = 0; i < numBytes; i += pageSize)
+        bytes[i] = 0;
+
+    bytes[numBytes - 1] = 0;
+}
+
+void RealtimeMode::prefaultStack() noexcept
+{
+    constexpr size_t stackBytes = 128 * 1024;
+    volatile char stack[stackBytes];
+
+    for (size_t i = 0; i < stackBytes; i += 4096)
+        stack[i] = 0;
+}
+
+void RealtimeMode::prefaultFile (const juce::File& file)
+{
+   #if JUCE_LINUX
+    const int fd = open (file.getFullPathName().toRawUTF8(), O_RDONLY);
+
+    if (fd < 0)
+        return;
+
+    posix_fadvise (fd, 0, 0, POSIX_FADV_WILLNEED);
+
+    // fadvise is only a hint, so read it through as well
+    juce::HeapBlock<char> chunk (1 << 20);
+
+    while (read (fd, chunk.get(), 1 << 20) > 0)
+    {}
+
+    close (fd);
+   #else
+    juce::FileInputStream stream (file);
+    juce::HeapBlock<char> chunk (1 << 20);
+
+    while (stream.openedOk() && stream.read (chunk.get(), 1 << 20) > 0)
+    {}
+   #endif
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/** Linux real-time mode: SCHED_FIFO for the audio and input threads, optional
+    memory locking, and prefaulting of what playback is about to touch.
+
+    Threads ask to be promoted from wherever they're running, which only costs
+    them a gettid() and an atomic store. A helper thread does the rest:
+    first sched_setscheduler() directly, which works when RLIMIT_RTPRIO allows
+    it, then RealtimeKit over D-Bus for desktops that hand out RT priority
+    that way. libdbus is loaded at run time, so there's no build dependency
+    on it.
+
+    With memory locking on, mlockall (MCL_CURRENT | MCL_FUTURE) keeps
+    everything resident, and every later allocation and file mapping is
+    populated as it's made. Without it, prefault() and prefaultFile() touch
+    pages ahead of time so the audio thread doesn't take the first fault.
+
+    On other platforms everything here does nothing.
+*/
+class RealtimeMode  : private juce::Thread
+{
+public:
+    static RealtimeMode* getInstance()
+    {
+        static RealtimeMode instance;
+        return &instance;
+    }
+
+    struct Options
+    {
+        bool enabled = true;
+        bool lockMemory = false;
+
+        /** Reads --no-realtime and --lock-memory. */
+        static Options fromCommandLine (const juce::String& commandLine);
+    };
+
+    enum class Role
+    {
+        audio,
+        input
+    };
+
+    /** Call once at startup. Returns a report of what was set up, which is
+        also logged; thread promotions are logged as they happen.
+    */
+    juce::String enable (const Options&);
+
+    /** Asks for the calling thread to be made real-time. Safe to call from
+        the thread itself, including the audio thread; the work happens
+        elsewhere. Does nothing if the mode isn't enabled.
+    */
+    void requestPromotion (Role) noexcept;
+
+    /** What's been achieved so far, for showing the user. */
+    juce::String getReport() const;
+
+    /** Stops the helper thread. Call before JUCE shuts down. */
+    void shutdown();
+
+    //==============================================================================
+    /** Writes a zero to every page of a block of memory, so each one has its
+        own page behind it. Only for buffers whose contents don't matter yet.
+    */
+    static void prefault (void* data, size_t numBytes) noexcept;
+
+    /** Touches some stack on the calling thread, so the first deep call chain
+        on an audio thread doesn't fault.
+    */
+    static void prefaultStack() noexcept;
+
+    /** Gets a file into the page cache, for tracks about to be played. Blocks,
+        so call it from a background task.
+    */
+    static void prefaultFile (const juce::File&);
+
+private:
+    RealtimeMode();
+    ~RealtimeMode() override;
+
+    void run() override;
+    void promote (int threadId, Role);
+    void log (const juce::String&);
+
+    static constexpr int audioPriority = 70, inputPriority = 60;
+    static constexpr int maxPending = 8;
+
+    std::atomic<bool> enabled { false };
+    std::array<std::atomic<int>, maxPending> pendingThreads {};
+    std::array<std::atomic<int>, maxPending> pendingRoles {};
+    juce::WaitableEvent promotionRequested;
+
+    mutable juce::CriticalSection reportLock;
+    juce::StringArray report;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeMode)
+};
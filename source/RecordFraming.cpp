@@ -0,0 +1,67 @@
+#include "RecordFraming.h"
+
+namespace RecordFraming
+{
+
+juce::uint32 checksum (const void* data, size_t size) noexcept
+{
+    auto* bytes = static_cast<const juce::uint8*> (data);
+    juce::uint32 hash = 2166136261u;
+
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 16777619u;
+
+    return hash;
+}
+
+juce::MemoryBlock frame (const void* data, size_t size)
+{
+    juce::MemoryOutputStream out (size + 8);
+    out.writeInt ((int) size);
+    out.writeInt ((int) checksum (data, size));
+    out.write (data, size);
+    return out.getMemoryBlock();
+}
+
+std::optional<juce::MemoryBlock> read (juce::InputStream& in, juce::uint32 maxSize)
+{
+    if (in.getNumBytesRemaining() < 8)
+        return {};
+
+    const auto size = (juce::uint32) in.readInt();
+    const auto expected = (juce::uint32) in.readInt();
+
+    if (size > maxSize || (juce::int64) size > in.getNumBytesRemaining())
+        return {};
+
+    juce::MemoryBlock payload (size);
+
+    if (in.read (payload.getData(), (int) size) != (int) size
+         || checksum (payload.getData(), payload.getSize()) != expected)
+        return {};
+
+    return payload;
+}
+
+bool replaceAtomically (const juce::File& file, const void* data, size_t size)
+{
+    auto tempFile = file.getSiblingFile (file.getFileName() + ".tmp");
+    tempFile.deleteFile();
+
+    {
+        juce::FileOutputStream out (tempFile);
+
+        if (! out.openedOk())
+            return false;
+
+        out.write (data, size);
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return tempFile.replaceFileIn (file);
+}
+
+} // namespace RecordFraming
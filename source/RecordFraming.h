@@ -0,0 +1,29 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <optional>
+
+//==============================================================================
+/** The framing shared by everything ChopShop appends to disk: each record is
+    its size, an FNV-1a checksum of its bytes, then the bytes themselves.
+
+    A record that was only partly written when the app stopped fails its
+    checksum, so readers can tell exactly where the good data ends.
+*/
+namespace RecordFraming
+{
+    /** FNV-1a: plenty to tell a torn write from a whole one. */
+    juce::uint32 checksum (const void* data, size_t size) noexcept;
+
+    /** The framed form of a payload, ready to be appended. */
+    juce::MemoryBlock frame (const void* data, size_t size);
+
+    /** Reads one framed payload, or nothing if what's there is torn or corrupt. */
+    std::optional<juce::MemoryBlock> read (juce::InputStream&, juce::uint32 maxSize);
+
+    /** Writes a file's whole contents to a sibling and renames it into place,
+        so there's always a complete copy on disk.
+    */
+    bool replaceAtomically (const juce::File&, const void* data, size_t size);
+}
@@ -1,4 +1,5 @@
 #include "ReverbComponent.h"
+#include "PerformanceParameters.h"
 
 ReverbComponent::ReverbComponent(tracktion::engine::Edit& edit)
     : BaseEffectComponent(edit)
@@ -39,6 +40,10 @@ ReverbComponent::ReverbComponent(tracktion::engine::Edit& edit)
             
         if (auto wetParam = plugin->getAutomatableParameterByID("wet level"))
             bindSliderToParameter(reverbWetSlider, *wetParam);
+
+        // Both knobs are played live, so keep them out of the undo history
+        if (auto reverb = dynamic_cast<tracktion::engine::ReverbPlugin*>(plugin.get()))
+            PerformanceParameters::stopUndoing(reverb->roomSizeValue, reverb->wetValue);
     }
 
     mixRamp.onValueChange = [this](float value) {
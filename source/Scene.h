@@ -0,0 +1,58 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+//==============================================================================
+/** Every effect parameter and the screw, flat, so a scene can be copied and
+    blended on the audio thread without touching anything else.
+
+    The values are in the order the SceneMemory was given its parameters, and
+    are meaningless without it.
+*/
+struct Scene
+{
+    static constexpr int maxParameters = 32;
+
+    std::array<float, maxParameters> values {};
+    int numParameters = 0;
+    double tempoRatio = 1.0;        // screw tempo over the master track's own
+
+    /** Writes the scene part-way from a to b into out. Safe on the audio thread. */
+    static void interpolate (const Scene& a, const Scene& b, float proportion, Scene& out) noexcept
+    {
+        out.numParameters = juce::jmin (a.numParameters, b.numParameters);
+
+        for (int i = 0; i < out.numParameters; ++i)
+            out.values[(size_t) i] = a.values[(size_t) i] + proportion * (b.values[(size_t) i] - a.values[(size_t) i]);
+
+        out.tempoRatio = a.tempoRatio + proportion * (b.tempoRatio - a.tempoRatio);
+    }
+};
+
+/** One recall or morph, as armed by the message thread and run by the audio thread. */
+struct SceneMorph
+{
+    Scene from, to;
+    double lengthBeats = 0.0;       // 0 jumps straight to the target
+    double baseBpm = 120.0;         // the master track's own tempo, to count beats at the blended ratio
+    juce::uint32 sequence = 0;
+};
+
+static_assert (std::is_trivially_copyable_v<Scene> && std::is_trivially_copyable_v<SceneMorph>,
+               "scenes are copied about on the audio thread");
+
+/** The scene the PerformanceBridge is blending, for the effect plugins to
+    play from Tracktion's audio threads while a morph is running.
+
+    Each value is an atomic of its own, so a plugin can catch one parameter
+    from one block and the next from another, which a morph never notices.
+*/
+struct LiveScene
+{
+    std::array<std::atomic<float>, Scene::maxParameters> values {};
+    std::atomic<juce::uint32> sequence { 0 };   // the morph being played, or 0 once its parameters have been set
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "Scene.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+/** A plugin that plays scene morphs itself, on the audio thread.
+
+    While the PerformanceBridge is blending a scene, the parameters a plugin
+    follows are read from the bridge's LiveScene instead of from the
+    parameters, so the morph moves the sound block by block rather than at
+    the rate the message thread gets round to setting them. Once the morph is
+    over and the SceneMemory has set the parameters to where it ended, the
+    bridge lets go of the scene and the parameters take over again.
+*/
+class SceneFollower
+{
+public:
+    SceneFollower()
+    {
+        for (auto& index : sceneIndices)
+            index = -1;
+    }
+
+    virtual ~SceneFollower() = default;
+
+    /** Message thread: finds each followed parameter's place in a scene made of
+        these parameters, in order, and starts following the given live scene.
+    */
+    void followScene (const LiveScene& newScene, const std::vector<tracktion::engine::AutomatableParameter::Ptr>& sceneParameters)
+    {
+        for (int i = 0; i < numFollowed; ++i)
+        {
+            const auto found = std::find (sceneParameters.begin(), sceneParameters.end(), parameters[(size_t) i]);
+            const auto index = found != sceneParameters.end() ? (int) std::distance (sceneParameters.begin(), found) : -1;
+
+            sceneIndices[(size_t) i].store (index < Scene::maxParameters ? index : -1, std::memory_order_relaxed);
+        }
+
+        scene.store (&newScene, std::memory_order_release);
+    }
+
+    /** Message thread: true if the parameter's sound comes from the live scene during a morph. */
+    bool follows (const tracktion::engine::AutomatableParameter& parameter) const
+    {
+        for (int i = 0; i < numFollowed; ++i)
+            if (parameters[(size_t) i] == &parameter)
+                return sceneIndices[(size_t) i].load (std::memory_order_relaxed) >= 0;
+
+        return false;
+    }
+
+protected:
+    static constexpr int maxFollowed = 4;
+
+    /** Call from the plugin's constructor. Returns the handle to read it back with. */
+    int follow (tracktion::engine::AutomatableParameter& parameter)
+    {
+        jassert (numFollowed < maxFollowed);
+        parameters[(size_t) numFollowed] = &parameter;
+        return numFollowed++;
+    }
+
+    /** Audio thread: the live scene's value while a morph is playing, otherwise the parameter's. */
+    float getFollowedValue (int handle) const noexcept
+    {
+        const int index = sceneIndices[(size_t) handle].load (std::memory_order_relaxed);
+
+        if (const auto* live = scene.load (std::memory_order_acquire);
+            live != nullptr && index >= 0 && live->sequence.load (std::memory_order_acquire) != 0)
+            return live->values[(size_t) index].load (std::memory_order_relaxed);
+
+        return parameters[(size_t) handle]->getCurrentValue();
+    }
+
+private:
+    std::array<tracktion::engine::AutomatableParameter*, maxFollowed> parameters {};
+    std::array<std::atomic<int>, maxFollowed> sceneIndices;
+    int numFollowed = 0;
+
+    std::atomic<const LiveScene*> scene { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE (SceneFollower)
+};
@@ -0,0 +1,154 @@
+#include "SceneMemory.h"
+
+//==============================================================================
+SceneMemory::SceneMemory (PerformanceBridge& b)
+    : bridge (b)
+{
+}
+
+SceneMemory::~SceneMemory()
+{
+    stopTimer();
+}
+
+void SceneMemory::setParameters (std::vector<tracktion::engine::AutomatableParameter::Ptr> newParameters,
+                                 const std::vector<SceneFollower*>& followers)
+{
+    jassert (newParameters.size() <= (size_t) Scene::maxParameters);
+
+    if (newParameters.size() > (size_t) Scene::maxParameters)
+        newParameters.resize ((size_t) Scene::maxParameters);
+
+    parameters = std::move (newParameters);
+
+    for (auto* follower : followers)
+        follower->followScene (bridge.getLiveScene(), parameters);
+
+    followed.assign (parameters.size(), false);
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+        for (auto* follower : followers)
+            if (follower->follows (*parameters[i]))
+                followed[i] = true;
+
+    // Scenes stored against the old layout would set the wrong parameters
+    stored = {};
+}
+
+Scene SceneMemory::capture (double tempoRatio) const
+{
+    Scene scene;
+    scene.numParameters = (int) parameters.size();
+    scene.tempoRatio = tempoRatio;
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+        scene.values[i] = followed[i] && ! appliedFinalScene ? lastApplied.values[i]
+                                                              : parameters[i]->getCurrentValue();
+
+    return scene;
+}
+
+float SceneMemory::getValue (const Scene& scene, const tracktion::engine::AutomatableParameter& parameter) const
+{
+    for (size_t i = 0; i < parameters.size() && (int) i < scene.numParameters; ++i)
+        if (parameters[i] == &parameter)
+            return scene.values[i];
+
+    return parameter.getCurrentValue();
+}
+
+void SceneMemory::store (int slot, const Scene& scene)
+{
+    if (! juce::isPositiveAndBelow (slot, numSlots))
+        return;
+
+    slots[(size_t) slot] = scene;
+    stored[(size_t) slot] = true;
+}
+
+bool SceneMemory::isStored (int slot) const
+{
+    return juce::isPositiveAndBelow (slot, numSlots) && stored[(size_t) slot];
+}
+
+bool SceneMemory::recall (int slot, const Scene& live, double lengthBeats, double baseBpm)
+{
+    if (! isStored (slot))
+        return false;
+
+    SceneMorph morph;
+    morph.from = live;
+    morph.to = slots[(size_t) slot];
+    morph.lengthBeats = juce::jmax (0.0, lengthBeats);
+    morph.baseBpm = baseBpm;
+    morph.sequence = nextSequence++;
+    bridge.startSceneMorph (morph);
+
+    target = morph.to;
+    lastApplied = live;
+    lastNumBlocks = bridge.getState().numBlocks;
+    lastProgressTime = juce::Time::getMillisecondCounter();
+
+    appliedFinalScene = false;
+    startTimerHz (60);
+    return true;
+}
+
+//==============================================================================
+void SceneMemory::timerCallback()
+{
+    const auto& state = bridge.getState();
+    const auto now = juce::Time::getMillisecondCounter();
+
+    if (state.numBlocks != lastNumBlocks)
+    {
+        lastNumBlocks = state.numBlocks;
+        lastProgressTime = now;
+    }
+    else if (now - lastProgressTime > stalledTimeoutMs)
+    {
+        // No blocks are being processed, so the morph will never get there
+        stopTimer();
+        apply (target, true);
+        appliedSequence = nextSequence - 1;
+        appliedFinalScene = true;
+        bridge.releaseScene (appliedSequence);
+        return;
+    }
+
+    // The audio thread hasn't picked it up yet
+    if (state.sceneSequence != nextSequence - 1)
+        return;
+
+    // Once the last step is in, there's nothing more to follow
+    if (state.sceneSequence == appliedSequence && appliedFinalScene)
+    {
+        stopTimer();
+        return;
+    }
+
+    // The followed parameters are already playing from the bridge, so they're
+    // only set when the morph is over, and then the bridge can let go of them
+    const bool finished = ! state.isMorphing;
+
+    apply (state.scene, finished);
+    appliedSequence = state.sceneSequence;
+    appliedFinalScene = finished;
+
+    if (finished)
+        bridge.releaseScene (appliedSequence);
+}
+
+void SceneMemory::apply (const Scene& scene, bool includingFollowed)
+{
+    const auto numValues = juce::jmin ((size_t) scene.numParameters, parameters.size());
+
+    for (size_t i = 0; i < numValues; ++i)
+        if ((includingFollowed || ! followed[i]) && parameters[i]->getCurrentValue() != scene.values[i])
+            parameters[i]->setParameter (scene.values[i], juce::sendNotification);
+
+    lastApplied = scene;
+
+    if (onSceneApplied)
+        onSceneApplied (scene);
+}
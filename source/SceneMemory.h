@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "PerformanceBridge.h"
+#include "Scene.h"
+#include "SceneFollower.h"
+
+#include <array>
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/** Scene slots: every effect parameter and the screw, stored and recalled as one.
+
+    Storing a scene copies the live values into a preallocated slot. Recalling
+    one arms a morph from the live values to the slot over some number of
+    beats, which the PerformanceBridge runs on the audio thread against the
+    audio clock; nothing on the message thread is touched per slider, and
+    nothing is allocated.
+
+    The effect plugins that are SceneFollowers play the morph straight from
+    the bridge on the audio thread. Tracktion's parameters and tempo can only
+    be written from the message thread, so while a morph runs a timer here
+    picks up each blended scene the bridge publishes and calls onSceneApplied,
+    for the owner to move the sliders and the screw. It only sets parameters
+    that no plugin follows; the followed ones are set once, when the morph is
+    over, and then the bridge is told to let go of the scene. If the audio
+    device isn't processing blocks, the morph would never move, so after a
+    short wait the recalled scene is set straight away instead.
+*/
+class SceneMemory  : private juce::Timer
+{
+public:
+    static constexpr int numSlots = 8;
+
+    explicit SceneMemory (PerformanceBridge&);
+    ~SceneMemory() override;
+
+    /** The parameters a scene holds, in order, and the plugins that play them
+        on the audio thread. Anything past Scene::maxParameters is left out.
+    */
+    void setParameters (std::vector<tracktion::engine::AutomatableParameter::Ptr>,
+                        const std::vector<SceneFollower*>& followers = {});
+
+    /** The parameters' current values, along with the given screw ratio. Mid-morph,
+        the followed parameters are taken from where the morph has got to.
+    */
+    Scene capture (double tempoRatio) const;
+
+    /** The scene's value for a parameter, or the parameter's own if the scene doesn't hold it. */
+    float getValue (const Scene&, const tracktion::engine::AutomatableParameter&) const;
+
+    void store (int slot, const Scene&);
+    bool isStored (int slot) const;
+
+    /** Morphs from the live scene to a stored one over a number of beats, or
+        jumps straight to it for 0. Returns false if the slot is empty.
+    */
+    bool recall (int slot, const Scene& live, double lengthBeats, double baseBpm);
+
+    /** Called with each scene the morph reaches, for the sliders and the screw. */
+    std::function<void (const Scene&)> onSceneApplied;
+
+private:
+    void timerCallback() override;
+    void apply (const Scene&, bool includingFollowed);
+
+    PerformanceBridge& bridge;
+    std::vector<tracktion::engine::AutomatableParameter::Ptr> parameters;
+    std::vector<bool> followed;
+
+    std::array<Scene, numSlots> slots {};
+    std::array<bool, numSlots> stored {};
+
+    static constexpr juce::uint32 stalledTimeoutMs = 250;
+
+    juce::uint32 nextSequence = 1;
+    juce::uint32 appliedSequence = 0;
+    bool appliedFinalScene = true;
+
+    // The scene being recalled, the last one the morph reached, and when the
+    // audio thread was last seen running
+    Scene target, lastApplied;
+    juce::uint32 lastNumBlocks = 0;
+    juce::uint32 lastProgressTime = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SceneMemory)
+};
@@ -0,0 +1,164 @@
+#include "ScopeSource.h"
+#include "SoftwareScope.h"
+
+#include <algorithm>
+
+//==============================================================================
+double ScopeSettings::getWindowBeats() const noexcept
+{
+    switch (window)
+    {
+        case Window::beat:      return 1.0;
+        case Window::bar:       return 4.0;
+        case Window::twoBars:   return 8.0;
+        case Window::fourBars:  return 16.0;
+        case Window::eightBars: return 32.0;
+        case Window::ms5:
+        case Window::ms20:
+        case Window::ms100:
+        default:                return 0.0;
+    }
+}
+
+//==============================================================================
+ScopeSource::ScopeSource (AudioTap::Subscription tapToUse)
+    : tap (std::move (tapToUse))
+{
+}
+
+bool ScopeSource::getColumns (float* mins, float* maxs, int numColumns)
+{
+    if (! tap || numColumns <= 0 || tap->getWritePosition() == 0)
+        return false;
+
+    const auto clock = getBeatClock != nullptr ? getBeatClock() : ScopeSettings::BeatClock();
+    const double sampleRate = tap->getSampleRate();
+    const double windowBeats = settings.getWindowBeats();
+
+    double windowSeconds = 0.005;
+
+    if (windowBeats > 0.0)
+        windowSeconds = windowBeats * 60.0 / juce::jmax (1.0, clock.bpm);
+    else if (settings.window == ScopeSettings::Window::ms20)
+        windowSeconds = 0.02;
+    else if (settings.window == ScopeSettings::Window::ms100)
+        windowSeconds = 0.1;
+
+    const auto windowSamples = juce::jmax ((juce::int64) 1, (juce::int64) (windowSeconds * sampleRate));
+
+    if (windowSamples <= maxRawSamples)
+        return getRawColumns (windowSamples, clock, mins, maxs, numColumns);
+
+    return getEnvelopeColumns (windowSamples, clock, mins, maxs, numColumns);
+}
+
+juce::int64 ScopeSource::getSweepPosition (juce::int64 windowSamples, const ScopeSettings::BeatClock& clock) const
+{
+    if (settings.trigger != ScopeSettings::Trigger::beat || ! clock.isPlaying || clock.bpm <= 0.0)
+        return -1;
+
+    // The tap's newest sample is taken as the transport's position; they
+    // come from the same device callback, so they're at most a block apart
+    const double samplesPerBeat = tap->getSampleRate() * 60.0 / clock.bpm;
+    const double windowBeats = (double) windowSamples / samplesPerBeat;
+    double phase = std::fmod (clock.beat, windowBeats);
+
+    if (phase < 0.0)
+        phase += windowBeats;
+
+    return juce::jlimit ((juce::int64) 0, windowSamples - 1, (juce::int64) (phase * samplesPerBeat));
+}
+
+//==============================================================================
+bool ScopeSource::getRawColumns (juce::int64 windowSamples, const ScopeSettings::BeatClock& clock,
+                                 float* mins, float* maxs, int numColumns)
+{
+    const int window = (int) windowSamples;
+
+    // The zero-crossing trigger looks back up to another window for somewhere to start
+    const int searchLength = settings.trigger == ScopeSettings::Trigger::zeroCrossing ? window : 0;
+    const int total = window + searchLength;
+
+    auto position = tap->getWritePosition() - total;
+    const int count = tap->read (position, rawBuffer, total);
+
+    if (count <= 0)
+        return false;
+
+    // Sum the channels, as the scopes do, and line what we got up with the end
+    const int padding = total - count;
+    juce::FloatVectorOperations::clear (mono.data(), padding);
+    juce::FloatVectorOperations::add (mono.data() + padding, rawBuffer.getReadPointer (0), rawBuffer.getReadPointer (1), count);
+
+    int start = searchLength;
+
+    if (settings.trigger == ScopeSettings::Trigger::zeroCrossing)
+    {
+        for (int i = searchLength; i > padding; --i)
+        {
+            if (mono[(size_t) i - 1] < 0.0f && mono[(size_t) i] >= 0.0f)
+            {
+                start = i;
+                break;
+            }
+        }
+    }
+
+    if (const auto sweep = getSweepPosition (windowSamples, clock); sweep >= 0)
+    {
+        // The newest sample goes at the sweep position; right of it is the previous pass
+        std::rotate (mono.begin() + start, mono.begin() + start + (window - 1 - (int) sweep), mono.begin() + start + window);
+    }
+
+    ScopeRasteriser::computeEnvelope (mono.data() + start, window, mins, maxs, numColumns);
+    return true;
+}
+
+bool ScopeSource::getEnvelopeColumns (juce::int64 windowSamples, const ScopeSettings::BeatClock& clock,
+                                      float* mins, float* maxs, int numColumns)
+{
+    int level = 0;
+
+    while (level < AudioTap::numEnvelopeLevels - 1 && windowSamples / AudioTap::getSamplesPerPoint (level) > maxPoints)
+        ++level;
+
+    const int samplesPerPoint = AudioTap::getSamplesPerPoint (level);
+    const int numPoints = (int) juce::jlimit ((juce::int64) 1, (juce::int64) maxPoints, windowSamples / samplesPerPoint);
+    auto end = tap->getNumEnvelopePoints (level);
+
+    if (end == 0)
+        return false;
+
+    const auto sweep = getSweepPosition (windowSamples, clock);
+
+    if (sweep < 0)
+    {
+        // Scroll a whole column at a time, so each column always covers the
+        // same points and the trace doesn't shimmer
+        const auto pointsPerColumn = juce::jmax ((juce::int64) 1, (juce::int64) numPoints / numColumns);
+        end -= end % pointsPerColumn;
+    }
+
+    tap->readEnvelope (level, end - numPoints, pointMins.data(), pointMaxs.data(), numPoints);
+
+    if (sweep >= 0)
+    {
+        const int sweepPoint = juce::jlimit (0, numPoints - 1, (int) (sweep / samplesPerPoint));
+        const int middle = numPoints - 1 - sweepPoint;
+
+        std::rotate (pointMins.begin(), pointMins.begin() + middle, pointMins.begin() + numPoints);
+        std::rotate (pointMaxs.begin(), pointMaxs.begin() + middle, pointMaxs.begin() + numPoints);
+    }
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        // Overlap the next column by a point so the spans join up
+        const int first = juce::jmin (numPoints - 1, (int) ((juce::int64) column * numPoints / numColumns));
+        const int last = juce::jmin (numPoints, (int) ((juce::int64) (column + 1) * numPoints / numColumns) + 1);
+
+        mins[column] = juce::FloatVectorOperations::findMinimum (pointMins.data() + first, last - first);
+        maxs[column] = juce::FloatVectorOperations::findMaximum (pointMaxs.data() + first, last - first);
+    }
+
+    return true;
+}
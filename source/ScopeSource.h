@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "AudioTap.h"
+
+#include <functional>
+#include <vector>
+
+//==============================================================================
+/** How a scope picks what to show. */
+struct ScopeSettings
+{
+    enum class Trigger
+    {
+        free,           // the newest audio, scrolling
+        zeroCrossing,   // starts on a rising zero crossing, for short windows
+        beat            // sweeps across the window in time with the beat grid
+    };
+
+    enum class Window
+    {
+        ms5, ms20, ms100,
+        beat, bar, twoBars, fourBars, eightBars
+    };
+
+    Trigger trigger = Trigger::free;
+    Window window = Window::ms5;
+
+    /** Where the transport is, for beat-length windows and the beat trigger. */
+    struct BeatClock
+    {
+        double beat = 0.0;
+        double bpm = 120.0;
+        bool isPlaying = false;
+    };
+
+    static juce::StringArray getTriggerNames()  { return { "Free", "Zero crossing", "Beat" }; }
+    static juce::StringArray getWindowNames()   { return { "5 ms", "20 ms", "100 ms", "1 beat", "1 bar", "2 bars", "4 bars", "8 bars" }; }
+
+    /** Window length in beats, or 0 for the fixed-time windows. */
+    double getWindowBeats() const noexcept;
+
+    bool operator== (const ScopeSettings& other) const noexcept     { return trigger == other.trigger && window == other.window; }
+    bool operator!= (const ScopeSettings& other) const noexcept     { return ! operator== (other); }
+};
+
+//==============================================================================
+/** Turns a tap into per-column min/max spans for a scope, message thread only.
+
+    Windows up to maxRawSamples are read as samples, so the trace has full
+    detail and can be triggered on a zero crossing. Longer windows are read
+    from the tap's decimated envelope, at whichever level gives no more than
+    maxPoints points. Either way a frame reads a bounded amount whatever the
+    window, so eight bars cost about the same per frame as 100 ms.
+
+    With the beat trigger the window's position is fixed to the beat grid: the
+    trace sweeps left to right over the previous pass, so beats stay put on
+    screen instead of scrolling.
+*/
+class ScopeSource
+{
+public:
+    explicit ScopeSource (AudioTap::Subscription);
+
+    static constexpr int maxRawSamples = 8192;
+    static constexpr int maxPoints = AudioTap::envelopeCapacity;
+
+    void setSettings (const ScopeSettings& newSettings)                 { settings = newSettings; }
+    const ScopeSettings& getSettings() const noexcept                   { return settings; }
+
+    void setBeatClock (std::function<ScopeSettings::BeatClock()> clock) { getBeatClock = std::move (clock); }
+
+    /** Fills numColumns mins and maxs. Returns false if the tap has nothing yet. */
+    bool getColumns (float* mins, float* maxs, int numColumns);
+
+private:
+    bool getRawColumns (juce::int64 windowSamples, const ScopeSettings::BeatClock&, float* mins, float* maxs, int numColumns);
+    bool getEnvelopeColumns (juce::int64 windowSamples, const ScopeSettings::BeatClock&, float* mins, float* maxs, int numColumns);
+
+    /** How far into the window the beat trigger has swept, or -1 if it isn't running. */
+    juce::int64 getSweepPosition (juce::int64 windowSamples, const ScopeSettings::BeatClock&) const;
+
+    AudioTap::Subscription tap;
+    ScopeSettings settings;
+    std::function<ScopeSettings::BeatClock()> getBeatClock;
+
+    juce::AudioBuffer<float> rawBuffer { AudioTap::numChannels, maxRawSamples * 2 };
+    std::vector<float> mono = std::vector<float> ((size_t) maxRawSamples * 2, 0.0f);
+    std::vector<float> pointMins = std::vector<float> ((size_t) maxPoints, 0.0f);
+    std::vector<float> pointMaxs = std::vector<float> ((size_t) maxPoints, 0.0f);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScopeSource)
+};
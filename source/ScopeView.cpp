@@ -0,0 +1,149 @@
+#include "ScopeView.h"
+#include "Osc2D.h"
+#include "SoftwareScope.h"
+
+namespace
+{
+    // Once the GL has been found wanting there's no point trying it again
+    bool glRejected = false;
+
+    juce::String getForcedBackend()
+    {
+        return juce::SystemStats::getEnvironmentVariable ("CHOPSHOP_SCOPE", {}).trim().toLowerCase();
+    }
+}
+
+//==============================================================================
+ScopeView::ScopeView (const juce::String& name)
+    : tapName (name)
+{
+    triggerBox.addItemList (ScopeSettings::getTriggerNames(), 1);
+    triggerBox.setSelectedItemIndex ((int) settings.trigger, juce::dontSendNotification);
+    triggerBox.onChange = [this] { settingsChanged(); };
+    addAndMakeVisible (triggerBox);
+
+    windowBox.addItemList (ScopeSettings::getWindowNames(), 1);
+    windowBox.setSelectedItemIndex ((int) settings.window, juce::dontSendNotification);
+    windowBox.onChange = [this] { settingsChanged(); };
+    addAndMakeVisible (windowBox);
+
+    updateBackend();
+}
+
+ScopeView::~ScopeView()
+{
+    scope = nullptr;
+}
+
+bool ScopeView::isSoftwareRenderer (const juce::String& renderer)
+{
+    for (auto* name : { "llvmpipe", "softpipe", "swrast", "software rasterizer",
+                        "swiftshader", "gdi generic", "microsoft basic render" })
+        if (renderer.containsIgnoreCase (name))
+            return true;
+
+    return false;
+}
+
+void ScopeView::setBeatClock (std::function<ScopeSettings::BeatClock()> clock)
+{
+    beatClock = std::move (clock);
+
+    if (auto* softwareScope = dynamic_cast<SoftwareScope*> (scope.get()))
+        softwareScope->setBeatClock (beatClock);
+}
+
+//==============================================================================
+void ScopeView::settingsChanged()
+{
+    settings.trigger = (ScopeSettings::Trigger) juce::jmax (0, triggerBox.getSelectedItemIndex());
+    settings.window = (ScopeSettings::Window) juce::jmax (0, windowBox.getSelectedItemIndex());
+
+    updateBackend();
+}
+
+void ScopeView::updateBackend()
+{
+    const auto forced = getForcedBackend();
+    const bool wantsGL = settings == ScopeSettings()
+                           && (forced == "gl" || (forced != "software" && ! glRejected));
+
+    if (wantsGL)
+    {
+        if (scope == nullptr || usingSoftware)
+            createGLScope();
+
+        return;
+    }
+
+    if (scope == nullptr || ! usingSoftware)
+        createSoftwareScope();
+
+    if (auto* softwareScope = dynamic_cast<SoftwareScope*> (scope.get()))
+        softwareScope->setSettings (settings);
+}
+
+void ScopeView::createGLScope()
+{
+    // Let go of the old scope and its tap subscription first
+    scope = nullptr;
+
+    auto glScope = std::make_unique<Oscilloscope2D> (AudioTapService::getInstance()->subscribe (tapName));
+    const bool forced = getForcedBackend() == "gl";
+
+    glScope->onRendererDetected = [safeThis = juce::Component::SafePointer<ScopeView> (this), forced] (const juce::String& renderer,
+                                                                                                       bool shaderCompiled)
+    {
+        DBG ("Scope: GL renderer is " + renderer);
+
+        if (forced || (shaderCompiled && ! isSoftwareRenderer (renderer)))
+            return;
+
+        glRejected = true;
+
+        // We're inside the GL scope's own callback, so replace it afterwards
+        juce::MessageManager::callAsync ([safeThis]
+        {
+            if (safeThis != nullptr)
+                safeThis->updateBackend();
+        });
+    };
+
+    glScope->start();
+    scope = std::move (glScope);
+    usingSoftware = false;
+
+    addAndMakeVisible (*scope);
+    resized();
+}
+
+void ScopeView::createSoftwareScope()
+{
+    DBG ("Scope: using the software renderer");
+
+    scope = nullptr;
+
+    auto softwareScope = std::make_unique<SoftwareScope> (AudioTapService::getInstance()->subscribe (tapName));
+    softwareScope->setSettings (settings);
+    softwareScope->setBeatClock (beatClock);
+    softwareScope->start();
+    scope = std::move (softwareScope);
+    usingSoftware = true;
+
+    addAndMakeVisible (*scope);
+    resized();
+}
+
+void ScopeView::resized()
+{
+    auto bounds = getLocalBounds();
+
+    // The selectors sit in a strip above the scope rather than over it, as
+    // the GL scope's surface can cover sibling components on some platforms
+    auto strip = bounds.removeFromTop (24);
+    windowBox.setBounds (strip.removeFromRight (90).reduced (1));
+    triggerBox.setBounds (strip.removeFromRight (120).reduced (1));
+
+    if (scope != nullptr)
+        scope->setBounds (bounds);
+}
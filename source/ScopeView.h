@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "AudioTap.h"
+#include "ScopeSource.h"
+
+//==============================================================================
+/** The oscilloscope for a tap, on whichever backend suits the machine and
+    the view.
+
+    The free-running 5 ms view starts on the OpenGL scope, and the renderer is
+    checked once the context is up. If the GL is a software rasteriser (Mesa's
+    llvmpipe and friends) or the shader won't compile, the view swaps to the
+    SoftwareScope and stays there for the rest of the session. Triggered and
+    longer windows always use the SoftwareScope, as the shader only draws 256
+    raw samples.
+
+    Setting CHOPSHOP_SCOPE to "software" or "gl" in the environment skips the
+    check and forces a backend for the free-running view.
+*/
+class ScopeView  : public juce::Component
+{
+public:
+    explicit ScopeView (const juce::String& tapName);
+    ~ScopeView() override;
+
+    void resized() override;
+
+    bool isUsingSoftwareRenderer() const noexcept       { return usingSoftware; }
+
+    /** Supplies the transport position for beat windows and the beat trigger. */
+    void setBeatClock (std::function<ScopeSettings::BeatClock()>);
+
+    /** True for GL_RENDERER strings that mean the GPU isn't doing the work. */
+    static bool isSoftwareRenderer (const juce::String& renderer);
+
+private:
+    void settingsChanged();
+    void updateBackend();
+    void createGLScope();
+    void createSoftwareScope();
+
+    const juce::String tapName;
+    std::unique_ptr<juce::Component> scope;
+    bool usingSoftware = false;
+
+    ScopeSettings settings;
+    std::function<ScopeSettings::BeatClock()> beatClock;
+    juce::ComboBox triggerBox, windowBox;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScopeView)
+};
@@ -0,0 +1,183 @@
+#include "SessionSnapshot.h"
+#include "RecordFraming.h"
+
+namespace
+{
+    constexpr int snapshotMagic = 0x53534343;      // "CCSS"
+    constexpr int snapshotVersion = 1;
+
+    // Anything bigger than this in a count means the data is corrupt
+    constexpr int maxItems = 4096;
+
+    void writeFingerprint (juce::OutputStream& out, const TrackFingerprint& f)
+    {
+        out.writeInt64 (f.size);
+        out.writeInt64 (f.modified);
+        out.writeInt ((int) f.headHash);
+    }
+
+    TrackFingerprint readFingerprint (juce::InputStream& in)
+    {
+        TrackFingerprint f;
+        f.size = in.readInt64();
+        f.modified = in.readInt64();
+        f.headHash = (juce::uint32) in.readInt();
+        return f;
+    }
+
+    bool readCount (juce::InputStream& in, int& count)
+    {
+        count = in.readCompressedInt();
+        return juce::isPositiveAndNotGreaterThan (count, maxItems);
+    }
+}
+
+//==============================================================================
+TrackFingerprint TrackFingerprint::of (const juce::File& file)
+{
+    TrackFingerprint f;
+
+    if (! file.existsAsFile())
+        return f;
+
+    f.size = file.getSize();
+    f.modified = file.getLastModificationTime().toMilliseconds();
+
+    juce::FileInputStream in (file);
+
+    if (in.openedOk())
+    {
+        juce::HeapBlock<char> head (64 * 1024);
+        const auto numRead = in.read (head.get(), 64 * 1024);
+        f.headHash = RecordFraming::checksum (head.get(), (size_t) juce::jmax (0, numRead));
+    }
+
+    return f;
+}
+
+//==============================================================================
+juce::MemoryBlock SessionSnapshot::toBinary() const
+{
+    juce::MemoryOutputStream out (1024);
+    out.writeInt (snapshotMagic);
+    out.writeInt (snapshotVersion);
+
+    out.writeCompressedInt ((int) decks.size());
+
+    for (const auto& deck : decks)
+    {
+        out.writeString (deck.file.getFullPathName());
+        writeFingerprint (out, deck.fingerprint);
+        out.writeFloat (deck.send);
+        out.writeDouble (deck.barPhase);
+    }
+
+    out.writeCompressedInt (selectedDeck);
+    out.writeCompressedInt (masterDeck);
+    out.writeFloat (deckFader);
+    out.writeDouble (screwRatio);
+    out.writeDouble (positionSeconds);
+
+    out.writeCompressedInt ((int) parameters.size());
+
+    for (const auto& p : parameters)
+    {
+        out.writeString (p.panel);
+        out.writeString (p.id);
+        out.writeFloat (p.value);
+    }
+
+    out.writeCompressedInt ((int) hotCueBeats.size());
+
+    for (const auto& cue : hotCueBeats)
+    {
+        out.writeBool (cue.has_value());
+
+        if (cue)
+            out.writeDouble (*cue);
+    }
+
+    out.writeCompressedInt ((int) controllerMapping.size());
+
+    for (const auto& binding : controllerMapping)
+    {
+        out.writeCompressedInt (binding.control);
+        out.writeString (binding.action);
+        out.writeBool (binding.isAxis);
+    }
+
+    return out.getMemoryBlock();
+}
+
+std::optional<SessionSnapshot> SessionSnapshot::fromBinary (const void* data, size_t size)
+{
+    // The framing around it has already been checksummed, so a short read
+    // here means a different version rather than a torn write
+    juce::MemoryInputStream in (data, size, false);
+
+    if (in.readInt() != snapshotMagic || in.readInt() != snapshotVersion)
+        return {};
+
+    SessionSnapshot s;
+    int count = 0;
+
+    if (! readCount (in, count))
+        return {};
+
+    for (int i = 0; i < count; ++i)
+    {
+        DeckState deck;
+        const auto path = in.readString();
+
+        if (path.isNotEmpty())
+            deck.file = juce::File (path);
+
+        deck.fingerprint = readFingerprint (in);
+        deck.send = in.readFloat();
+        deck.barPhase = in.readDouble();
+        s.decks.push_back (deck);
+    }
+
+    s.selectedDeck = in.readCompressedInt();
+    s.masterDeck = in.readCompressedInt();
+    s.deckFader = in.readFloat();
+    s.screwRatio = in.readDouble();
+    s.positionSeconds = in.readDouble();
+
+    if (! readCount (in, count))
+        return {};
+
+    for (int i = 0; i < count; ++i)
+    {
+        Parameter p;
+        p.panel = in.readString();
+        p.id = in.readString();
+        p.value = in.readFloat();
+        s.parameters.push_back (p);
+    }
+
+    if (! readCount (in, count))
+        return {};
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (in.readBool())
+            s.hotCueBeats.push_back (in.readDouble());
+        else
+            s.hotCueBeats.push_back (std::nullopt);
+    }
+
+    if (! readCount (in, count))
+        return {};
+
+    for (int i = 0; i < count; ++i)
+    {
+        ControllerBinding binding;
+        binding.control = in.readCompressedInt();
+        binding.action = in.readString();
+        binding.isAxis = in.readBool();
+        s.controllerMapping.push_back (binding);
+    }
+
+    return s;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <optional>
+#include <vector>
+
+//==============================================================================
+/** Enough about a file to tell whether it's still the one a session was saved
+    with: its size, when it was last written, and a hash of its first 64 KB.
+    Cheap to take, so it can be checked on every restore.
+*/
+struct TrackFingerprint
+{
+    juce::int64 size = 0;
+    juce::int64 modified = 0;       // milliseconds since the epoch
+    juce::uint32 headHash = 0;
+
+    static TrackFingerprint of (const juce::File&);
+
+    bool operator== (const TrackFingerprint& other) const noexcept
+    {
+        return size == other.size && modified == other.modified && headHash == other.headHash;
+    }
+
+    bool operator!= (const TrackFingerprint& other) const noexcept  { return ! operator== (other); }
+};
+
+//==============================================================================
+/** Everything needed to put a set back the way it was: what's on each deck,
+    the screw, the chop controls, every effect parameter, the hot cues and the
+    controller mapping.
+
+    It's plain data, taken and applied by MainComponent on the message thread,
+    and turned into a compact binary form that the SessionStore writes out.
+*/
+struct SessionSnapshot
+{
+    struct DeckState
+    {
+        juce::File file;                // empty if the deck wasn't loaded
+        TrackFingerprint fingerprint;
+        float send = 1.0f;
+        double barPhase = 0.0;          // in beats: where a following deck was dropped in
+    };
+
+    struct Parameter
+    {
+        juce::String panel;             // which panel it's on: "reverb", "chop" and so on
+        juce::String id;                // the control's ID within it
+        float value = 0.0f;
+    };
+
+    struct ControllerBinding
+    {
+        int control = 0;
+        juce::String action;
+        bool isAxis = false;
+    };
+
+    std::vector<DeckState> decks;
+    int selectedDeck = 0;
+    int masterDeck = 0;
+    float deckFader = 0.5f;
+
+    /** Screw tempo over the master track's own tempo, so it survives a re-analysed BPM. */
+    double screwRatio = 1.0;
+    double positionSeconds = 0.0;
+
+    /** The effect panels' controls, and the chop controls along with them. */
+    std::vector<Parameter> parameters;
+    std::vector<std::optional<double>> hotCueBeats;
+    std::vector<ControllerBinding> controllerMapping;
+
+    //==============================================================================
+    juce::MemoryBlock toBinary() const;
+
+    /** Returns nothing if the data isn't a snapshot this version can read. */
+    static std::optional<SessionSnapshot> fromBinary (const void* data, size_t size);
+};
@@ -0,0 +1,219 @@
+#include "SessionStore.h"
+#include "RecordFraming.h"
+
+namespace
+{
+    constexpr juce::uint32 maxSnapshotSize = 1024 * 1024;
+}
+
+//==============================================================================
+SessionStore::SessionStore (const juce::File& dir)
+    : juce::Thread ("ChopShop Session Writer"),
+      directory (dir),
+      journalFile (dir.getChildFile ("Autosave.journal"))
+{
+    directory.createDirectory();
+    openJournal();
+    startThread (juce::Thread::Priority::low);
+}
+
+SessionStore::~SessionStore()
+{
+    stopTimer();
+
+    signalThreadShouldExit();
+    notify();
+    stopThread (5000);
+
+    writePending();
+}
+
+juce::File SessionStore::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::userMusicDirectory)
+               .getChildFile ("ChopShop")
+               .getChildFile ("Sessions");
+}
+
+//==============================================================================
+void SessionStore::startAutosaving (int intervalMs)
+{
+    if (! isTimerRunning())
+        startTimer (intervalMs);
+}
+
+void SessionStore::stopAutosaving()
+{
+    stopTimer();
+}
+
+void SessionStore::timerCallback()
+{
+    if (! captureSnapshot)
+        return;
+
+    auto data = captureSnapshot().toBinary();
+
+    // Nothing's moved since the last one; the journal already ends with it
+    if (data == lastAutosave)
+        return;
+
+    lastAutosave = data;
+    queue ({ std::move (data), {} });
+}
+
+std::optional<SessionSnapshot> SessionStore::recoverAutosave() const
+{
+    if (recovered.isEmpty())
+        return {};
+
+    return SessionSnapshot::fromBinary (recovered.getData(), recovered.getSize());
+}
+
+//==============================================================================
+void SessionStore::save (const SessionSnapshot& snapshot, const juce::File& file)
+{
+    queue ({ snapshot.toBinary(), file });
+}
+
+std::optional<SessionSnapshot> SessionStore::load (const juce::File& file)
+{
+    juce::FileInputStream in (file);
+
+    if (! in.openedOk())
+        return {};
+
+    auto data = RecordFraming::read (in, maxSnapshotSize);
+
+    if (! data)
+    {
+        DBG ("SessionStore: " + file.getFullPathName() + " is damaged");
+        return {};
+    }
+
+    return SessionSnapshot::fromBinary (data->getData(), data->getSize());
+}
+
+void SessionStore::flush()
+{
+    writePending();
+}
+
+//==============================================================================
+void SessionStore::openJournal()
+{
+    juce::int64 goodLength = 0;
+
+    {
+        juce::FileInputStream in (journalFile);
+
+        if (! in.openedOk())
+            return;
+
+        while (! in.isExhausted())
+        {
+            auto record = RecordFraming::read (in, maxSnapshotSize);
+
+            if (! record)
+                break;
+
+            recovered = std::move (*record);
+            goodLength = in.getPosition();
+        }
+    }
+
+    if (goodLength < journalFile.getSize())
+        DBG ("SessionStore: dropping " + juce::String (journalFile.getSize() - goodLength) + " bytes of torn journal");
+
+    // Start this run's journal off with just the session we found, which also
+    // gets rid of a torn tail
+    if (recovered.isEmpty())
+    {
+        journalFile.deleteFile();
+        return;
+    }
+
+    lastAutosave = recovered;
+
+    const auto framed = RecordFraming::frame (recovered.getData(), recovered.getSize());
+    RecordFraming::replaceAtomically (journalFile, framed.getData(), framed.getSize());
+}
+
+void SessionStore::queue (Job job)
+{
+    {
+        const juce::ScopedLock sl (pendingLock);
+        pending.push_back (std::move (job));
+    }
+
+    notify();
+}
+
+void SessionStore::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (-1);
+        writePending();
+    }
+}
+
+void SessionStore::writePending()
+{
+    const juce::ScopedLock sl (writeLock);
+
+    std::vector<Job> jobs;
+
+    {
+        const juce::ScopedLock pl (pendingLock);
+        jobs.swap (pending);
+    }
+
+    for (auto& job : jobs)
+    {
+        if (job.target == juce::File())
+        {
+            appendToJournal (job.data);
+            continue;
+        }
+
+        const auto framed = RecordFraming::frame (job.data.getData(), job.data.getSize());
+
+        if (RecordFraming::replaceAtomically (job.target, framed.getData(), framed.getSize()))
+            DBG ("SessionStore: saved " + job.target.getFullPathName() + " (" + juce::String ((int) framed.getSize()) + " bytes)");
+        else
+            DBG ("SessionStore: couldn't write " + job.target.getFullPathName());
+    }
+
+    // Syncs to the disk as well as emptying the stream's buffer
+    if (journalStream != nullptr)
+        journalStream->flush();
+}
+
+void SessionStore::appendToJournal (const juce::MemoryBlock& data)
+{
+    const auto framed = RecordFraming::frame (data.getData(), data.getSize());
+
+    // Past the limit, start again from this record rather than growing forever
+    if (journalFile.getSize() + (juce::int64) framed.getSize() > maxJournalSize)
+    {
+        journalStream.reset();
+
+        if (RecordFraming::replaceAtomically (journalFile, framed.getData(), framed.getSize()))
+            return;
+    }
+
+    if (journalStream == nullptr)
+    {
+        journalStream = std::make_unique<juce::FileOutputStream> (journalFile);
+
+        if (! journalStream->openedOk())
+        {
+            DBG ("SessionStore: can't write " + journalFile.getFullPathName() + ": " + journalStream->getStatus().getErrorMessage());
+            journalStream.reset();
+            return;
+        }
+    }
+
+    journalStream->write (framed.getData(), framed.getSize());
+}
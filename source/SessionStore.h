@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "SessionSnapshot.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+//==============================================================================
+/** Saves sessions, and keeps an autosave journal of the current one.
+
+    Every few seconds the owner is asked for a snapshot of the set. If it's
+    changed since the last one, its binary form is handed to a writer thread,
+    which appends it to Autosave.journal as a checksummed record and syncs it.
+    When the journal grows past a limit the writer starts a fresh one holding
+    just the latest record, swapped in by renaming, so there's always at least
+    one whole session on disk. Opening the store finds the last record that
+    survived, ready for recoverAutosave().
+
+    Saving a session by name goes through the same thread, and lands by a
+    rename too. Snapshots are small enough that loading one is a single read.
+
+    All the public functions are for the message thread.
+*/
+class SessionStore  : private juce::Thread,
+                      private juce::Timer
+{
+public:
+    /** Opens the store in the given directory, creating it if need be. */
+    explicit SessionStore (const juce::File& directory);
+
+    /** Writes out anything still queued. */
+    ~SessionStore() override;
+
+    /** Where ChopShop keeps its sessions: ~/Music/ChopShop/Sessions. */
+    static juce::File getDefaultDirectory();
+    static constexpr const char* fileExtension = ".chopshop";
+
+    juce::File getDirectory() const                     { return directory; }
+
+    //==============================================================================
+    /** Takes a snapshot of the set; called on the message thread for each autosave. */
+    std::function<SessionSnapshot()> captureSnapshot;
+
+    /** Does nothing if it's already autosaving. */
+    void startAutosaving (int intervalMs = 3000);
+    void stopAutosaving();
+
+    /** The last autosave that made it to disk before this store was opened,
+        i.e. where the previous run left off.
+    */
+    std::optional<SessionSnapshot> recoverAutosave() const;
+
+    //==============================================================================
+    /** Queues a snapshot to be written to a session file. */
+    void save (const SessionSnapshot&, const juce::File&);
+
+    static std::optional<SessionSnapshot> load (const juce::File&);
+
+    /** Blocks until everything queued so far is on disk. */
+    void flush();
+
+private:
+    struct Job
+    {
+        juce::MemoryBlock data;         // a snapshot's binary form
+        juce::File target;              // a session file, or empty for the journal
+    };
+
+    static constexpr juce::int64 maxJournalSize = 256 * 1024;
+
+    void run() override;
+    void timerCallback() override;
+
+    void openJournal();
+    void queue (Job);
+    void writePending();
+    void appendToJournal (const juce::MemoryBlock& data);
+
+    const juce::File directory, journalFile;
+
+    juce::MemoryBlock recovered;        // what the journal ended with when we opened it
+    juce::MemoryBlock lastAutosave;     // what it ends with now
+
+    juce::CriticalSection pendingLock;
+    std::vector<Job> pending;
+
+    juce::CriticalSection writeLock;
+    std::unique_ptr<juce::FileOutputStream> journalStream;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionStore)
+};
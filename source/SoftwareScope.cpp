@@ -0,0 +1,178 @@
+#include "SoftwareScope.h"
+
+//==============================================================================
+void ScopeRasteriser::setSize (int width, int height, juce::Colour background, juce::Colour trace)
+{
+    width = juce::jmax (1, width);
+    height = juce::jmax (1, height);
+
+    backgroundColour = background;
+    traceColour = trace;
+    haloColour = background.interpolatedWith (trace, 0.35f);
+
+    if (! image.isValid() || image.getWidth() != width || image.getHeight() != height)
+    {
+        image = juce::Image (juce::Image::RGB, width, height, false);
+
+        mins.assign ((size_t) width, 0.0f);
+        maxs.assign ((size_t) width, 0.0f);
+        spans.assign ((size_t) width, {});
+    }
+
+    needsFullRedraw = true;
+}
+
+void ScopeRasteriser::computeEnvelope (const float* samples, int numSamples,
+                                       float* minsOut, float* maxsOut, int numColumns) noexcept
+{
+    if (numSamples <= 0)
+    {
+        juce::FloatVectorOperations::clear (minsOut, numColumns);
+        juce::FloatVectorOperations::clear (maxsOut, numColumns);
+        return;
+    }
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const int start = juce::jmin (numSamples - 1, (int) ((juce::int64) column * numSamples / numColumns));
+        const int end = juce::jmin (numSamples, (int) ((juce::int64) (column + 1) * numSamples / numColumns) + 1);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax (samples + start, end - start);
+        minsOut[column] = range.getStart();
+        maxsOut[column] = range.getEnd();
+    }
+}
+
+int ScopeRasteriser::getYForAmplitude (float amplitude) const noexcept
+{
+    // Same centring and scaling as the shader in Oscilloscope2D
+    const float proportion = 0.5f + amplitude / 2.5f;
+    return juce::jlimit (0, image.getHeight() - 1, (int) (proportion * (float) image.getHeight()));
+}
+
+void ScopeRasteriser::drawColumn (juce::Image::BitmapData& pixels, int x, Span oldSpan, Span newSpan) const
+{
+    const int height = image.getHeight();
+
+    // One pixel of halo either side of the trace
+    auto fill = [&] (int top, int bottom, juce::Colour colour)
+    {
+        for (int y = juce::jmax (0, top); y <= juce::jmin (height - 1, bottom); ++y)
+            pixels.setPixelColour (x, y, colour);
+    };
+
+    fill (oldSpan.top - 1, oldSpan.bottom + 1, backgroundColour);
+    fill (newSpan.top - 1, newSpan.top - 1, haloColour);
+    fill (newSpan.top, newSpan.bottom, traceColour);
+    fill (newSpan.bottom + 1, newSpan.bottom + 1, haloColour);
+}
+
+juce::Rectangle<int> ScopeRasteriser::render (const float* samples, int numSamples)
+{
+    if (! image.isValid())
+        return {};
+
+    computeEnvelope (samples, numSamples, mins.data(), maxs.data(), image.getWidth());
+    return renderColumns (mins.data(), maxs.data());
+}
+
+juce::Rectangle<int> ScopeRasteriser::renderColumns (const float* columnMins, const float* columnMaxs)
+{
+    if (! image.isValid())
+        return {};
+
+    const int width = image.getWidth();
+
+    if (needsFullRedraw)
+    {
+        image.clear (image.getBounds(), backgroundColour);
+
+        for (auto& span : spans)
+            span = {};
+    }
+
+    juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readWrite);
+
+    juce::Rectangle<int> dirty;
+
+    for (int x = 0; x < width; ++x)
+    {
+        // Positive amplitudes go down the image, as they do in the shader
+        const Span newSpan { getYForAmplitude (columnMins[x]), getYForAmplitude (columnMaxs[x]) };
+        const Span oldSpan = spans[(size_t) x];
+
+        if (! needsFullRedraw && newSpan.top == oldSpan.top && newSpan.bottom == oldSpan.bottom)
+            continue;
+
+        drawColumn (pixels, x, oldSpan, newSpan);
+        spans[(size_t) x] = newSpan;
+
+        const int top = juce::jmin (oldSpan.top, newSpan.top) - 1;
+        const int bottom = juce::jmax (oldSpan.bottom, newSpan.bottom) + 1;
+        dirty = dirty.getUnion ({ x, top, 1, bottom - top + 1 });
+    }
+
+    if (needsFullRedraw)
+    {
+        needsFullRedraw = false;
+        return image.getBounds();
+    }
+
+    return dirty.getIntersection (image.getBounds());
+}
+
+//==============================================================================
+SoftwareScope::SoftwareScope (AudioTap::Subscription tapToUse)
+    : source (std::move (tapToUse))
+{
+    setOpaque (true);
+}
+
+SoftwareScope::~SoftwareScope()
+{
+    stop();
+}
+
+void SoftwareScope::start()
+{
+    startTimerHz (60);
+}
+
+void SoftwareScope::stop()
+{
+    stopTimer();
+}
+
+void SoftwareScope::resized()
+{
+    mins.assign ((size_t) juce::jmax (1, getWidth()), 0.0f);
+    maxs.assign ((size_t) juce::jmax (1, getWidth()), 0.0f);
+
+    rasteriser.setSize (getWidth(), getHeight(),
+                        getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId),
+                        juce::Colours::white.withBrightness (0.8f));
+}
+
+void SoftwareScope::timerCallback()
+{
+    if (mins.empty())
+        return;
+
+    // Flat line until something has played
+    if (! source.getColumns (mins.data(), maxs.data(), (int) mins.size()))
+    {
+        juce::FloatVectorOperations::clear (mins.data(), (int) mins.size());
+        juce::FloatVectorOperations::clear (maxs.data(), (int) maxs.size());
+    }
+
+    const auto dirty = rasteriser.renderColumns (mins.data(), maxs.data());
+
+    if (! dirty.isEmpty())
+        repaint (dirty);
+}
+
+void SoftwareScope::paint (juce::Graphics& g)
+{
+    g.setOpacity (1.0f);
+    g.drawImageAt (rasteriser.getImage(), 0, 0);
+}
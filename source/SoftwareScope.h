@@ -0,0 +1,98 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "AudioTap.h"
+#include "ScopeSource.h"
+
+#include <vector>
+
+//==============================================================================
+/** Draws a waveform into an image one pixel column at a time.
+
+    Each column covers a run of samples and is drawn as a vertical span from
+    their minimum to their maximum, so the cost depends on the width of the
+    image rather than on how many pixels the trace passes through. The min and
+    max of each run use JUCE's vectorised FloatVectorOperations. Only the
+    columns whose spans moved are rewritten, and render() returns the area
+    that changed so the caller can repaint just that.
+*/
+class ScopeRasteriser
+{
+public:
+    ScopeRasteriser() = default;
+
+    /** Resizes the image; everything is redrawn on the next render. */
+    void setSize (int width, int height, juce::Colour background, juce::Colour trace);
+
+    /** Draws samples across the full width, amplitude 0 in the middle.
+        Returns the area of the image that changed.
+    */
+    juce::Rectangle<int> render (const float* samples, int numSamples);
+
+    /** Draws one min/max span per column, as many as the image is wide. */
+    juce::Rectangle<int> renderColumns (const float* columnMins, const float* columnMaxs);
+
+    const juce::Image& getImage() const noexcept        { return image; }
+
+    /** Finds the min and max of each column's samples. Each column also takes
+        the first sample of the next one, so neighbouring spans always join up
+        even when there are fewer samples than columns.
+    */
+    static void computeEnvelope (const float* samples, int numSamples,
+                                 float* mins, float* maxs, int numColumns) noexcept;
+
+private:
+    struct Span
+    {
+        int top = 0, bottom = -1;
+    };
+
+    void drawColumn (juce::Image::BitmapData&, int x, Span oldSpan, Span newSpan) const;
+    int getYForAmplitude (float amplitude) const noexcept;
+
+    juce::Image image;
+    juce::Colour backgroundColour, traceColour, haloColour;
+
+    std::vector<float> mins, maxs;
+    std::vector<Span> spans;
+    bool needsFullRedraw = true;
+};
+
+//==============================================================================
+/** The oscilloscope without OpenGL.
+
+    Draws a ScopeSource with a ScopeRasteriser on the message thread. Used
+    where the only OpenGL available is a software rasteriser, which would run
+    the scope's fragment shader for every pixel, and for the triggered and
+    long windows, which the shader can't draw.
+*/
+class SoftwareScope  : public juce::Component,
+                       private juce::Timer
+{
+public:
+    explicit SoftwareScope (AudioTap::Subscription);
+    ~SoftwareScope() override;
+
+    void start();
+    void stop();
+
+    void setSettings (const ScopeSettings& settings)                    { source.setSettings (settings); }
+    void setBeatClock (std::function<ScopeSettings::BeatClock()> clock) { source.setBeatClock (std::move (clock)); }
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    ScopeSource source;
+    std::vector<float> mins, maxs;
+
+    ScopeRasteriser rasteriser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SoftwareScope)
+};
@@ -0,0 +1,158 @@
+#include "SpectrumAnalyser.h"
+
+namespace
+{
+    // Ballistics, per frame; at 44.1kHz a frame is about 23ms
+    constexpr float releaseDbPerFrame = 1.2f;
+    constexpr float peakFallDbPerFrame = 0.4f;
+    constexpr int peakHoldLengthFrames = 40;
+}
+
+//==============================================================================
+SpectrumAnalyser::SpectrumAnalyser (const juce::String& name)
+    : juce::Thread ("ChopShop Spectrum"), tapName (name)
+{
+    levels.fill (minDb);
+    peaks.fill (minDb);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stop();
+}
+
+void SpectrumAnalyser::start()
+{
+    if (isThreadRunning())
+        return;
+
+    // Start from now rather than working through whatever the tap already holds
+    tap = AudioTapService::getInstance()->subscribe (tapName);
+    readPosition = tap->getWritePosition();
+    hopFill = 0;
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyser::stop()
+{
+    stopThread (1000);
+    tap = {};
+}
+
+float SpectrumAnalyser::getFrequencyForProportion (float proportion) noexcept
+{
+    return minFrequency * std::pow (maxFrequency / minFrequency, proportion);
+}
+
+//==============================================================================
+void SpectrumAnalyser::updateBands (double sampleRate)
+{
+    bandSampleRate = sampleRate;
+    const float binsPerHz = (float) fftSize / (float) sampleRate;
+
+    for (int band = 0; band <= numBands; ++band)
+        bandEdges[(size_t) band] = getFrequencyForProportion ((float) band / (float) numBands) * binsPerHz;
+}
+
+void SpectrumAnalyser::analyseWindow()
+{
+    if (const double sampleRate = tap->getSampleRate(); sampleRate != bandSampleRate)
+        updateBands (sampleRate);
+
+    std::copy (window.begin(), window.end(), fftData.begin());
+    windowing.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data(), true);
+
+    // A full-scale sine reads 0 dB: the Hann window halves the amplitude and
+    // the FFT gives half of it to the negative frequencies
+    const float scale = 4.0f / (float) fftSize;
+    const int maxBin = fftSize / 2;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        const float low = bandEdges[(size_t) band], high = bandEdges[(size_t) band + 1];
+        float magnitude = 0.0f;
+
+        if (high - low < 1.0f)
+        {
+            // Narrower than a bin at the bottom end: interpolate at the band's centre
+            const float centre = juce::jmin ((float) maxBin - 1.0f, 0.5f * (low + high));
+            const int bin = (int) centre;
+            const float frac = centre - (float) bin;
+            magnitude = fftData[(size_t) bin] + frac * (fftData[(size_t) bin + 1] - fftData[(size_t) bin]);
+        }
+        else
+        {
+            const int first = juce::jlimit (0, maxBin, (int) std::ceil (low));
+            const int last = juce::jlimit (first + 1, maxBin + 1, (int) std::ceil (high));
+            magnitude = juce::FloatVectorOperations::findMaximum (fftData.data() + first, last - first);
+        }
+
+        const float db = juce::jlimit (minDb, maxDb, juce::Decibels::gainToDecibels (magnitude * scale, minDb));
+
+        auto& level = levels[(size_t) band];
+        level = db > level ? db : juce::jmax (db, level - releaseDbPerFrame);
+
+        auto& peak = peaks[(size_t) band];
+        auto& hold = peakHoldFrames[(size_t) band];
+
+        if (level >= peak)
+        {
+            peak = level;
+            hold = peakHoldLengthFrames;
+        }
+        else if (hold > 0)
+        {
+            --hold;
+        }
+        else
+        {
+            peak = juce::jmax (level, peak - peakFallDbPerFrame);
+        }
+    }
+
+    auto& frame = frames.getWriteBuffer();
+    frame.levels = levels;
+    frame.peaks = peaks;
+    frame.frameNumber = ++frameNumber;
+    frames.publish();
+}
+
+void SpectrumAnalyser::run()
+{
+    while (! threadShouldExit())
+    {
+        const auto before = readPosition;
+        const int numRead = tap->read (readPosition, readBuffer, hopSize - hopFill);
+
+        // Fell far enough behind that samples were overwritten: start the hop again
+        if (readPosition - before > numRead)
+            hopFill = 0;
+
+        if (numRead > 0)
+        {
+            for (int ch = 0; ch < hopBuffer.getNumChannels(); ++ch)
+                hopBuffer.copyFrom (ch, hopFill, readBuffer, ch, 0, numRead);
+
+            hopFill += numRead;
+        }
+
+        if (hopFill < hopSize)
+        {
+            wait (5);
+            continue;
+        }
+
+        // Slide the window on by a hop and append the new samples, mixed to mono
+        std::copy (window.begin() + hopSize, window.end(), window.begin());
+
+        auto* newest = window.data() + (fftSize - hopSize);
+        juce::FloatVectorOperations::copy (newest, hopBuffer.getReadPointer (0), hopSize);
+        juce::FloatVectorOperations::add (newest, hopBuffer.getReadPointer (1), hopSize);
+        juce::FloatVectorOperations::multiply (newest, 0.5f, hopSize);
+
+        hopFill = 0;
+        analyseWindow();
+    }
+}
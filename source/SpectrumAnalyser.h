@@ -0,0 +1,86 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "AudioTap.h"
+#include "TripleBuffer.h"
+
+#include <array>
+#include <vector>
+
+//==============================================================================
+/** A log-frequency spectrum of a tap, worked out on its own thread.
+
+    The thread follows the tap sample by sample and takes a Hann-windowed FFT
+    every quarter frame (75% overlap). Bin magnitudes are gathered into bands
+    spaced evenly in log frequency, from 20 Hz to 20 kHz, and given meter
+    ballistics: an instant rise, an exponential fall, and a peak-hold line
+    that sits for a moment before dropping. Finished frames go to the UI
+    through a triple buffer, so nothing here touches the audio thread beyond
+    the tap itself.
+
+    The tap is only subscribed while the analyser is running.
+*/
+class SpectrumAnalyser  : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int numBands = 96;
+
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    static constexpr float minDb = -96.0f, maxDb = 0.0f;
+
+    struct Frame
+    {
+        std::array<float, numBands> levels;     // dB, smoothed
+        std::array<float, numBands> peaks;      // dB, held
+        juce::uint32 frameNumber = 0;
+
+        Frame()     { levels.fill (minDb); peaks.fill (minDb); }
+    };
+
+    explicit SpectrumAnalyser (const juce::String& tapName);
+    ~SpectrumAnalyser() override;
+
+    void start();
+    void stop();
+
+    /** Message thread: picks up the newest frame. Returns true if there was one. */
+    bool update()                                       { return frames.update(); }
+    const Frame& getFrame() const noexcept              { return frames.read(); }
+
+    /** Where a band sits, from 0 at minFrequency to 1 at maxFrequency. */
+    static float getFrequencyForProportion (float proportion) noexcept;
+
+private:
+    void run() override;
+    void analyseWindow();
+    void updateBands (double sampleRate);
+
+    const juce::String tapName;
+    AudioTap::Subscription tap;
+    juce::int64 readPosition = 0;
+
+    // Analysis thread only
+    juce::AudioBuffer<float> readBuffer { AudioTap::numChannels, hopSize };
+    juce::AudioBuffer<float> hopBuffer { AudioTap::numChannels, hopSize };
+    int hopFill = 0;
+    std::vector<float> window = std::vector<float> ((size_t) fftSize, 0.0f);
+    std::vector<float> fftData = std::vector<float> ((size_t) fftSize * 2, 0.0f);
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> windowing { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+
+    double bandSampleRate = 0.0;
+    std::array<float, numBands + 1> bandEdges {};    // in bins, fractional
+    std::array<float, numBands> levels, peaks;
+    std::array<int, numBands> peakHoldFrames {};
+
+    TripleBuffer<Frame> frames;
+    juce::uint32 frameNumber = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyser)
+};
@@ -0,0 +1,144 @@
+#include "SpectrumComponent.h"
+
+//==============================================================================
+SpectrumComponent::SpectrumComponent (const juce::String& tapName)
+    : analyser (tapName)
+{
+    setOpaque (true);
+}
+
+SpectrumComponent::~SpectrumComponent()
+{
+    stopTimer();
+    analyser.stop();
+}
+
+void SpectrumComponent::visibilityChanged()
+{
+    // Nothing is analysed, and the tap isn't written, while we can't be seen
+    if (isVisible())
+    {
+        analyser.start();
+        startTimerHz (60);
+    }
+    else
+    {
+        stopTimer();
+        analyser.stop();
+    }
+}
+
+void SpectrumComponent::resized()
+{
+    const int width = juce::jmax (1, getWidth());
+    const int height = juce::jmax (1, getHeight());
+
+    if (spectrogram.isValid() && spectrogram.getWidth() == width && spectrogram.getHeight() == height)
+        return;
+
+    spectrogram = juce::Image (juce::Image::RGB, width, height, true);
+}
+
+//==============================================================================
+float SpectrumComponent::getYForLevel (float db) const noexcept
+{
+    const float proportion = juce::jmap (db, SpectrumAnalyser::minDb, SpectrumAnalyser::maxDb, 0.0f, 1.0f);
+    return (float) getHeight() * (1.0f - juce::jlimit (0.0f, 1.0f, proportion));
+}
+
+juce::Colour SpectrumComponent::getColourForLevel (float db) noexcept
+{
+    const float proportion = juce::jmap (db, -72.0f, SpectrumAnalyser::maxDb, 0.0f, 1.0f);
+    const float level = juce::jlimit (0.0f, 1.0f, proportion);
+    const auto green = juce::Colour (0xFF00FF41);
+
+    // Black through green to white
+    return level < 0.7f ? juce::Colours::black.interpolatedWith (green, level / 0.7f)
+                        : green.interpolatedWith (juce::Colours::white, (level - 0.7f) / 0.3f);
+}
+
+void SpectrumComponent::addSpectrogramColumn (const SpectrumAnalyser::Frame& frame)
+{
+    if (! spectrogram.isValid())
+        return;
+
+    const int width = spectrogram.getWidth();
+    const int height = spectrogram.getHeight();
+
+    spectrogram.moveImageSection (0, 0, 1, 0, width - 1, height);
+
+    // Low frequencies at the bottom, one band per run of rows
+    juce::Image::BitmapData pixels (spectrogram, width - 1, 0, 1, height, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const float proportion = 1.0f - (float) y / (float) juce::jmax (1, height - 1);
+        const int band = juce::jlimit (0, SpectrumAnalyser::numBands - 1,
+                                       (int) (proportion * (float) SpectrumAnalyser::numBands));
+
+        pixels.setPixelColour (0, y, getColourForLevel (frame.levels[(size_t) band]));
+    }
+}
+
+juce::Path SpectrumComponent::createSpectrumPath (const std::array<float, SpectrumAnalyser::numBands>& bands) const
+{
+    juce::Path path;
+    const float bandWidth = (float) getWidth() / (float) (SpectrumAnalyser::numBands - 1);
+
+    for (int band = 0; band < SpectrumAnalyser::numBands; ++band)
+    {
+        const float x = (float) band * bandWidth;
+        const float y = getYForLevel (bands[(size_t) band]);
+
+        if (band == 0)
+            path.startNewSubPath (x, y);
+        else
+            path.lineTo (x, y);
+    }
+
+    return path;
+}
+
+void SpectrumComponent::timerCallback()
+{
+    if (! analyser.update())
+        return;
+
+    const auto& frame = analyser.getFrame();
+    addSpectrogramColumn (frame);
+    levelPath = createSpectrumPath (frame.levels);
+    peakPath = createSpectrumPath (frame.peaks);
+
+    repaint();
+}
+
+void SpectrumComponent::paint (juce::Graphics& g)
+{
+    g.setOpacity (1.0f);
+    g.drawImageAt (spectrogram, 0, 0);
+
+    // Dim the history so the live curves stand out over it
+    g.setColour (juce::Colours::black.withAlpha (0.35f));
+    g.fillRect (getLocalBounds());
+
+    g.setColour (juce::Colour (0xFF00FF41));
+    g.strokePath (levelPath, juce::PathStrokeType (1.5f));
+
+    g.setColour (juce::Colours::white.withAlpha (0.6f));
+    g.strokePath (peakPath, juce::PathStrokeType (1.0f));
+
+    // Decade markers
+    g.setColour (juce::Colours::white.withAlpha (0.4f));
+    g.setFont (juce::FontOptions (11.0f));
+
+    for (float frequency : { 100.0f, 1000.0f, 10000.0f })
+    {
+        const float proportion = std::log (frequency / SpectrumAnalyser::minFrequency)
+                               / std::log (SpectrumAnalyser::maxFrequency / SpectrumAnalyser::minFrequency);
+        const int x = juce::roundToInt (proportion * (float) getWidth());
+
+        g.drawVerticalLine (x, 0.0f, (float) getHeight());
+        g.drawText (frequency >= 1000.0f ? juce::String ((int) frequency / 1000) + "k" : juce::String ((int) frequency),
+                    x + 2, getHeight() - 14, 30, 12, juce::Justification::centredLeft);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_graphics/juce_graphics.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include "SpectrumAnalyser.h"
+
+//==============================================================================
+/** Draws a SpectrumAnalyser as a scrolling spectrogram with the current
+    spectrum and its peak-hold line over the top.
+
+    Everything is software-rendered. The spectrogram lives in a cached image
+    that's scrolled one column per frame, so each repaint only adds one
+    column and strokes two short paths, whatever the size of the component.
+*/
+class SpectrumComponent  : public juce::Component,
+                           private juce::Timer
+{
+public:
+    explicit SpectrumComponent (const juce::String& tapName);
+    ~SpectrumComponent() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+    void addSpectrogramColumn (const SpectrumAnalyser::Frame&);
+    juce::Path createSpectrumPath (const std::array<float, SpectrumAnalyser::numBands>&) const;
+
+    float getYForLevel (float db) const noexcept;
+    static juce::Colour getColourForLevel (float db) noexcept;
+
+    SpectrumAnalyser analyser;
+    juce::Image spectrogram;
+    juce::Path levelPath, peakPath;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumComponent)
+};
@@ -0,0 +1,45 @@
+#include "TapPlugin.h"
+
+namespace tracktion { inline namespace engine
+{
+
+//==============================================================================
+const char* TapPlugin::xmlTypeName ("tap");
+
+TapPlugin::TapPlugin (PluginCreationInfo info)  : Plugin (info)
+{
+    // The tap is looked up once here, so the audio thread never touches the service
+    tap = AudioTapService::getInstance()->getOrCreateTap (state[IDs::name].toString());
+}
+
+TapPlugin::~TapPlugin()
+{
+    notifyListenersOfDeletion();
+}
+
+juce::ValueTree TapPlugin::create (const juce::String& tapName)
+{
+    return createValueTree (IDs::PLUGIN,
+                            IDs::type, xmlTypeName,
+                            IDs::name, tapName);
+}
+
+void TapPlugin::initialise (const PluginInitialisationInfo& info)
+{
+    if (tap != nullptr && info.sampleRate > 0.0)
+        tap->prepare (info.sampleRate);
+}
+
+void TapPlugin::deinitialise()
+{
+}
+
+void TapPlugin::applyToBuffer (const PluginRenderContext& rc)
+{
+    if (tap == nullptr || ! tap->isWanted() || rc.destBuffer == nullptr || rc.bufferNumSamples <= 0)
+        return;
+
+    tap->write (*rc.destBuffer, rc.bufferStartSample, rc.bufferNumSamples);
+}
+
+}} // namespace tracktion { inline namespace engine
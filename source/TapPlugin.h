@@ -0,0 +1,49 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "AudioTap.h"
+
+namespace tracktion { inline namespace engine
+{
+
+/** Writes whatever passes through it into a named AudioTap.
+
+    Put one wherever the signal needs watching: on a deck's track, either side
+    of the effects, on the master. Readers subscribe to the tap by name through
+    the AudioTapService, so any number of them share one capture. The plugin
+    passes audio through untouched, and does nothing while no one is reading.
+*/
+class TapPlugin   : public Plugin
+{
+public:
+    TapPlugin (PluginCreationInfo);
+    ~TapPlugin() override;
+
+    static const char* getPluginName()                  { return NEEDS_TRANS("Tap"); }
+    static juce::ValueTree create (const juce::String& tapName);
+
+    //==============================================================================
+    static const char* xmlTypeName;
+
+    bool canBeAddedToFolderTrack() override             { return true; }
+    juce::String getName() const override               { return TRANS("Tap") + ": " + getTapName(); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    void initialise (const PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const PluginRenderContext&) override;
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return numInputChannels; }
+    bool producesAudioWhenNoAudioInput() override       { return false; }
+    juce::String getSelectableDescription() override    { return TRANS("Tap Plugin"); }
+
+    juce::String getTapName() const                     { return tap != nullptr ? tap->getName() : juce::String(); }
+
+private:
+    AudioTap::Ptr tap;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TapPlugin)
+};
+
+}} // namespace tracktion { inline namespace engine
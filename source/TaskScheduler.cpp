@@ -0,0 +1,337 @@
+#include "TaskScheduler.h"
+#include "RealtimeMode.h"
+
+//==============================================================================
+class TaskScheduler::Worker  : public juce::Thread
+{
+public:
+    Worker (TaskScheduler& o, int i)
+        : juce::Thread ("ChopShop Worker " + juce::String (i)), owner (o)
+    {
+    }
+
+    ~Worker() override
+    {
+        stopThread (10000);
+    }
+
+    void run() override
+    {
+        currentWorker = this;
+
+        // Keep going until the queues are empty even when asked to exit, since
+        // a TaskGroup somewhere may be waiting for the tasks still queued
+        for (;;)
+        {
+            Task task;
+
+            if (owner.findTask (this, task))
+                owner.execute (task);
+            else if (threadShouldExit())
+                break;
+            else
+                owner.waitForWork();
+        }
+
+        currentWorker = nullptr;
+    }
+
+    static thread_local Worker* currentWorker;
+
+    TaskScheduler& owner;
+    juce::SpinLock lock;
+    std::deque<Task> queues[numPriorities];
+
+    // Only ever used by this worker's thread, to pick where to start stealing
+    juce::Random random;
+};
+
+thread_local TaskScheduler::Worker* TaskScheduler::Worker::currentWorker = nullptr;
+
+//==============================================================================
+TaskScheduler::TaskScheduler()
+{
+    const int numCpus = juce::jlimit (1, 32, juce::SystemStats::getNumCpus());
+
+    // With enough cores, keep the top ones for the audio threads and one more
+    // free for the message thread, leaving at least two for background work
+    const int numReserved = numCpus >= 4 ? juce::jmin (numAudioThreads, numCpus - 3) : 0;
+
+    for (int i = 0; i < numReserved; ++i)
+        audioCoreMask |= 1u << (numCpus - 1 - i);
+
+    const juce::uint32 allCores = numCpus == 32 ? 0xffffffffu : ((1u << numCpus) - 1u);
+    const juce::uint32 workerMask = allCores & ~audioCoreMask;
+    const int numWorkers = juce::jmax (1, numCpus - numReserved - 1);
+
+    // Workers steal from each other as soon as they start, so the array has
+    // to be complete before any of them runs
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add (new Worker (*this, i));
+
+    for (auto* worker : workers)
+    {
+        if (audioCoreMask != 0)
+            worker->setAffinityMask (workerMask);
+
+        worker->startThread (juce::Thread::Priority::low);
+    }
+
+    DBG ("TaskScheduler: " + juce::String (numWorkers) + " workers, audio core mask 0x"
+         + juce::String::toHexString ((int) audioCoreMask));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    shutdown();
+}
+
+void TaskScheduler::shutdown()
+{
+    shuttingDown = true;
+
+    for (auto* w : workers)
+        w->signalThreadShouldExit();
+
+    workAvailable.notify_all();
+
+    // Join every worker before deleting any, since a running one may be
+    // stealing from any of the others
+    for (auto* w : workers)
+        w->stopThread (10000);
+
+    workers.clear();
+}
+
+bool TaskScheduler::schedule (std::function<void()> task, TaskPriority priority, CancellationToken token)
+{
+    return push ({ std::move (task), std::move (token) }, priority);
+}
+
+bool TaskScheduler::push (Task task, TaskPriority priority)
+{
+    if (shuttingDown)
+        return false;
+
+    const int p = (int) priority;
+
+    // Work spawned by a worker stays with that worker until someone steals it
+    if (auto* worker = Worker::currentWorker; worker != nullptr && &worker->owner == this)
+    {
+        const juce::SpinLock::ScopedLockType sl (worker->lock);
+        worker->queues[p].push_back (std::move (task));
+    }
+    else
+    {
+        const std::lock_guard<std::mutex> sl (sharedLock);
+        sharedQueues[p].push_back (std::move (task));
+    }
+
+    ++numQueued;
+    workAvailable.notify_one();
+    return true;
+}
+
+bool TaskScheduler::popLocal (Worker& worker, int priority, Task& task)
+{
+    const juce::SpinLock::ScopedLockType sl (worker.lock);
+    auto& q = worker.queues[priority];
+
+    if (q.empty())
+        return false;
+
+    task = std::move (q.back());
+    q.pop_back();
+    return true;
+}
+
+bool TaskScheduler::popShared (int priority, Task& task)
+{
+    const std::lock_guard<std::mutex> sl (sharedLock);
+    auto& q = sharedQueues[priority];
+
+    if (q.empty())
+        return false;
+
+    task = std::move (q.front());
+    q.pop_front();
+    return true;
+}
+
+bool TaskScheduler::steal (Worker& thief, int priority, Task& task)
+{
+    const int numWorkers = workers.size();
+    const int start = thief.random.nextInt (juce::jmax (1, numWorkers));
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* victim = workers.getUnchecked ((start + i) % numWorkers);
+
+        if (victim == &thief)
+            continue;
+
+        const juce::SpinLock::ScopedTryLockType sl (victim->lock);
+
+        if (! sl.isLocked() || victim->queues[priority].empty())
+            continue;
+
+        // Take the oldest task, furthest from what the victim is working on
+        task = std::move (victim->queues[priority].front());
+        victim->queues[priority].pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+bool TaskScheduler::findTask (Worker* worker, Task& task)
+{
+    for (int p = 0; p < numPriorities; ++p)
+    {
+        if (worker != nullptr && popLocal (*worker, p, task))
+            return true;
+
+        if (popShared (p, task))
+            return true;
+
+        if (worker != nullptr && steal (*worker, p, task))
+            return true;
+    }
+
+    return false;
+}
+
+void TaskScheduler::execute (Task& task)
+{
+    --numQueued;
+
+    if (! task.token.isCancelled())
+        task.function();
+}
+
+void TaskScheduler::waitForWork()
+{
+    std::unique_lock<std::mutex> sl (sleepLock);
+
+    // The timeout covers the small window between checking the queues and
+    // going to sleep, rather than needing a lock around every push
+    workAvailable.wait_for (sl, std::chrono::milliseconds (20),
+                            [this] { return numQueued.load() > 0 || shuttingDown.load(); });
+}
+
+//==============================================================================
+TaskScheduler::TaskGroup::TaskGroup (TaskPriority p, CancellationToken t)
+    : scheduler (*TaskScheduler::getInstance()), priority (p), token (std::move (t))
+{
+}
+
+TaskScheduler::TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+void TaskScheduler::TaskGroup::run (std::function<void()> task)
+{
+    {
+        const std::lock_guard<std::mutex> sl (state->lock);
+        ++state->pending;
+    }
+
+    // The group's own token decides whether the body runs, but the wrapper
+    // always runs so the pending count can't get stuck. It only touches the
+    // shared state, never the group, which may be gone once the count is 0
+    std::function<void()> wrapper = [s = state, t = token, task = std::move (task)]
+    {
+        if (! t.isCancelled())
+            task();
+
+        const std::lock_guard<std::mutex> sl (s->lock);
+
+        if (--s->pending == 0)
+            s->done.notify_all();
+    };
+
+    // During shutdown there's nobody left to run it, so do it here
+    if (! scheduler.schedule (wrapper, priority))
+        wrapper();
+}
+
+void TaskScheduler::TaskGroup::wait()
+{
+    auto* worker = Worker::currentWorker;
+    auto isDone = [this] { return state->pending == 0; };
+
+    if (worker == nullptr)
+    {
+        std::unique_lock<std::mutex> sl (state->lock);
+        state->done.wait (sl, isDone);
+        return;
+    }
+
+    // On a worker, help out rather than block it, so nested groups can't starve the pool
+    for (;;)
+    {
+        {
+            const std::lock_guard<std::mutex> sl (state->lock);
+
+            if (isDone())
+                return;
+        }
+
+        Task task;
+
+        if (scheduler.findTask (worker, task))
+        {
+            scheduler.execute (task);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> sl (state->lock);
+            state->done.wait_for (sl, std::chrono::milliseconds (1), isDone);
+        }
+    }
+}
+
+//==============================================================================
+void TaskScheduler::pinToAudioCores() noexcept
+{
+    static thread_local bool pinned = false;
+
+    if (pinned)
+        return;
+
+    if (const auto mask = getInstance()->getAudioCoreMask(); mask != 0)
+        juce::Thread::setCurrentThreadAffinityMask (mask);
+
+    pinned = true;
+}
+
+//==============================================================================
+void TaskScheduler::AudioThreadPinner::audioDeviceIOCallbackWithContext (const float* const*, int,
+                                                                         float* const* outputChannelData, int numOutputChannels,
+                                                                         int numSamples, const juce::AudioIODeviceCallbackContext&)
+{
+    const auto thisThread = juce::Thread::getCurrentThreadId();
+
+    // A little setup the first time round on each new device thread, nothing
+    // after that: pin it, ask for real-time priority and fault in some stack
+    if (pinnedThread.load (std::memory_order_relaxed) != thisThread)
+    {
+        if (const auto mask = TaskScheduler::getInstance()->getAudioCoreMask(); mask != 0)
+            juce::Thread::setCurrentThreadAffinityMask (mask);
+
+        RealtimeMode::getInstance()->requestPromotion (RealtimeMode::Role::audio);
+        RealtimeMode::prefaultStack();
+
+        pinnedThread = thisThread;
+    }
+
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+        if (outputChannelData[ch] != nullptr)
+            juce::FloatVectorOperations::clear (outputChannelData[ch], numSamples);
+}
+
+void TaskScheduler::AudioThreadPinner::audioDeviceAboutToStart (juce::AudioIODevice*)
+{
+    pinnedThread = nullptr;
+}
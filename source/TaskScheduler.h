@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_devices/juce_audio_devices.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+//==============================================================================
+/** Shared flag a task can poll to find out it's no longer wanted.
+
+    Copies refer to the same flag, so the code that schedules the work keeps
+    one copy to cancel with and hands another to the task.
+*/
+class CancellationToken
+{
+public:
+    CancellationToken() : flag (std::make_shared<std::atomic<bool>> (false)) {}
+
+    void cancel() noexcept                      { flag->store (true); }
+    bool isCancelled() const noexcept           { return flag->load (std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+//==============================================================================
+enum class TaskPriority
+{
+    interactive,    // someone is waiting on it, e.g. the track being loaded
+    bulk            // background churn, e.g. rescanning a crate
+};
+
+//==============================================================================
+/** The app-wide pool for background work.
+
+    Each worker has its own deque per priority. Work spawned from a worker goes
+    on that worker's deque and is taken back LIFO, which keeps related tasks on
+    a warm cache; idle workers steal the oldest work from the other end of a
+    busy worker's deque. Work from outside goes through a shared queue.
+    Interactive work is always picked before bulk work.
+
+    Workers are pinned away from the cores reserved for real-time audio, one
+    for each of the numAudioThreads Tracktion renders on. AudioThreadPinner
+    moves the audio device thread onto those cores and pinToAudioCores() does
+    the same for Tracktion's audio workers, so background analysis never
+    competes with the audio callback for a core.
+*/
+class TaskScheduler
+{
+public:
+    static TaskScheduler* getInstance()
+    {
+        static TaskScheduler instance;
+        return &instance;
+    }
+
+    /** The threads Tracktion renders audio on: the device thread, which mixes
+        the master, and one worker per deck.
+    */
+    static constexpr int numAudioThreads = 3;
+
+    /** Queues a task. It's skipped if the token has been cancelled by the time
+        a worker gets to it; long tasks should also poll the token themselves.
+        Returns false, without queueing, once the scheduler has been shut down.
+    */
+    bool schedule (std::function<void()> task,
+                   TaskPriority priority = TaskPriority::bulk,
+                   CancellationToken token = {});
+
+    /** Stops accepting work, lets the workers finish what's already queued and
+        joins them. Anything long-running should have been cancelled first.
+    */
+    void shutdown();
+
+    int getNumWorkers() const noexcept                  { return workers.size(); }
+
+    /** Bit mask of the cores kept free for audio threads. */
+    juce::uint32 getAudioCoreMask() const noexcept      { return audioCoreMask; }
+
+    /** How many cores are kept free for audio, which is as many audio threads
+        as the engine should run; fewer than numAudioThreads on small machines,
+        and 0 if there aren't enough cores to keep any.
+    */
+    int getNumAudioCores() const noexcept               { return juce::countNumberOfBits (audioCoreMask); }
+
+    /** Audio threads: pins the calling thread to the audio cores the first
+        time it's called on that thread, and costs one thread_local check
+        after that. For Tracktion's audio workers, which the app doesn't start
+        itself, so it's called from the plugins they render.
+    */
+    static void pinToAudioCores() noexcept;
+
+    //==============================================================================
+    /** Fork/join helper: run() a set of tasks, then wait() for all of them.
+
+        wait() works through queued tasks itself while it waits, so it's safe to
+        call from inside another task without tying up a worker.
+    */
+    class TaskGroup
+    {
+    public:
+        explicit TaskGroup (TaskPriority, CancellationToken = {});
+        ~TaskGroup();
+
+        void run (std::function<void()> task);
+        void wait();
+
+    private:
+        // Shared with every queued wrapper, so a wrapper finishing after wait()
+        // has returned and the group has gone still has something to count down
+        struct State
+        {
+            std::mutex lock;
+            std::condition_variable done;
+            int pending = 0;
+        };
+
+        TaskScheduler& scheduler;
+        TaskPriority priority;
+        CancellationToken token;
+        std::shared_ptr<State> state { std::make_shared<State>() };
+
+        JUCE_DECLARE_NON_COPYABLE (TaskGroup)
+    };
+
+    //==============================================================================
+    /** Add this to the device manager as an extra callback; the first time the
+        device thread calls it, the thread gets pinned to the audio cores and
+        put up for real-time priority with RealtimeMode.
+        Produces silence, so it doesn't affect the output.
+    */
+    class AudioThreadPinner  : public juce::AudioIODeviceCallback
+    {
+    public:
+        void audioDeviceIOCallbackWithContext (const float* const*, int,
+                                               float* const* outputChannelData, int numOutputChannels,
+                                               int numSamples, const juce::AudioIODeviceCallbackContext&) override;
+        void audioDeviceAboutToStart (juce::AudioIODevice*) override;
+        void audioDeviceStopped() override {}
+
+    private:
+        std::atomic<juce::Thread::ThreadID> pinnedThread { nullptr };
+    };
+
+private:
+    TaskScheduler();
+    ~TaskScheduler();
+
+    struct Task
+    {
+        std::function<void()> function;
+        CancellationToken token;
+    };
+
+    static constexpr int numPriorities = 2;
+
+    class Worker;
+
+    bool popLocal (Worker&, int priority, Task&);
+    bool popShared (int priority, Task&);
+    bool steal (Worker& thief, int priority, Task&);
+    bool findTask (Worker*, Task&);
+    void execute (Task&);
+    bool push (Task, TaskPriority);
+    void waitForWork();
+
+    juce::OwnedArray<Worker> workers;
+    juce::uint32 audioCoreMask = 0;
+
+    std::mutex sharedLock;
+    std::deque<Task> sharedQueues[numPriorities];
+
+    std::mutex sleepLock;
+    std::condition_variable workAvailable;
+    std::atomic<int> numQueued { 0 };
+    std::atomic<bool> shuttingDown { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TaskScheduler)
+};
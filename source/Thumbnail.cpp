@@ -33,7 +33,15 @@ void Thumbnail::paint(juce::Graphics& g)
     g.drawRoundedRectangle(bounds.toFloat().reduced(0.5f), 4.0f, 1.0f);
     
     // Draw waveform
-    if (smartThumbnail.isGeneratingProxy())
+    if (peakCache != nullptr)
+    {
+        drawTimeMarkers(g, bounds);
+        
+        g.setColour(waveformColor);
+        const auto range = getDisplayRange();
+        peakCache->draw(g, bounds.reduced(4), range.getStart(), range.getEnd());
+    }
+    else if (smartThumbnail.isGeneratingProxy())
     {
         // Show loading progress
         g.setColour(juce::Colours::white);
@@ -50,10 +58,11 @@ void Thumbnail::paint(juce::Graphics& g)
         const float brightness = smartThumbnail.isOutOfDate() ? 0.4f : 1.0f;
         g.setColour(waveformColor.withMultipliedBrightness(brightness));
         
-        auto totalLength = tracktion::TimePosition::fromSeconds(smartThumbnail.getTotalLength());
+        const auto range = getDisplayRange();
         auto waveformBounds = bounds.reduced(4);
         
-        smartThumbnail.drawChannels(g, waveformBounds, { tracktion::TimePosition::fromSeconds(0), totalLength }, 1.0f);
+        smartThumbnail.drawChannels(g, waveformBounds, { tracktion::TimePosition::fromSeconds(range.getStart()),
+                                                         tracktion::TimePosition::fromSeconds(range.getEnd()) }, 1.0f);
     }
     else
     {
@@ -61,7 +70,10 @@ void Thumbnail::paint(juce::Graphics& g)
         g.setColour(juce::Colours::white.withAlpha(0.5f));
         g.setFont(16.0f);
         g.drawText("No audio file loaded", bounds, juce::Justification::centred);
+        return;
     }
+    
+    drawHotCueMarkers(g, bounds);
 }
 
 void Thumbnail::resized()
@@ -147,10 +159,30 @@ void Thumbnail::start()
 
 void Thumbnail::setFile(const tracktion::engine::AudioFile& file)
 {
-    smartThumbnail.setNewFile(file);
+    peakCache = PeakCache::loadFor(file.getFile());
+    
+    // Only fall back to building a proxy if the file hasn't been through analysis
+    smartThumbnail.setNewFile(peakCache != nullptr ? tracktion::engine::AudioFile(transport.engine) : file);
     repaint();
 }
 
+void Thumbnail::setSourceRange(juce::Range<double> newRange)
+{
+    sourceRange = newRange;
+    repaint();
+}
+
+juce::Range<double> Thumbnail::getDisplayRange() const
+{
+    const juce::Range<double> wholeFile(0.0, getTotalLength());
+    return sourceRange.isEmpty() ? wholeFile : wholeFile.getIntersectionWith(sourceRange);
+}
+
+double Thumbnail::getTotalLength() const
+{
+    return peakCache != nullptr ? peakCache->getLengthInSeconds() : smartThumbnail.getTotalLength();
+}
+
 void Thumbnail::setSpeedRatio(double ratio)
 {
     currentSpeedRatio = ratio;
@@ -186,6 +218,17 @@ void Thumbnail::timerCallback()
 {
     updateCursorPosition();
     
+    if (getHotCuePositions)
+    {
+        auto positions = getHotCuePositions();
+        
+        if (positions != hotCueMarkers)
+        {
+            hotCueMarkers = std::move(positions);
+            repaint();
+        }
+    }
+    
     if (smartThumbnail.isGeneratingProxy() || smartThumbnail.isOutOfDate())
         repaint();
 }
@@ -243,11 +286,13 @@ void Thumbnail::updateCursorPosition()
 
 void Thumbnail::drawTimeMarkers(juce::Graphics& g, juce::Rectangle<int> bounds)
 {
-    if (smartThumbnail.getTotalLength() <= 0.0)
+    const auto range = getDisplayRange();
+    
+    if (range.isEmpty())
         return;
     
     const int numMarkers = 10;
-    const float totalSeconds = static_cast<float>(smartThumbnail.getTotalLength());
+    const float totalSeconds = static_cast<float>(range.getLength());
     
     g.setColour(juce::Colours::white.withAlpha(0.4f));
     g.setFont(12.0f);
@@ -262,7 +307,7 @@ void Thumbnail::drawTimeMarkers(juce::Graphics& g, juce::Rectangle<int> bounds)
         g.drawLine(x, bounds.getY() + 2, x, bounds.getBottom() - 2, 1.0f);
         
         // Draw time label
-        const float timeInSeconds = proportion * totalSeconds;
+        const float timeInSeconds = static_cast<float>(range.getStart()) + proportion * totalSeconds;
         const int minutes = static_cast<int>(timeInSeconds) / 60;
         const int seconds = static_cast<int>(timeInSeconds) % 60;
         
@@ -274,6 +319,41 @@ void Thumbnail::drawTimeMarkers(juce::Graphics& g, juce::Rectangle<int> bounds)
     }
 }
 
+void Thumbnail::drawHotCueMarkers(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    // Same mapping as the cursor, so a cue sits where the playhead lands on it
+    const auto loopRange = transport.getLoopRange();
+    const auto loopLength = loopRange.getLength().inSeconds();
+    
+    if (loopLength <= 0.0)
+        return;
+    
+    const auto area = bounds.reduced(4).toFloat();
+    g.setFont(10.0f);
+    
+    for (size_t slot = 0; slot < hotCueMarkers.size(); ++slot)
+    {
+        if (!hotCueMarkers[slot].has_value())
+            continue;
+        
+        const auto proportion = (*hotCueMarkers[slot] - loopRange.getStart()).inSeconds() / loopLength;
+        
+        if (proportion < 0.0 || proportion > 1.0)
+            continue;
+        
+        const float x = area.getX() + static_cast<float>(proportion) * area.getWidth();
+        const auto colour = juce::Colour::fromHSV(static_cast<float>(slot) / static_cast<float>(hotCueMarkers.size()), 0.7f, 1.0f, 0.9f);
+        
+        g.setColour(colour);
+        g.drawVerticalLine(juce::roundToInt(x), area.getY(), area.getBottom());
+        g.fillRect(x, area.getY(), 12.0f, 12.0f);
+        
+        g.setColour(juce::Colours::black);
+        g.drawText(juce::String(static_cast<int>(slot) + 1), juce::Rectangle<float>(x, area.getY(), 12.0f, 12.0f),
+                   juce::Justification::centred, false);
+    }
+}
+
 tracktion::TimePosition Thumbnail::roundToNearest(tracktion::TimePosition pos, const tracktion::engine::TempoSequence& ts, int quantisationNumBars)
 {
     // Convert time to beats
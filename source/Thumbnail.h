@@ -7,6 +7,8 @@
 #include <juce_audio_utils/juce_audio_utils.h>
 #include <tracktion_engine/tracktion_engine.h>
 
+#include "PeakCache.h"
+
 //==============================================================================
 /**
  * A modern audio visualization component that displays waveforms with playback position
@@ -36,6 +38,11 @@ public:
     /** Set the audio file to display */
     void setFile(const tracktion::engine::AudioFile& file);
     
+    /** Show only this part of the file, in source seconds, to match the loop
+        range. An empty range shows the whole file.
+    */
+    void setSourceRange(juce::Range<double> newRange);
+    
     /** Set the playback speed ratio (for time-stretching visualization) */
     void setSpeedRatio(double ratio);
     
@@ -50,12 +57,26 @@ public:
     
     /** Set the background color */
     void setBackgroundColor(juce::Colour color);
+    
+    /** Polled with the cursor; returns the edit-time position of each hot cue
+        slot, or an empty optional for slots that aren't set.
+    */
+    std::function<std::vector<std::optional<tracktion::TimePosition>>()> getHotCuePositions;
 
 private:
     //==============================================================================
     tracktion::engine::TransportControl& transport;
     tracktion::engine::SmartThumbnail smartThumbnail;
     
+    // Peaks written by the library analysis pass; when present, the file is
+    // drawn from these and SmartThumbnail never has to decode it
+    std::unique_ptr<PeakCache> peakCache;
+    
+    juce::Range<double> sourceRange;
+    
+    double getTotalLength() const;
+    juce::Range<double> getDisplayRange() const;
+    
     // Visual elements
     juce::DrawableRectangle cursor;
     juce::DrawableRectangle pendingCursor;
@@ -74,8 +95,11 @@ private:
     juce::Colour cursorColor = juce::Colours::red;
     juce::Colour backgroundColor = juce::Colours::black.withAlpha(0.7f);
     
+    std::vector<std::optional<tracktion::TimePosition>> hotCueMarkers;
+    
     // Draw time markers on the waveform
     void drawTimeMarkers(juce::Graphics& g, juce::Rectangle<int> bounds);
+    void drawHotCueMarkers(juce::Graphics& g, juce::Rectangle<int> bounds);
     
     // Helper methods for quantization
     static tracktion::TimePosition roundToNearest(tracktion::TimePosition pos, const tracktion::engine::TempoSequence& ts, int quantisationNumBars);
@@ -0,0 +1,52 @@
+#include "TrackAnalyser.h"
+#include "FeatureExtractors.h"
+
+#include <cmath>
+
+namespace TrackAnalyser
+{
+
+std::optional<TrackAnalysis> analyseFile (const juce::File& file, const std::function<bool()>& shouldAbort,
+                                          TaskPriority priority, bool trackBeats)
+{
+    AnalysisPipeline pipeline (priority);
+    pipeline.addExtractor (std::make_unique<TempoExtractor> (trackBeats));
+    pipeline.addExtractor (std::make_unique<LoudnessExtractor>());
+    pipeline.addExtractor (std::make_unique<KeyExtractor>());
+    pipeline.addExtractor (std::make_unique<PeakExtractor>());
+    pipeline.addExtractor (std::make_unique<SilenceExtractor>());
+    pipeline.addExtractor (std::make_unique<DownbeatExtractor>());   // uses the tempo and silence results
+
+    TrackAnalysis result;
+
+    if (! pipeline.run (file, result, shouldAbort))
+        return std::nullopt;
+
+    DBG ("TrackAnalyser: " + file.getFileName()
+         + " BPM " + juce::String (result.bpm, 1)
+         + ", " + juce::String (result.integratedLufs, 1) + " LUFS"
+         + ", " + juce::String (result.truePeakDb, 1) + " dBTP"
+         + ", LRA " + juce::String (result.loudnessRange, 1) + " LU"
+         + ", key " + KeyDetector::estimateKey (result.chroma).getName()
+         + ", audio " + juce::String (result.cues.audioStart, 2) + "-" + juce::String (result.cues.audioEnd, 2) + "s"
+         + ", downbeat " + juce::String (result.cues.firstDownbeat, 2) + "s"
+         + ", " + juce::String ((int) result.beats.size()) + " beats");
+
+    return result;
+}
+
+float getNormalisationGainDb (double integratedLufs, double truePeakDb)
+{
+    if (! std::isfinite (integratedLufs))
+        return 0.0f;
+
+    double gain = targetLoudnessLufs - integratedLufs;
+
+    // Quiet, dynamic tracks would clip if brought all the way up, so stop at the ceiling
+    if (std::isfinite (truePeakDb))
+        gain = juce::jmin (gain, truePeakCeilingDb - truePeakDb);
+
+    return juce::jlimit (-maxNormalisationGainDb, maxNormalisationGainDb, (float) gain);
+}
+
+} // namespace TrackAnalyser
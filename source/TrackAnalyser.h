@@ -0,0 +1,66 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include "KeyDetector.h"
+#include "TaskScheduler.h"
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+/** Where the music actually is in a file, in seconds from its start. */
+struct CuePoints
+{
+    double audioStart = 0.0;        // end of the leading silence
+    double audioEnd = 0.0;          // start of the trailing silence
+    double firstDownbeat = -1.0;    // first strong bar start, or negative if no grid was found
+
+    /** Where playback should start on load. */
+    double getStart() const noexcept    { return firstDownbeat >= 0.0 ? firstDownbeat : audioStart; }
+};
+
+/** Everything we learn about a track from one decode of the file. */
+struct TrackAnalysis
+{
+    double bpm = 120.0;
+
+    double integratedLufs = -std::numeric_limits<double>::infinity();
+    double truePeakDb = -std::numeric_limits<double>::infinity();
+    double loudnessRange = 0.0;
+
+    ChromaProfile chroma {};    // all zeros if nothing pitched was found
+
+    std::vector<double> beats;  // every beat in seconds, empty if none could be tracked
+
+    CuePoints cues;
+    bool hasCues = false;
+};
+
+/** Runs the standard set of feature extractors over a file in one decode:
+    tempo and beats, loudness, key, silence and downbeat cues, and the waveform peaks
+    for the thumbnail.
+*/
+namespace TrackAnalyser
+{
+    /** Analyses the file on the calling thread. Returns nothing if the file
+        can't be read or shouldAbort() returns true part way through. Beat
+        tracking can be left out, e.g. to measure what it adds.
+    */
+    std::optional<TrackAnalysis> analyseFile (const juce::File& file,
+                                              const std::function<bool()>& shouldAbort = {},
+                                              TaskPriority priority = TaskPriority::bulk,
+                                              bool trackBeats = true);
+
+    /** Gain in dB that brings a track to the playback target loudness without
+        pushing its true peak over the ceiling.
+    */
+    float getNormalisationGainDb (double integratedLufs, double truePeakDb);
+
+    constexpr double targetLoudnessLufs = -14.0;
+    constexpr double truePeakCeilingDb = -1.0;
+    constexpr float maxNormalisationGainDb = 12.0f;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+/** Hands the latest value from one writer thread to one reader thread.
+
+    There are three copies of the value. The writer fills its back copy and
+    swaps it into the middle; the reader swaps the middle out whenever there's
+    something newer there. Neither side ever waits for the other, the writer
+    never overwrites what the reader is looking at, and the reader always sees
+    a whole value from a single write. Values the reader is too slow to pick
+    up are simply replaced.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    /** Writer only: the copy to fill in before calling publish(). */
+    Type& getWriteBuffer() noexcept                 { return slots[(size_t) backIndex]; }
+
+    /** Writer only: makes the write buffer the latest value. */
+    void publish() noexcept
+    {
+        backIndex = middle.exchange (backIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /** Reader only: picks up the latest value if there is one. Returns true if it changed. */
+    bool update() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        frontIndex = middle.exchange (frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader only: the value picked up by the last update(). */
+    const Type& read() const noexcept               { return slots[(size_t) frontIndex]; }
+
+private:
+    static constexpr int indexMask = 3, newDataFlag = 4;
+
+    std::array<Type, 3> slots {};
+    std::atomic<int> middle { 1 };
+    int backIndex = 0;      // writer
+    int frontIndex = 2;     // reader
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
@@ -148,6 +148,27 @@ namespace EngineHelpers
         return te::getAudioTracks (edit)[index];
     }
 
+    /** Sets the edit's tempo without touching the undo history.
+
+        The tempo is performed live by the screw and the brake, many times a
+        second. Inserting a tempo each time would grow the sequence for the
+        whole set, so the first tempo is moved in place instead, and only
+        written when it actually changes.
+    */
+    inline void setTempo (te::Edit& edit, double bpm)
+    {
+        auto& ts = edit.tempoSequence;
+
+        if (ts.getNumTempos() == 0)
+            ts.insertTempo (te::TimePosition());
+
+        bpm = jlimit (1.0, 999.0, bpm);     // what Tracktion's own setter allows
+
+        if (auto tempo = ts.getTempo (0))
+            if (std::abs (tempo->getBpm() - bpm) > 1.0e-9)
+                tempo->state.setProperty (te::IDs::bpm, bpm, nullptr);
+    }
+
     inline te::WaveAudioClip::Ptr loadAudioFileAsClip (te::Edit& edit, const File& file)
     {
         // Find the first track and delete all clips from it
@@ -69,9 +69,6 @@ void VinylBrakeComponent::sliderValueChanged(juce::Slider* slider)
 
 void VinylBrakeComponent::setSpeed(double value)
 {
-    // Get the tempo sequence from the edit
-    auto& tempoSequence = edit.tempoSequence;
-    
     // Calculate the speed ratio based on the brake value
     // value is the adjustment from original tempo (negative for brake effect)
     double speedRatio = 1.0 / (1.0 + value);
@@ -86,12 +83,8 @@ void VinylBrakeComponent::setSpeed(double value)
     // The tempoAdjustment is already (ratio - 1.0), so we add 1.0 to get the full ratio
     double currentBpm = baseBpm / speedRatio;
     
-    // Insert a new tempo at the current position
-    auto tempo = tempoSequence.insertTempo(tracktion::TimePosition::fromSeconds(0.0));
-    DBG("Setting tempo adjustment to: " + juce::String(currentBpm));
-    
-    // Set the new tempo
-    tempo->setBpm(currentBpm);
+    // Runs at 60 Hz while braking, so move the edit's tempo in place rather than inserting one
+    EngineHelpers::setTempo(edit, currentBpm);
 }
 
 void VinylBrakeComponent::startSpringAnimation()
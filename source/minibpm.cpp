@@ -104,16 +104,23 @@ public:
 
     template <typename T>
     void acfUnityNormalised(const T *R__ in, T *R__ out) const {
-
         acf(in, out);
+        unityNormalise(out, m_m, m_n);
+    }
+
+    // Turn the first m lag sums of an autocorrelation over n values,
+    // however they were accumulated, into per-term means scaled to a
+    // unity maximum
+    template <typename T>
+    static void unityNormalise(T *R__ out, int m, int n) {
 
         double max = 0.0;
-        for (int i = 0; i < m_m; ++i) {
-            out[i] /= m_n - i;
+        for (int i = 0; i < m; ++i) {
+            out[i] /= n - i;
             if (out[i] > max) max = out[i];
         }
         if (max > 0.0) {
-            for (int i = 0; i < m_m; ++i) {
+            for (int i = 0; i < m; ++i) {
                 out[i] /= max;
             }
         }
@@ -352,6 +359,12 @@ public:
         m_lfmax(550),
         m_hfmin(9000),
         m_hfmax(9001),
+        m_bounded(false),
+        m_retainOnsets(true),
+        m_expectedFrames(0),
+        m_dfCount(0),
+        m_window(0),
+        m_windowPos(0),
         m_input(0),
         m_partial(0),
         m_partialFill(0),
@@ -410,6 +423,19 @@ public:
         return tot;
     }
 
+    void setExpectedInputLength(long long nsamples)
+    {
+        m_expectedFrames = nsamples > 0 ? size_t(nsamples / m_stepSize + 2) : 0;
+        reserve();
+    }
+
+    void setBoundedMemory(bool bounded, bool retainOnsetFunction)
+    {
+        m_bounded = bounded;
+        m_retainOnsets = !bounded || retainOnsetFunction;
+        reserve();
+    }
+
     double estimateTempoOfSamples(const float *samples, int nsamples)
     {
         int i = 0;
@@ -459,6 +485,16 @@ public:
         return m_candidates;
     }
 
+    std::vector<double> getOnsetFunction() const
+    {
+        return m_lfdf;
+    }
+
+    int getOnsetHopSize() const
+    {
+        return m_stepSize;
+    }
+
     void reset()
     {
         m_lfdf.clear();
@@ -466,6 +502,73 @@ public:
         m_rms.clear();
         m_candidates.clear();
         m_partialFill = 0;
+        m_dfCount = 0;
+        m_window = 0;
+        m_windowPos = 0;
+    }
+
+    // The longest lag of interest: 4 bars at the minimum bpm
+    int getMaxAcfLength() const
+    {
+        double hopsPerSec = m_inputSampleRate / m_stepSize;
+        double barPM = m_minbpm / (4 * m_beatsPerBar);
+        return Autocorrelation::bpmToLag(barPM, hopsPerSec);
+    }
+
+    // Allocate up front whatever the known input length or the chosen
+    // mode says we'll need, so nothing grows while processing
+    void reserve()
+    {
+        if (m_expectedFrames > 0) {
+            if (m_retainOnsets) m_lfdf.reserve(m_expectedFrames);
+            if (!m_bounded) {
+                m_hfdf.reserve(m_expectedFrames);
+                m_rms.reserve(m_expectedFrames);
+            }
+        }
+    }
+
+    // Scratch space for finish(): the summed acf, one feature's acf,
+    // and the comb-filtered acf, each up to the longest lag
+    double *getScratch(int acfLength)
+    {
+        size_t required = size_t(acfLength) * 3;
+        if (m_scratch.size() < required) m_scratch.resize(required);
+        return m_scratch.data();
+    }
+
+    // Bounded mode: add one frame's features to the lag sums. Each
+    // feature keeps the most recent m_window values twice over in a
+    // ring of 2 * m_window, so the values going back from the newest
+    // are always contiguous
+    void accumulate(double lf, double hf, double rms)
+    {
+        if (m_window == 0) {
+            m_window = std::max(1, getMaxAcfLength());
+            m_history.assign(size_t(m_window) * 2 * featureCount, 0.0);
+            m_lagSums.assign(size_t(m_window) * featureCount, 0.0);
+            m_windowPos = 0;
+        }
+
+        const double values[featureCount] = { lf, hf, rms };
+        const int lags = int(std::min<long long>(m_dfCount + 1, m_window));
+
+        for (int f = 0; f < featureCount; ++f) {
+            double *history = &m_history[size_t(f) * 2 * m_window];
+            double *sums = &m_lagSums[size_t(f) * m_window];
+            const double x = values[f];
+
+            history[m_windowPos] = x;
+            history[m_windowPos + m_window] = x;
+
+            const double *R__ recent = history + m_windowPos + m_window;
+            for (int i = 0; i < lags; ++i) {
+                sums[i] += x * recent[-i];
+            }
+        }
+
+        if (++m_windowPos == m_window) m_windowPos = 0;
+        ++m_dfCount;
     }
 
     void processInputBlock()
@@ -477,18 +580,26 @@ public:
         }
 
         rms = sqrt(rms / m_blockSize);
-        m_rms.push_back(rms);
 
         int lfsize = m_lf->getOutputSize();
         int hfsize = m_hf->getOutputSize();
 
         m_lf->forwardMagnitude(m_input, m_frame);
-        m_lfdf.push_back(specdiff(m_frame, m_lfprev, lfsize));
+        double lf = specdiff(m_frame, m_lfprev, lfsize);
         copy(m_lfprev, m_frame, lfsize);
         
         m_hf->forwardMagnitude(m_input, m_frame);
-        m_hfdf.push_back(specdiff(m_frame, m_hfprev, hfsize));
+        double hf = specdiff(m_frame, m_hfprev, hfsize);
         copy(m_hfprev, m_frame, hfsize);
+
+        if (m_retainOnsets) m_lfdf.push_back(lf);
+
+        if (m_bounded) {
+            accumulate(lf, hf, rms);
+        } else {
+            m_hfdf.push_back(hf);
+            m_rms.push_back(rms);
+        }
     }
 
     double finish()
@@ -496,42 +607,46 @@ public:
         m_candidates.clear();
 
         double hopsPerSec = m_inputSampleRate / m_stepSize;
-        int dfLength = static_cast<int>(m_lfdf.size());
+        int dfLength = m_bounded ? int(m_dfCount) : static_cast<int>(m_rms.size());
 
         // We have no use for any lag beyond 4 bars at minimum bpm
-        double barPM = m_minbpm / (4 * m_beatsPerBar);
-        int acfLength = Autocorrelation::bpmToLag(barPM, hopsPerSec);
+        int acfLength = getMaxAcfLength();
+        if (m_bounded) acfLength = std::min(acfLength, m_window);
         while (acfLength > dfLength) acfLength /= 2;
 
-        Autocorrelation acfcalc(dfLength, acfLength);
-
-        double *acf = new double[acfLength];
-        double *temp = new double[acfLength];
-
-        zero(acf, acfLength);
-
-        acfcalc.acfUnityNormalised(&m_lfdf[0], temp);
-        for (int i = 0; i < acfLength; ++i) acf[i] += temp[i];
-
-        acfcalc.acfUnityNormalised(&m_hfdf[0], temp);
-        for (int i = 0; i < acfLength; ++i) acf[i] += temp[i] * 0.5;
-
-        acfcalc.acfUnityNormalised(&m_rms[0], temp);
-        for (int i = 0; i < acfLength; ++i) acf[i] += temp[i] * 0.1;
-
         int minlag = Autocorrelation::bpmToLag(m_maxbpm, hopsPerSec);
         int maxlag = Autocorrelation::bpmToLag(m_minbpm, hopsPerSec);
 
         if (acfLength < maxlag) {
             // Not enough data
-            delete[] acf;
-            delete[] temp;
             return 0.0;
         }
 
+        double *acf = getScratch(acfLength);
+        double *temp = acf + acfLength;
+        double *cf = temp + acfLength;
+
+        zero(acf, acfLength);
+
+        const double weights[featureCount] = { 1.0, 0.5, 0.1 };
+
+        if (m_bounded) {
+            for (int f = 0; f < featureCount; ++f) {
+                copy(temp, &m_lagSums[size_t(f) * m_window], acfLength);
+                Autocorrelation::unityNormalise(temp, acfLength, dfLength);
+                for (int i = 0; i < acfLength; ++i) acf[i] += temp[i] * weights[f];
+            }
+        } else {
+            Autocorrelation acfcalc(dfLength, acfLength);
+            const vector<double> *features[featureCount] = { &m_lfdf, &m_hfdf, &m_rms };
+            for (int f = 0; f < featureCount; ++f) {
+                acfcalc.acfUnityNormalised(features[f]->data(), temp);
+                for (int i = 0; i < acfLength; ++i) acf[i] += temp[i] * weights[f];
+            }
+        }
+
         ACFCombFilter filter(m_beatsPerBar, minlag, maxlag, hopsPerSec);
         int cflen = filter.getFilteredLength();
-        double *cf = new double[cflen];
         filter.filter(acf, acfLength, cf);
         unityNormalise(cf, cflen);
 
@@ -557,9 +672,6 @@ public:
         }
 
         if (candidateMap.empty()) {
-            delete[] cf;
-            delete[] acf;
-            delete[] temp;
             return 0.0;
         }
 
@@ -571,10 +683,6 @@ public:
             m_candidates.push_back(bpm);
         }
 
-        delete[] cf;
-        delete[] acf;
-        delete[] temp;
-
         return m_candidates[0];
     }
         
@@ -592,6 +700,19 @@ private:
     std::vector<double> m_hfdf;
     std::vector<double> m_rms;
 
+    static const int featureCount = 3;  // lf, hf and rms, in that order
+
+    bool m_bounded;
+    bool m_retainOnsets;
+    size_t m_expectedFrames;
+    long long m_dfCount;
+    int m_window;
+    int m_windowPos;
+    std::vector<double> m_history;
+    std::vector<double> m_lagSums;
+
+    std::vector<double> m_scratch;
+
     std::vector<double> m_candidates;
 
     FourierFilterbank *m_lf;
@@ -666,6 +787,30 @@ MiniBPM::getTempoCandidates() const
     return m_d->getTempoCandidates();
 }
 
+void
+MiniBPM::setExpectedInputLength(long long nsamples)
+{
+    m_d->setExpectedInputLength(nsamples);
+}
+
+void
+MiniBPM::setBoundedMemory(bool bounded, bool retainOnsetFunction)
+{
+    m_d->setBoundedMemory(bounded, retainOnsetFunction);
+}
+
+std::vector<double>
+MiniBPM::getOnsetFunction() const
+{
+    return m_d->getOnsetFunction();
+}
+
+int
+MiniBPM::getOnsetHopSize() const
+{
+    return m_d->getOnsetHopSize();
+}
+
 void
 MiniBPM::reset()
 {
@@ -76,6 +76,30 @@ public:
      */
     int getBeatsPerBar() const;
 
+    /**
+     * Tell the estimator how many samples will be supplied through
+     * process(), if known, so that storage for the detection
+     * functions is allocated once up front rather than grown as the
+     * audio arrives. Call after setBoundedMemory(), if using it.
+     */
+    void setExpectedInputLength(long long nsamples);
+
+    /**
+     * Select bounded-memory operation, for very long inputs. Rather
+     * than keeping the detection functions for the whole input and
+     * autocorrelating them at the end, the autocorrelations are
+     * accumulated as the audio arrives, over a sliding window of the
+     * most recent frames as long as the longest lag of interest. The
+     * estimate is the same, but memory use no longer grows with the
+     * input, and no long computation is left for estimateTempo().
+     *
+     * The BPM range and beats per bar must be set before the first
+     * call to process(). If retainOnsetFunction is true, the
+     * low-frequency onset function is still kept in full (one value
+     * per hop) so that getOnsetFunction() can return it.
+     */
+    void setBoundedMemory(bool bounded, bool retainOnsetFunction = false);
+
     /**
      * Return the estimated tempo in bpm of the music audio in the
      * given sequence of samples. nsamples contains the number of
@@ -118,6 +142,24 @@ public:
      */
     std::vector<double> getTempoCandidates() const;
 
+    /**
+     * Return the low-frequency onset detection function calculated
+     * from the audio supplied so far, one value per hop of
+     * getOnsetHopSize() samples. Value i describes the change in the
+     * low-frequency spectrum brought in by input samples i * hop to
+     * (i + 1) * hop. This is the function the tempo is estimated
+     * from, and may be used to place beats once estimateTempo() has
+     * returned. Calling reset() will clear it. In bounded-memory
+     * mode it is empty unless it was asked to be retained.
+     */
+    std::vector<double> getOnsetFunction() const;
+
+    /**
+     * Return the number of input samples between consecutive values
+     * of the onset detection function.
+     */
+    int getOnsetHopSize() const;
+
     /**
      * Prepare the object to carry out another tempo estimation on a
      * new audio clip. You can either call this between uses, or
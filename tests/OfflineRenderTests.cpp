@@ -0,0 +1,332 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "Utilities.h"
+#include "AudioTap.h"
+#include "Deck.h"
+#include "EditLayout.h"
+#include "HotCuePlugin.h"
+#include "SessionSnapshot.h"
+#include "TaskScheduler.h"
+#include "TrackAnalyser.h"
+#include "Plugins/FlangerPlugin.h"
+#include "Plugins/AutoDelayPlugin.h"
+#include "Plugins/AutoPhaserPlugin.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr double windowSeconds = 0.05;
+    constexpr float floorDb = -90.0f;
+
+    /** Kick on every beat, a hat on every off-beat and a bass note per bar.
+        The noise is seeded, so the same tempo always writes the same file.
+    */
+    juce::File writeDrumLoop (const juce::File& dir, const juce::String& name, double bpm, double seconds)
+    {
+        const int numSamples = (int) (seconds * sampleRate);
+        const double beatSeconds = 60.0 / bpm;
+
+        juce::AudioBuffer<float> buffer (2, numSamples);
+        juce::Random random (juce::roundToInt (bpm * 100.0));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            const double sinceBeat = std::fmod (t, beatSeconds);
+            const double sinceOffBeat = std::fmod (t + beatSeconds * 0.5, beatSeconds);
+            const double sinceBar = std::fmod (t, beatSeconds * 4.0);
+
+            const double kick = std::sin (juce::MathConstants<double>::twoPi * (50.0 + 80.0 * std::exp (-30.0 * sinceBeat)) * sinceBeat)
+                                  * std::exp (-9.0 * sinceBeat);
+            const double hat = (random.nextDouble() * 2.0 - 1.0) * std::exp (-60.0 * sinceOffBeat);
+            const double bass = std::sin (juce::MathConstants<double>::twoPi * 55.0 * t) * std::exp (-1.5 * sinceBar);
+
+            buffer.setSample (0, i, (float) (0.6 * kick + 0.15 * hat + 0.25 * bass));
+            buffer.setSample (1, i, (float) (0.6 * kick + 0.12 * hat + 0.25 * bass));
+        }
+
+        auto file = dir.getChildFile (name + ".wav");
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (file),
+                                                                              sampleRate, 2, 24, {}, 0));
+        REQUIRE (writer != nullptr);
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+
+        return file;
+    }
+
+    /** The shape of a render: each channel's RMS over 50 ms windows, in dB,
+        interleaved. Coarse enough to ride over the stretcher's rounding on
+        different machines, fine enough to catch a missing beat or effect.
+    */
+    std::vector<float> measureEnvelope (const juce::File& file)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+        REQUIRE (reader != nullptr);
+
+        const int window = juce::roundToInt (reader->sampleRate * windowSeconds);
+        const int numChannels = (int) reader->numChannels;
+        juce::AudioBuffer<float> buffer (numChannels, window);
+
+        std::vector<float> envelope;
+
+        for (juce::int64 start = 0; start + window <= reader->lengthInSamples; start += window)
+        {
+            reader->read (&buffer, 0, window, start, true, true);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                envelope.push_back (juce::Decibels::gainToDecibels (buffer.getRMSLevel (channel, 0, window), floorDb));
+        }
+
+        return envelope;
+    }
+
+    juce::File getGoldenFile (const juce::String& name)
+    {
+        return juce::File (CHOPSHOP_GOLDEN_DIR).getChildFile (name + ".txt");
+    }
+
+    void writeGolden (const juce::File& file, const std::vector<float>& envelope)
+    {
+        juce::StringArray lines;
+
+        for (auto v : envelope)
+            lines.add (juce::String (v, 2));
+
+        file.getParentDirectory().createDirectory();
+        file.replaceWithText (lines.joinIntoString ("\n") + "\n");
+    }
+
+    std::vector<float> readGolden (const juce::File& file)
+    {
+        juce::StringArray lines;
+        lines.addLines (file.loadFileAsString());
+        lines.removeEmptyStrings();
+
+        std::vector<float> envelope;
+
+        for (auto& line : lines)
+            envelope.push_back (line.getFloatValue());
+
+        return envelope;
+    }
+}
+
+/** Both decks loaded the way MainComponent::handleFileSelection loads them,
+    through the chop voices and the default effect rack, rendered offline and
+    checked against a recorded envelope. Reloading them as a session restore
+    does is timed against the 200 ms restore budget.
+
+    Set CHOPSHOP_UPDATE_GOLDEN=1 to record the envelope again after a change
+    that's meant to alter the sound, then check in tests/golden/TwoDeckChop.txt.
+    Until there's a recording the comparison is skipped, not failed.
+*/
+TEST_CASE ("Offline render of the two-deck chop edit", "[render]")
+{
+    // Analysis runs on the scheduler's workers, which have to be joined before
+    // the test exits, and the edit's taps freed, as the app does at shutdown;
+    // declared first so it runs after the engine has gone
+    const juce::ErasedScopeGuard shutdown ([]
+    {
+        TaskScheduler::getInstance()->shutdown();
+        AudioTapService::getInstance()->shutdown();
+    });
+
+    te::Engine engine { "ChopShop Tests", nullptr, nullptr };
+
+    // A hosted device stands in for the sound card, so nothing real is opened
+    te::HostedAudioDeviceInterface::Parameters device;
+    device.sampleRate = sampleRate;
+    device.blockSize = 512;
+    device.inputChannels = 0;
+    device.outputChannels = 2;
+    engine.getDeviceManager().getHostedAudioDeviceInterface().initialise (device);
+
+    EditLayout::registerPlugins (engine);
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory).getChildFile ("ChopShopRenderTest");
+    dir.deleteRecursively();
+    REQUIRE (dir.createDirectory());
+
+    const auto fileA = writeDrumLoop (dir, "Loop A", 120.0, 16.0);
+    const auto fileB = writeDrumLoop (dir, "Loop B", 126.0, 16.0);
+
+    // The library's analysis, which is what loading works from
+    const auto analysisA = TrackAnalyser::analyseFile (fileA, {}, TaskPriority::interactive);
+    const auto analysisB = TrackAnalyser::analyseFile (fileB, {}, TaskPriority::interactive);
+    REQUIRE (analysisA);
+    REQUIRE (analysisB);
+    CHECK (std::abs (analysisA->bpm - 120.0) < 1.0);
+    CHECK (std::abs (analysisB->bpm - 126.0) < 1.0);
+    CHECK (! analysisA->beats.empty());
+
+    te::Edit edit { engine, te::Edit::forEditing };
+
+    std::array<std::unique_ptr<Deck>, 2> decks;
+
+    for (int i = 0; i < (int) decks.size(); ++i)
+        decks[(size_t) i] = std::make_unique<Deck> (edit, i);
+
+    // The default rack, in the order the effect panels are created
+    std::vector<te::Plugin::Ptr> effects;
+
+    for (auto* type : { te::ReverbPlugin::xmlTypeName, AutoDelayPlugin::xmlTypeName,
+                        FlangerPlugin::xmlTypeName, AutoPhaserPlugin::xmlTypeName })
+        effects.push_back (edit.getPluginCache().createNewPlugin (type, {}));
+
+    EditLayout::createEffectReturns (edit, (int) decks.size(), effects);
+
+    auto masterTrack = edit.getMasterTrack();
+    REQUIRE (masterTrack != nullptr);
+    auto hotCuePlugin = masterTrack->pluginList.insertPlugin (te::HotCuePlugin::create(), 0);
+    auto hotCues = dynamic_cast<te::HotCuePlugin*> (hotCuePlugin.get());
+    REQUIRE (hotCues != nullptr);
+
+    // Through the same load the app uses, so the warp and cues can't drift from it
+    auto loadDeck = [] (Deck& deck, const juce::File& file, const TrackAnalysis& analysis,
+                        te::BeatPosition startBeat, bool fromDownbeat)
+    {
+        auto cues = analysis.hasCues ? std::optional<CuePoints> (analysis.cues) : std::nullopt;
+        const float gainDb = TrackAnalyser::getNormalisationGainDb (analysis.integratedLufs, analysis.truePeakDb);
+
+        REQUIRE (deck.loadAnalysed (file, analysis.bpm, gainDb, cues, analysis.beats, startBeat, fromDownbeat) != nullptr);
+    };
+
+    // The first deck sets the tempo and starts at the top; the second follows
+    // on the next bar line from its first downbeat, as a beat-aligned load does
+    EngineHelpers::setTempo (edit, analysisA->bpm);
+    loadDeck (*decks[0], fileA, *analysisA, te::BeatPosition(), false);
+    loadDeck (*decks[1], fileB, *analysisB, te::BeatPosition::fromBeats (Deck::beatsPerBar), true);
+
+    hotCues->clearAllCues();
+    hotCues->setCue (0, te::BeatPosition());
+
+    // The crossfader in the middle, as the performance bridge would set it
+    for (auto& deck : decks)
+    {
+        auto voices = deck->getChopVoices();
+        REQUIRE (voices != nullptr);
+        voices->setVoiceGain (0, std::cos (juce::MathConstants<float>::pi * 0.25f));
+        voices->setVoiceGain (1, std::sin (juce::MathConstants<float>::pi * 0.25f));
+        deck->syncToTempoSequence();
+    }
+
+    hotCues->syncToTempoSequence();
+
+    // Render
+    constexpr double renderSeconds = 12.0;
+    const auto output = dir.getChildFile ("Render.wav");
+
+    const auto started = juce::Time::getMillisecondCounterHiRes();
+    te::Renderer::renderToFile ("Render", output, edit,
+                                { te::TimePosition(), te::TimePosition::fromSeconds (renderSeconds) },
+                                te::toBitSet (te::getAllTracks (edit)), true, false, {}, false);
+    const double elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - started) / 1000.0;
+
+    REQUIRE (output.existsAsFile());
+
+    const auto envelope = measureEnvelope (output);
+    REQUIRE (envelope.size() >= (size_t) (renderSeconds / windowSeconds) * 2 - 2);
+
+    // It shouldn't render silence, or clip
+    CHECK (*std::max_element (envelope.begin(), envelope.end()) > -30.0f);
+    CHECK (*std::max_element (envelope.begin(), envelope.end()) < 0.0f);
+
+    // Restore the set the way MainComponent::restoreSession does: read the
+    // snapshot back, check the files haven't changed, and load both decks
+    // again from the analysis, with the stretched audio already cached
+    double restoreMs = 0.0;
+
+    {
+        SessionSnapshot saved;
+
+        for (auto& deck : decks)
+            saved.decks.push_back ({ deck->getFile(), TrackFingerprint::of (deck->getFile()) });
+
+        const auto data = saved.toBinary();
+        const auto restoreStarted = juce::Time::getMillisecondCounterHiRes();
+
+        const auto session = SessionSnapshot::fromBinary (data.getData(), data.getSize());
+        REQUIRE (session);
+        REQUIRE (session->decks.size() == decks.size());
+
+        for (auto& deck : decks)
+            deck->unload();
+
+        for (size_t i = 0; i < decks.size(); ++i)
+            CHECK (TrackFingerprint::of (session->decks[i].file) == session->decks[i].fingerprint);
+
+        loadDeck (*decks[0], session->decks[0].file, *analysisA, te::BeatPosition(), false);
+        loadDeck (*decks[1], session->decks[1].file, *analysisB, te::BeatPosition::fromBeats (Deck::beatsPerBar), true);
+
+        restoreMs = juce::Time::getMillisecondCounterHiRes() - restoreStarted;
+    }
+
+    dir.deleteRecursively();
+
+    // Performance budget: the whole edit, stretching and effects included,
+    // must render at least 50 times faster than it plays
+    {
+        const double speed = renderSeconds / juce::jmax (1.0e-6, elapsedSeconds);
+        INFO ("Rendered " << renderSeconds << " s in " << elapsedSeconds << " s, " << speed << "x real time");
+
+       #if JUCE_DEBUG
+        // Unoptimised builds can't be held to it
+        if (speed < 50.0)
+            WARN ("Render speed is under budget, but this is a debug build");
+       #else
+        CHECK (speed >= 50.0);
+       #endif
+    }
+
+    // Restoring a session must take under 200 ms, since nothing should be decoded
+    {
+        INFO ("Restored the session in " << restoreMs << " ms");
+
+       #if JUCE_DEBUG
+        if (restoreMs >= 200.0)
+            WARN ("Session restore is over budget, but this is a debug build");
+       #else
+        CHECK (restoreMs < 200.0);
+       #endif
+    }
+
+    // Compare with the recorded envelope, last, since there may not be one yet
+    const auto golden = getGoldenFile ("TwoDeckChop");
+
+    if (juce::SystemStats::getEnvironmentVariable ("CHOPSHOP_UPDATE_GOLDEN", {}) == "1")
+    {
+        writeGolden (golden, envelope);
+        WARN ("Recorded " + golden.getFullPathName().toStdString() + "; check it in if the render sounds right");
+        return;
+    }
+
+    if (! golden.existsAsFile())
+        SKIP ("No recorded envelope at " + golden.getFullPathName().toStdString()
+              + "; run the test with CHOPSHOP_UPDATE_GOLDEN=1 to record one, then check it in");
+
+    const auto expected = readGolden (golden);
+    REQUIRE (expected.size() == envelope.size());
+
+    // Each window within 1.5 dB, ignoring the quiet ones where a few
+    // samples of stretcher latency make a big difference in dB
+    int numOff = 0;
+
+    for (size_t i = 0; i < envelope.size(); ++i)
+        if (juce::jmax (expected[i], envelope[i]) > -50.0f && std::abs (expected[i] - envelope[i]) > 1.5f)
+            ++numOff;
+
+    INFO (numOff << " of " << envelope.size() << " windows are off by more than 1.5 dB");
+    CHECK (numOff <= (int) envelope.size() / 100);
+}
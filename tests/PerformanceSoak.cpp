@@ -0,0 +1,128 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "Utilities.h"
+#include "PerformanceParameters.h"
+#include "EffectReturnPlugin.h"
+#include "Plugins/FlangerPlugin.h"
+#include "Plugins/AutoDelayPlugin.h"
+#include "Plugins/AutoPhaserPlugin.h"
+
+namespace
+{
+    struct EditFootprint
+    {
+        int undoUnits = 0;
+        int numTempos = 0;
+        int stateSize = 0;      // nodes and properties in the edit's ValueTree
+
+        bool operator== (const EditFootprint& other) const
+        {
+            return undoUnits == other.undoUnits && numTempos == other.numTempos && stateSize == other.stateSize;
+        }
+    };
+
+    int countNodesAndProperties (const juce::ValueTree& v)
+    {
+        int total = 1 + v.getNumProperties();
+
+        for (const auto& child : v)
+            total += countNodesAndProperties (child);
+
+        return total;
+    }
+
+    EditFootprint measure (te::Edit& edit)
+    {
+        return { edit.getUndoManager().getNumberOfUnitsTakenUpByStoredCommands(),
+                 edit.tempoSequence.getNumTempos(),
+                 countNodesAndProperties (edit.state) };
+    }
+}
+
+/** A three hour set of knob twists, brakes and screws, at the rate the UI
+    timers and controllers produce them, with nothing rendered. Everything the
+    performer touches must leave the edit the same size it found it.
+*/
+TEST_CASE ("Performance soak", "[soak]")
+{
+    te::Engine engine { "ChopShop Soak", nullptr, nullptr };
+    engine.getPluginManager().createBuiltInType<FlangerPlugin>();
+    engine.getPluginManager().createBuiltInType<AutoDelayPlugin>();
+    engine.getPluginManager().createBuiltInType<AutoPhaserPlugin>();
+    engine.getPluginManager().createBuiltInType<te::EffectReturnPlugin>();
+
+    te::Edit edit { engine, te::Edit::forEditing };
+    auto track = EngineHelpers::getOrInsertAudioTrackAt (edit, 0);
+    REQUIRE (track != nullptr);
+
+    auto insert = [&] (const juce::String& type)
+    {
+        auto plugin = edit.getPluginCache().createNewPlugin (type, {});
+        track->pluginList.insertPlugin (plugin, -1, nullptr);
+        return plugin;
+    };
+
+    auto reverb = insert (te::ReverbPlugin::xmlTypeName);
+    auto flanger = dynamic_cast<FlangerPlugin*> (insert (FlangerPlugin::xmlTypeName).get());
+    auto delay = dynamic_cast<AutoDelayPlugin*> (insert (AutoDelayPlugin::xmlTypeName).get());
+    auto phaser = dynamic_cast<AutoPhaserPlugin*> (insert (AutoPhaserPlugin::xmlTypeName).get());
+    auto mixBack = track->pluginList.insertPlugin (te::EffectReturnPlugin::create (te::EffectReturnPlugin::Stage::mixBack), -1);
+    auto returnLevel = dynamic_cast<te::EffectReturnPlugin*> (mixBack.get());
+
+    REQUIRE (flanger != nullptr);
+    REQUIRE (delay != nullptr);
+    REQUIRE (phaser != nullptr);
+    REQUIRE (returnLevel != nullptr);
+
+    // ReverbComponent does this for the app's reverb
+    if (auto r = dynamic_cast<te::ReverbPlugin*> (reverb.get()))
+        PerformanceParameters::stopUndoing (r->roomSizeValue, r->wetValue);
+
+    auto reverbWet = reverb->getAutomatableParameterByID ("wet level");
+    auto delayMix = delay->getAutomatableParameterByID ("mix proportion");
+    REQUIRE (reverbWet != nullptr);
+    REQUIRE (delayMix != nullptr);
+
+    EngineHelpers::setTempo (edit, 120.0);
+    edit.getUndoManager().clearUndoHistory();
+
+    constexpr int gesturesPerSecond = 60;
+    constexpr int secondsPerHour = 60 * 60;
+
+    auto playFor = [&] (int hour)
+    {
+        for (int i = 0; i < secondsPerHour * gesturesPerSecond; ++i)
+        {
+            const double t = (hour * secondsPerHour * gesturesPerSecond + i) / (double) gesturesPerSecond;
+            const float wobble = 0.5f + 0.5f * (float) std::sin (t * 0.7);
+
+            switch (i % 7)
+            {
+                case 0:  reverbWet->setParameter (wobble, juce::sendNotification); break;
+                case 1:  flanger->setMix (wobble); break;
+                case 2:  flanger->setDepth (10.0f * wobble); break;
+                case 3:  delay->setLength (1000.0f * wobble); delayMix->setParameter (wobble, juce::sendNotification); break;
+                case 4:  phaser->depthParam->setParameter (10.0f * wobble, juce::sendNotification); break;
+                case 5:  returnLevel->setLevel (wobble); break;
+                default: EngineHelpers::setTempo (edit, 120.0 * (0.5 + wobble)); break;   // screw and brake
+            }
+
+            // What the UI would do between gestures
+            if (i % gesturesPerSecond == 0)
+                edit.getUndoManager().beginNewTransaction();
+        }
+    };
+
+    playFor (0);
+    const auto afterOneHour = measure (edit);
+
+    playFor (1);
+    playFor (2);
+    const auto afterThreeHours = measure (edit);
+
+    CHECK (afterOneHour.undoUnits == 0);
+    CHECK (afterOneHour.numTempos == 1);
+    CHECK (afterThreeHours == afterOneHour);
+}